@@ -27,7 +27,9 @@
 #include "llvm/ADT/BitVector.h"
 #include "llvm/CodeGen/LiveIntervalUnion.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace llvm {
 
@@ -58,6 +60,24 @@ class LiveRegMatrix : public MachineFunctionPass {
   unsigned RegMaskVirtReg = 0;
   BitVector RegMaskUsable;
 
+  // Cached checkInterference() results for InterferenceVirtReg, indexed by
+  // PhysReg. An entry is valid when its epoch matches the current one. Fixed
+  // (regmask and register unit) interference only depends on the virtual
+  // register and stays valid until UserTag changes. Virtual register
+  // interference also depends on the assignments in the matrix, so assign()
+  // and unassign() start a new VirtEpoch.
+  struct CachedInterference {
+    unsigned FixedEpoch = 0;
+    unsigned VirtEpoch = 0;
+    uint8_t FixedKind = 0;
+    bool HasVirtInterference = false;
+  };
+  std::vector<CachedInterference> InterferenceCache;
+  unsigned InterferenceTag = 0;
+  unsigned InterferenceVirtReg = 0;
+  unsigned FixedEpoch = 1;
+  unsigned VirtEpoch = 1;
+
   // MachineFunctionPass boilerplate.
   void getAnalysisUsage(AnalysisUsage &) const override;
   bool runOnMachineFunction(MachineFunction &) override;
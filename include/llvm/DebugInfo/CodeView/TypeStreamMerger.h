@@ -101,6 +101,37 @@ Error mergeIdRecords(GlobalTypeTableBuilder &Dest, ArrayRef<TypeIndex> Types,
                      const CVTypeArray &Ids,
                      ArrayRef<GloballyHashedType> Hashes);
 
+/// A type stream and the id stream that refers to it, for example the TPI and
+/// IPI streams of one PDB. Either may be null.
+struct TypeAndIdStreams {
+  const CVTypeArray *Types = nullptr;
+  const CVTypeArray *Ids = nullptr;
+};
+
+/// Merge the type and id records of many sources into two tables.
+///
+/// The global hashes of the sources are computed concurrently on up to
+/// \p NumThreads threads (0 means one per hardware thread), and each source is
+/// merged as soon as its hashes are ready. Sources are merged in order, so the
+/// resulting tables do not depend on the number of threads. The streams of
+/// different sources are read concurrently and must not share state that is
+/// unsafe to read from several threads.
+///
+/// \param DestIds The table to store the re-written id records into.
+///
+/// \param DestTypes The table to store the re-written type records into.
+///
+/// \param Sources The streams to merge in.
+///
+/// \param NumThreads The maximum number of threads to hash with.
+///
+/// \returns Error::success() if the operation succeeded, otherwise an
+/// appropriate error code.
+Error mergeTypeStreams(GlobalTypeTableBuilder &DestIds,
+                       GlobalTypeTableBuilder &DestTypes,
+                       ArrayRef<TypeAndIdStreams> Sources,
+                       unsigned NumThreads = 0);
+
 } // end namespace codeview
 } // end namespace llvm
 
@@ -163,6 +163,9 @@ struct DIDumpOptions {
   bool SummarizeTypes = false;
   bool Verbose = false;
   bool DisplayRawContents = false;
+  /// Number of threads to extract DIEs with when every unit is visited, as
+  /// the verifier does. 0 means one per hardware thread.
+  unsigned NumThreads = 1;
 
   /// Return default option set for printing a single DIE without children.
   static DIDumpOptions getForSingleDIE() {
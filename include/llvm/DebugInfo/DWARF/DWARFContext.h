@@ -10,6 +10,7 @@
 #ifndef LLVM_DEBUGINFO_DWARF_DWARFCONTEXT_H
 #define LLVM_DEBUGINFO_DWARF_DWARFCONTEXT_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
@@ -205,6 +206,14 @@ public:
 
   DWARFCompileUnit *getDWOCompileUnitForHash(uint64_t Hash);
 
+  /// Extract all DIEs of the given units using up to \p NumThreads threads
+  /// (0 means one per hardware thread). DIEs are otherwise extracted lazily,
+  /// one unit at a time; this is meant for clients that are going to visit
+  /// every DIE anyway. The abbreviation sets are resolved on the calling thread
+  /// first, so that the units only read shared state while being extracted.
+  static void parseUnitDIEs(ArrayRef<DWARFUnit *> Units,
+                            unsigned NumThreads = 0);
+
   /// Return the compile unit that includes an offset (relative to .debug_info).
   DWARFCompileUnit *getCompileUnitForOffset(uint32_t Offset);
 
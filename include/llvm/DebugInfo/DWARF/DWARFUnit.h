@@ -40,6 +40,7 @@ class DWARFAbbreviationDeclarationSet;
 class DWARFContext;
 class DWARFDebugAbbrev;
 class DWARFUnit;
+class raw_ostream;
 
 /// Base class describing the header of any kind of "unit."  Some information
 /// is specific to certain unit types.  We separate this class out so we can
@@ -281,6 +282,8 @@ class DWARFUnit {
   llvm::Optional<BaseAddress> BaseAddr;
   /// The compile unit debug information entry items.
   std::vector<DWARFDebugInfoEntry> DieArray;
+  /// Where diagnostics found while extracting DIEs go, if not errs().
+  raw_ostream *DiagOS = nullptr;
 
   /// Map from range's start address to end address and corresponding DIE.
   /// IntervalMap does not support range removal, as a result, we use the
@@ -442,6 +445,11 @@ public:
     return DWARFDie(this, &DieArray[0]);
   }
 
+  /// Extract all DIEs of the unit, writing the warnings and errors found
+  /// while doing so to \p OS rather than to errs(). Units extracted on worker
+  /// threads use this, so their diagnostics can be printed in unit order.
+  void extractDIEs(raw_ostream &OS);
+
   const char *getCompilationDir();
   Optional<uint64_t> getDWOId() {
     extractDIEsIfNeeded(/*CUDieOnly*/ true);
@@ -542,6 +550,8 @@ public:
   }
 
 private:
+  raw_ostream &diagStream() const;
+
   /// Size in bytes of the .debug_info data associated with this compile unit.
   size_t getDebugInfoSize() const {
     return Header.getLength() + 4 - getHeaderSize();
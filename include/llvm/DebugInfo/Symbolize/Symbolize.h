@@ -33,6 +33,8 @@ using namespace object;
 
 using FunctionNameKind = DILineInfoSpecifier::FunctionNameKind;
 
+class SymbolizableIndex;
+
 class LLVMSymbolizer {
 public:
   struct Options {
@@ -42,6 +44,10 @@ public:
     bool RelativeAddresses : 1;
     std::string DefaultArch;
     std::vector<std::string> DsymHints;
+    /// Directory of symbolization indexes, named after the build ID of the
+    /// binary they describe. Indexes are created on first use. Empty disables
+    /// indexing.
+    std::string IndexDir;
 
     Options(FunctionNameKind PrintFunctions = FunctionNameKind::LinkageName,
             bool UseSymbolTable = true, bool Demangle = true,
@@ -83,6 +89,12 @@ private:
   Expected<SymbolizableModule *>
   getOrCreateModuleInfo(const std::string &ModuleName, StringRef DWPName = "");
 
+  /// Returns the symbolization index for a module, building it from the module
+  /// if it is not in Opts.IndexDir yet. Returns nullptr if the module cannot
+  /// be indexed, e.g. because it has no build ID.
+  Expected<SymbolizableIndex *>
+  getOrCreateIndex(const std::string &ModuleName, StringRef DWPName);
+
   ObjectFile *lookUpDsymFile(const std::string &Path,
                              const MachOObjectFile *ExeObj,
                              const std::string &ArchName);
@@ -102,6 +114,9 @@ private:
 
   std::map<std::string, std::unique_ptr<SymbolizableModule>> Modules;
 
+  /// Contains cached results of getOrCreateIndex().
+  std::map<std::string, std::unique_ptr<SymbolizableModule>> Indexes;
+
   /// Contains cached results of getOrCreateObjectPair().
   std::map<std::pair<std::string, std::string>, ObjectPair>
       ObjectPairForPathArch;
@@ -59,6 +59,7 @@ class Value;
 namespace orc {
 
 class ExtractingIRMaterializationUnit;
+class Speculator;
 
 class CompileOnDemandLayer2 : public IRLayer {
   friend class ExtractingIRMaterializationUnit;
@@ -80,6 +81,11 @@ public:
   void emit(MaterializationResponsibility R, VModuleKey K,
             std::unique_ptr<Module> M) override;
 
+  /// Register each function, its stub and the functions it calls with \p S,
+  /// and report the calls that reach the compile callbacks to it. Must be set
+  /// before any modules are added. The layer does not take ownership of \p S.
+  void setSpeculator(Speculator *S) { Spec = S; }
+
 private:
   using StubManagersMap =
       std::map<const VSO *, std::unique_ptr<IndirectStubsManager>>;
@@ -96,6 +102,7 @@ private:
   IndirectStubsManagerBuilder BuildIndirectStubsManager;
   StubManagersMap StubsMgrs;
   GetAvailableContextFunction GetAvailableContext;
+  Speculator *Spec = nullptr;
 };
 
 /// Compile-on-demand layer.
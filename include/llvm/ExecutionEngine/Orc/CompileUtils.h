@@ -28,6 +28,8 @@
 #include "llvm/Target/TargetMachine.h"
 #include <algorithm>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace llvm {
 
@@ -80,6 +82,8 @@ public:
 
     // TODO: Actually report errors helpfully.
     consumeError(Obj.takeError());
+    if (ObjCache)
+      ObjCache->notifyObjectCompileFailed(&M);
     return nullptr;
   }
 
@@ -103,24 +107,48 @@ private:
 
 /// A thread-safe version of SimpleCompiler.
 ///
-/// This class creates a new TargetMachine and SimpleCompiler instance for each
-/// compile.
+/// Each compile takes a TargetMachine out of a pool shared by the copies of
+/// this compiler, creating one if the pool is empty, and puts it back when it
+/// is done. There are never more TargetMachines than concurrent compiles.
 class MultiThreadedSimpleCompiler {
 public:
   MultiThreadedSimpleCompiler(JITTargetMachineBuilder JTMB,
                               ObjectCache *ObjCache = nullptr)
-      : JTMB(std::move(JTMB)), ObjCache(ObjCache) {}
+      : State(std::make_shared<SharedState>(std::move(JTMB))),
+        ObjCache(ObjCache) {}
 
   void setObjectCache(ObjectCache *ObjCache) { this->ObjCache = ObjCache; }
 
   std::unique_ptr<MemoryBuffer> operator()(Module &M) {
-    auto TM = cantFail(JTMB.createTargetMachine());
+    std::unique_ptr<TargetMachine> TM;
+    {
+      std::lock_guard<std::mutex> Lock(State->Mutex);
+      if (!State->FreeTMs.empty()) {
+        TM = std::move(State->FreeTMs.back());
+        State->FreeTMs.pop_back();
+      } else {
+        TM = cantFail(State->JTMB.createTargetMachine());
+      }
+    }
+
     SimpleCompiler C(*TM, ObjCache);
-    return C(M);
+    auto Obj = C(M);
+
+    std::lock_guard<std::mutex> Lock(State->Mutex);
+    State->FreeTMs.push_back(std::move(TM));
+    return Obj;
   }
 
 private:
-  JITTargetMachineBuilder JTMB;
+  struct SharedState {
+    SharedState(JITTargetMachineBuilder JTMB) : JTMB(std::move(JTMB)) {}
+
+    std::mutex Mutex;
+    JITTargetMachineBuilder JTMB;
+    std::vector<std::unique_ptr<TargetMachine>> FreeTMs;
+  };
+
+  std::shared_ptr<SharedState> State;
   ObjectCache *ObjCache = nullptr;
 };
 
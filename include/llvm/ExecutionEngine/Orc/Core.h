@@ -357,6 +357,9 @@ public:
   using DispatchMaterializationFunction =
       std::function<void(VSO &V, std::unique_ptr<MaterializationUnit> MU)>;
 
+  /// For blocking until the results of a lookup are available.
+  using WaitForLookupFunction = std::function<void(std::function<bool()>)>;
+
   /// Construct an ExecutionSessionBase.
   ///
   /// SymbolStringPools may be shared between ExecutionSessions.
@@ -385,6 +388,18 @@ public:
     return *this;
   }
 
+  /// Set the function that blocking lookups wait with.
+  ///
+  /// It is called with a predicate that becomes true once the lookup's results
+  /// are available, and must not return before then. A materialization
+  /// dispatcher that queues units can use it to run queued units on the
+  /// blocked thread, so that a lookup never waits for work queued behind it.
+  ExecutionSessionBase &
+  setWaitForLookup(WaitForLookupFunction WaitForLookup) {
+    this->WaitForLookup = std::move(WaitForLookup);
+    return *this;
+  }
+
   /// Report a error for this execution session.
   ///
   /// Unhandled errors can be sent here to log them.
@@ -462,12 +477,18 @@ private:
 
   void runOutstandingMUs();
 
+  void waitUntil(std::function<bool()> IsDone) {
+    if (WaitForLookup)
+      WaitForLookup(std::move(IsDone));
+  }
+
   mutable std::recursive_mutex SessionMutex;
   std::shared_ptr<SymbolStringPool> SSP;
   VModuleKey LastKey = 0;
   ErrorReporter ReportError = logErrorsToStdErr;
   DispatchMaterializationFunction DispatchMaterialization =
       materializeOnCurrentThread;
+  WaitForLookupFunction WaitForLookup;
 
   // FIXME: Remove this (and runOutstandingMUs) once the linking layer works
   //        with callbacks from asynchronous queries.
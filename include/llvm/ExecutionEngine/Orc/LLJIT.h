@@ -21,7 +21,12 @@
 #include "llvm/ExecutionEngine/Orc/IRTransformLayer.h"
 #include "llvm/ExecutionEngine/Orc/ObjectTransformLayer.h"
 #include "llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h"
+#include "llvm/ExecutionEngine/Orc/Speculation.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Target/TargetMachine.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 
 namespace llvm {
 namespace orc {
@@ -34,12 +39,34 @@ public:
   Create(std::unique_ptr<ExecutionSession> ES,
          std::unique_ptr<TargetMachine> TM, DataLayout DL);
 
+  /// Create an LLJIT instance that compiles on NumCompileThreads threads.
+  ///
+  /// The materialization of the symbols a lookup needs is dispatched to the
+  /// compile threads, and the lookup blocks until they are ready as usual.
+  /// While it is blocked, the thread materializes queued units too.
+  /// Each compile thread uses its own TargetMachine, built with JTMB. Modules
+  /// may be compiled concurrently, so each module added to the JIT must be
+  /// in its own LLVMContext.
+  ///
+  /// If NumCompileThreads is zero, or LLVM was built without thread support,
+  /// modules are compiled on the thread that triggers their materialization.
+  static Expected<std::unique_ptr<LLJIT>>
+  Create(std::unique_ptr<ExecutionSession> ES, JITTargetMachineBuilder JTMB,
+         DataLayout DL, unsigned NumCompileThreads);
+
   /// Returns a reference to the ExecutionSession for this JIT instance.
   ExecutionSession &getExecutionSession() { return *ES; }
 
   /// Returns a reference to the VSO representing the JIT'd main program.
   VSO &getMainVSO() { return Main; }
 
+  /// Returns a reference to the DataLayout for this instance.
+  const DataLayout &getDataLayout() const { return DL; }
+
+  /// Set an ObjectCache to query before compiling each module, e.g. a
+  /// PersistentObjectCache. Must be called before any modules are added.
+  void setObjectCache(ObjectCache *NewCache) { ObjCache = NewCache; }
+
   /// Convenience method for defining an absolute symbol.
   Error defineAbsolute(StringRef Name, JITEvaluatedSymbol Address);
 
@@ -72,15 +99,24 @@ public:
   }
 
   /// Runs all not-yet-run static constructors.
-  Error runConstructors() { return CtorRunner.run(); }
+  Error runConstructors() {
+    auto Lock = lockCompiles();
+    return CtorRunner.run();
+  }
 
   /// Runs all not-yet-run static destructors.
-  Error runDestructors() { return DtorRunner.run(); }
+  Error runDestructors() {
+    auto Lock = lockCompiles();
+    return DtorRunner.run();
+  }
 
 protected:
   LLJIT(std::unique_ptr<ExecutionSession> ES, std::unique_ptr<TargetMachine> TM,
         DataLayout DL);
 
+  LLJIT(std::unique_ptr<ExecutionSession> ES, JITTargetMachineBuilder JTMB,
+        DataLayout DL, unsigned NumCompileThreads);
+
   std::shared_ptr<RuntimeDyld::MemoryManager> getMemoryManager(VModuleKey K);
 
   std::string mangle(StringRef UnmangledName);
@@ -89,16 +125,48 @@ protected:
 
   void recordCtorDtors(Module &M);
 
+  /// Run the oldest pending unit, if any. Returns false if there was none.
+  bool runPendingMaterialization();
+
+  /// Wait for a blocking lookup of the ExecutionSession, running pending units
+  /// until IsDone returns true.
+  void waitForLookup(std::function<bool()> IsDone);
+
+  /// Lock CompileMutex if compiles must be serialized, return an empty lock
+  /// otherwise.
+  std::unique_lock<std::recursive_mutex> lockCompiles() {
+    if (!SerializeCompiles)
+      return std::unique_lock<std::recursive_mutex>();
+    return std::unique_lock<std::recursive_mutex>(CompileMutex);
+  }
+
   std::unique_ptr<ExecutionSession> ES;
   VSO &Main;
 
   std::unique_ptr<TargetMachine> TM;
   DataLayout DL;
+  ObjectCache *ObjCache = nullptr;
 
   RTDyldObjectLinkingLayer2 ObjLinkingLayer;
   IRCompileLayer2 CompileLayer;
 
   CtorDtorRunner2 CtorRunner, DtorRunner;
+
+  /// Held by every lookup when SerializeCompiles is set.
+  std::recursive_mutex CompileMutex;
+  bool SerializeCompiles = false;
+
+  /// Units dispatched outside of the compile threads that have not started
+  /// yet. They are run by the compile threads, and by any thread blocked in a
+  /// lookup, so that a lookup never waits for a unit stuck behind it.
+  std::mutex PendingMUsMutex;
+  std::condition_variable PendingMUsChanged;
+  std::deque<std::pair<VSO *, std::unique_ptr<MaterializationUnit>>>
+      PendingMUs;
+
+  /// The compile threads, if any. Declared last so that the threads are
+  /// joined before the layers they use are destroyed.
+  std::unique_ptr<ThreadPool> CompileThreads;
 };
 
 /// An extended version of LLJIT that supports lazy function-at-a-time
@@ -124,6 +192,43 @@ public:
     return addLazyIRModule(Main, std::move(M));
   }
 
+  /// Compile up to Budget functions in the background before they are first
+  /// called, and point their stubs at the compiled bodies. The candidates are
+  /// the callees of the functions called or compiled so far, ranked by the
+  /// number of call sites to them. Must be called before any modules are
+  /// added.
+  ///
+  /// Background compiles are serialized with the lookups and lazy compiles
+  /// made through this JIT, as they all use the same LLVMContext. Clients must
+  /// not use that context themselves while lookups may be in progress.
+  ///
+  /// Does nothing if LLVM was built without thread support.
+  void enableSpeculation(unsigned Budget);
+
+  /// Block until the background compiles have run out of candidates or of
+  /// budget. Returns at once if speculation is not enabled.
+  void waitForSpeculation() {
+    if (Spec)
+      Spec->waitUntilIdle();
+  }
+
+  /// The number of functions compiled in the background.
+  unsigned getNumSpeculated() const {
+    return Spec ? Spec->getNumSpeculated() : 0;
+  }
+
+  /// The number of functions that were compiled in the background before
+  /// their first call, so that the call went straight to the body.
+  unsigned getNumSpeculationHits() const {
+    return Spec ? Spec->getNumHits() : 0;
+  }
+
+  /// The number of functions that were compiled on their first call while
+  /// speculation was enabled.
+  unsigned getNumSpeculationMisses() const {
+    return Spec ? Spec->getNumMisses() : 0;
+  }
+
 private:
   LLLazyJIT(std::unique_ptr<ExecutionSession> ES,
             std::unique_ptr<TargetMachine> TM, DataLayout DL, LLVMContext &Ctx,
@@ -135,6 +240,9 @@ private:
 
   IRTransformLayer2 TransformLayer;
   CompileOnDemandLayer2 CODLayer;
+
+  /// Declared last so that its thread stops before the layers go away.
+  std::unique_ptr<Speculator> Spec;
 };
 
 } // End namespace orc
@@ -0,0 +1,96 @@
+//===- PersistentObjectCache.h - On-disk object cache for ORC ---*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// An ObjectCache that keeps compiled objects in a directory, so that they can
+// be reused by later runs and by other processes.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
+#define LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/Support/CachePruning.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/LockFileManager.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace llvm {
+
+class TargetMachine;
+
+namespace orc {
+
+/// A content-addressed, on-disk ObjectCache.
+///
+/// Objects are stored under a SHA1 of the module's bitcode and of everything
+/// about the TargetMachine that affects code generation: the triple, CPU,
+/// features, optimization level, relocation and code models, and the LLVM
+/// version. Identical IR compiled for the same target is therefore only
+/// compiled once, whichever process gets to it first.
+///
+/// Several processes may share a cache directory. A process that misses takes
+/// a lock on the entry (see LockFileManager) until it has stored the object,
+/// so that other processes wait for it rather than compiling the same module.
+/// The lock is released as soon as the object is stored or the compile fails.
+/// Entries are written to a temporary file and renamed into place, so readers
+/// never see a partial object.
+///
+/// Entries are named so that pruneCache() can manage them. The directory is
+/// pruned according to the given policy when the cache is created.
+///
+/// This class is thread safe. It can be used with SimpleCompiler,
+/// MultiThreadedSimpleCompiler, LLJIT::setObjectCache and MCJIT.
+class PersistentObjectCache : public ObjectCache {
+public:
+  /// Create a cache in \p CacheDir for objects compiled by \p TM, creating
+  /// the directory if needed.
+  static Expected<std::unique_ptr<PersistentObjectCache>>
+  Create(StringRef CacheDir, const TargetMachine &TM,
+         CachePruningPolicy Policy = CachePruningPolicy());
+
+  void notifyObjectCompiled(const Module *M, MemoryBufferRef Obj) override;
+
+  /// Release the lock taken on M's entry by getObject(), so that other
+  /// processes stop waiting for this one.
+  void notifyObjectCompileFailed(const Module *M) override;
+
+  std::unique_ptr<MemoryBuffer> getObject(const Module *M) override;
+
+private:
+  /// An entry this process is about to store.
+  struct PendingEntry {
+    std::string Path;
+    std::unique_ptr<LockFileManager> Lock;
+  };
+
+  PersistentObjectCache(std::string CacheDir, std::string TargetKey)
+      : CacheDir(std::move(CacheDir)), TargetKey(std::move(TargetKey)) {}
+
+  std::string getKey(const Module &M) const;
+  std::string getEntryPath(StringRef Key) const;
+
+  std::string CacheDir;
+  std::string TargetKey;
+
+  // The modules between their getObject() miss and notifyObjectCompiled().
+  // The key must be computed before compilation, which modifies the module.
+  std::mutex PendingMutex;
+  std::map<const Module *, PendingEntry> Pending;
+};
+
+} // end namespace orc
+} // end namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_ORC_PERSISTENTOBJECTCACHE_H
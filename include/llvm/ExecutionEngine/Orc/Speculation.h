@@ -0,0 +1,146 @@
+//===-- Speculation.h - Compile lazy functions ahead of time ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Speculative compilation of the functions a lazily compiled program is likely
+// to call next.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_ORC_SPECULATION_H
+#define LLVM_EXECUTIONENGINE_ORC_SPECULATION_H
+
+#include "llvm/ExecutionEngine/Orc/Core.h"
+#include "llvm/ExecutionEngine/Orc/IndirectionUtils.h"
+#include "llvm/ExecutionEngine/Orc/SymbolStringPool.h"
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+namespace orc {
+
+/// Compiles lazily compiled functions on a background thread before they are
+/// first called.
+///
+/// CompileOnDemandLayer2 registers each function it replaces by a stub, along
+/// with the functions it calls directly, and reports the calls that reach the
+/// functions' compile callbacks. The callees of the
+/// functions called or compiled speculatively so far become candidates,
+/// scored by the number of call sites to them. The background thread compiles
+/// the best candidate, until the budget of speculative compiles is exhausted,
+/// and then points the function's stub at the compiled body. The function's
+/// first call then goes straight to the body, without taking the compile
+/// mutex.
+///
+/// The functions compiled this way live in a single LLVMContext, so at most
+/// one thread may compile at a time. Every lookup in the JIT that may compile
+/// must hold the compile mutex. The mutex is recursive so that code running
+/// on behalf of a lookup can perform lookups itself.
+class Speculator {
+public:
+  /// The body symbols of the functions a function calls directly, with the
+  /// number of call sites to each.
+  using CalleeList = std::vector<std::pair<SymbolStringPtr, unsigned>>;
+
+  Speculator(ExecutionSession &ES, std::recursive_mutex &CompileMutex,
+             unsigned Budget);
+
+  /// Stops the background thread, waiting for a compile in progress.
+  ~Speculator();
+
+  /// The mutex all lookups in the JIT must hold.
+  std::recursive_mutex &getCompileMutex() { return CompileMutex; }
+
+  /// Register the function whose body is \p Body in \p V, and whose stub
+  /// \p Stub in \p StubsMgr has been created. The function may be compiled
+  /// speculatively from now on.
+  void addFunction(VSO &V, SymbolStringPtr Body, SymbolStringPtr Stub,
+                   IndirectStubsManager &StubsMgr, CalleeList Callees);
+
+  /// Record a call of the function whose body is \p Body that went through
+  /// its compile callback, and queue its callees if it is the first one.
+  /// Returns the address of the body if it was compiled speculatively, in
+  /// which case the stub has been patched already. Otherwise the caller must
+  /// compile the body, then call notifyCompiledOnCall.
+  JITTargetAddress notifyCall(const SymbolStringPtr &Body);
+
+  /// Record that the function whose body is \p Body was compiled by its
+  /// compile callback. Must be called with the compile mutex held.
+  void notifyCompiledOnCall(const SymbolStringPtr &Body);
+
+  /// Block until the background thread has nothing left to compile: there
+  /// are no candidates, or the budget is exhausted.
+  void waitUntilIdle();
+
+  /// The number of functions compiled speculatively.
+  unsigned getNumSpeculated() const { return NumSpeculated; }
+
+  /// The number of functions that were compiled speculatively before any call
+  /// reached their compile callback, and whose stubs were therefore patched
+  /// to jump straight to their bodies.
+  unsigned getNumHits() const { return NumHits; }
+
+  /// The number of functions that had to be compiled on their first call.
+  unsigned getNumMisses() const { return NumMisses; }
+
+private:
+  struct FunctionInfo {
+    VSO *V = nullptr;
+    SymbolStringPtr Stub;
+    IndirectStubsManager *StubsMgr = nullptr;
+    CalleeList Callees;
+  };
+
+  /// Make the callees of \p F that are neither called nor compiled yet
+  /// candidates. Must be called with Mutex held.
+  void addCandidates(const FunctionInfo &F);
+
+  bool isIdle() const {
+    return Compiling == SymbolStringPtr() &&
+           (Budget == 0 || Candidates.empty());
+  }
+
+  void run();
+
+  /// Compile \p Body, and patch the stub of \p F to point at it. Must be
+  /// called with the compile mutex held.
+  void compile(const SymbolStringPtr &Body, const FunctionInfo &F);
+
+  ExecutionSession &ES;
+  std::recursive_mutex &CompileMutex;
+
+  // Protects everything below but the counters.
+  std::mutex Mutex;
+  std::condition_variable CandidatesChanged;
+  std::condition_variable IdleChanged;
+  bool Stop = false;
+  unsigned Budget;
+  std::map<SymbolStringPtr, FunctionInfo> Functions;
+  std::map<SymbolStringPtr, unsigned> Candidates;
+  SymbolStringPtr Compiling; // The body being compiled speculatively, if any.
+  std::set<SymbolStringPtr> Called;
+  std::set<SymbolStringPtr> CompiledOnCall;
+  std::map<SymbolStringPtr, JITTargetAddress> Speculated;
+
+  std::atomic<unsigned> NumSpeculated{0};
+  std::atomic<unsigned> NumHits{0};
+  std::atomic<unsigned> NumMisses{0};
+
+  std::thread Thread;
+};
+
+} // end namespace orc
+} // end namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_ORC_SPECULATION_H
@@ -0,0 +1,149 @@
+//===- SlabMemoryManager.h - Slab-based memory manager for RtDyld -*- C++ -*-=//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares a memory manager that carves the sections of JITed
+// objects out of large, dual-mapped slabs.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_EXECUTIONENGINE_SLABMEMORYMANAGER_H
+#define LLVM_EXECUTIONENGINE_SLABMEMORYMANAGER_H
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ExecutionEngine/RTDyldMemoryManager.h"
+#include "llvm/Support/Error.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace llvm {
+
+/// Hands out memory for JITed sections from a few large slabs.
+///
+/// Code and read-only data slabs are mapped twice: a read-write view that
+/// RuntimeDyld writes the sections and relocations through, and a view with
+/// the final permissions (read-execute or read-only) that the program uses.
+/// Memory is therefore never writable and executable at the same address, and
+/// no permissions change after the slabs are created. Read-write data slabs are
+/// mapped once.
+///
+/// The allocator is thread safe and can be shared by any number of
+/// SlabMemoryManagers. Memory that is deallocated is reused for later sections.
+///
+/// Dual mappings need shared memory objects, and are only available on Unix
+/// hosts; Create fails elsewhere.
+class SlabAllocator {
+public:
+  enum class SectionKind { Code, ROData, RWData };
+
+  /// A block of section memory. WorkingAddr is where the contents are
+  /// written; TargetAddr is where the program sees them. They are equal for
+  /// read-write data.
+  struct Allocation {
+    uint8_t *WorkingAddr = nullptr;
+    uint8_t *TargetAddr = nullptr;
+    size_t Size = 0;
+    SectionKind Kind = SectionKind::Code;
+  };
+
+  /// Create an allocator whose slabs are \p SlabSize bytes (larger sections
+  /// get slabs of their own). If \p UseHugePages is set, slabs are backed by
+  /// huge pages where the system provides them, and by normal pages
+  /// otherwise.
+  static Expected<std::shared_ptr<SlabAllocator>>
+  Create(size_t SlabSize = 64 * 1024 * 1024, bool UseHugePages = false);
+
+  SlabAllocator(const SlabAllocator &) = delete;
+  SlabAllocator &operator=(const SlabAllocator &) = delete;
+
+  /// Unmaps all slabs. Every allocation must have been released.
+  ~SlabAllocator();
+
+  /// Allocate \p Size bytes aligned to \p Alignment, which must be a power of
+  /// two, for a section of kind \p Kind.
+  Expected<Allocation> allocate(SectionKind Kind, size_t Size,
+                                unsigned Alignment);
+
+  /// Return the memory of \p A to the allocator.
+  void deallocate(const Allocation &A);
+
+private:
+  struct Slab;
+
+  SlabAllocator(size_t SlabSize, bool UseHugePages);
+
+  Expected<Slab *> createSlab(SectionKind Kind, size_t MinSize);
+
+  size_t SlabSize;
+  bool UseHugePages;
+  size_t PageSize;
+
+  std::mutex Mutex;
+  std::vector<std::unique_ptr<Slab>> Slabs;
+};
+
+/// A memory manager for RuntimeDyld that allocates sections from a
+/// SlabAllocator.
+///
+/// Sections are written through the allocator's working (read-write) view and
+/// each section is mapped to its final address in notifyObjectLoaded, so
+/// relocations are resolved against the addresses the program will use.
+/// finalizeMemory only needs to invalidate the instruction cache.
+///
+/// Destroying the memory manager releases its sections, so a client that
+/// uses one memory manager per object (as the ORC object linking layers do)
+/// can free individual objects.
+class SlabMemoryManager : public RTDyldMemoryManager {
+public:
+  SlabMemoryManager(std::shared_ptr<SlabAllocator> Allocator);
+  SlabMemoryManager(const SlabMemoryManager &) = delete;
+  void operator=(const SlabMemoryManager &) = delete;
+  ~SlabMemoryManager() override;
+
+  uint8_t *allocateCodeSection(uintptr_t Size, unsigned Alignment,
+                               unsigned SectionID,
+                               StringRef SectionName) override;
+
+  uint8_t *allocateDataSection(uintptr_t Size, unsigned Alignment,
+                               unsigned SectionID, StringRef SectionName,
+                               bool IsReadOnly) override;
+
+  using RTDyldMemoryManager::notifyObjectLoaded;
+
+  /// Map the sections allocated since the last call to their target
+  /// addresses.
+  void notifyObjectLoaded(RuntimeDyld &RTDyld,
+                          const object::ObjectFile &Obj) override;
+
+  /// Register the EH frames at the address the unwinder will see them at.
+  void registerEHFrames(uint8_t *Addr, uint64_t LoadAddr,
+                        size_t Size) override;
+
+  bool finalizeMemory(std::string *ErrMsg = nullptr) override;
+
+private:
+  uint8_t *allocateSection(SlabAllocator::SectionKind Kind, uintptr_t Size,
+                           unsigned Alignment);
+
+  std::shared_ptr<SlabAllocator> Allocator;
+  std::vector<SlabAllocator::Allocation> Allocations;
+  // Allocations before this index have been mapped to their target address.
+  size_t NumMapped = 0;
+  // Code allocations before this index have had the instruction cache
+  // invalidated.
+  size_t NumFinalized = 0;
+};
+
+} // end namespace llvm
+
+#endif // LLVM_EXECUTIONENGINE_SLABMEMORYMANAGER_H
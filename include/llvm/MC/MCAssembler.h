@@ -11,6 +11,7 @@
 #define LLVM_MC_MCASSEMBLER_H
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringRef.h"
@@ -180,6 +181,30 @@ private:
   bool fragmentNeedsRelaxation(const MCRelaxableFragment *IF,
                                const MCAsmLayout &Layout) const;
 
+  /// Per-section bookkeeping used to skip relaxable fragments whose fixups
+  /// cannot have changed since they were last checked.
+  struct SectionRelaxState {
+    /// Whether every fragment of the section has been checked once.
+    bool Visited = false;
+    /// Layout orders of the fragments that changed size during the last
+    /// layout pass over the section, in increasing order.
+    SmallVector<unsigned, 16> ChangedFragments;
+    /// For each layout order, the number of preceding fragments whose size
+    /// depends on their own offset (alignment and padding fragments).
+    std::vector<unsigned> NumOffsetDependent;
+    /// For each layout order, the number of preceding fragments whose size
+    /// may depend on the layout of any section (org and non-constant fill
+    /// fragments).
+    std::vector<unsigned> NumLayoutDependent;
+  };
+  DenseMap<const MCSection *, SectionRelaxState> RelaxStates;
+
+  /// Check whether the relaxable fragment \p F has to be checked again,
+  /// given the fragments that changed during the last layout pass over its
+  /// section.
+  bool needsRelaxationCheck(const MCRelaxableFragment &F,
+                            const SectionRelaxState &State) const;
+
   /// Perform one layout iteration and return true if any offsets
   /// were adjusted.
   bool layoutOnce(MCAsmLayout &Layout);
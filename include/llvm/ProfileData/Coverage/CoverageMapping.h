@@ -43,9 +43,11 @@
 namespace llvm {
 
 class IndexedInstrProfReader;
+class ThreadPool;
 
 namespace coverage {
 
+class BinaryCoverageReader;
 class CoverageMappingReader;
 struct CoverageMappingRecord;
 
@@ -502,6 +504,23 @@ public:
   ArrayRef<ExpansionRecord> getExpansions() const { return Expansions; }
 };
 
+/// Options that control how CoverageMapping::load decodes the coverage mapping
+/// of object files.
+struct CoverageLoadOptions {
+  /// The number of threads used to decode the function records. 0 means one
+  /// thread per core, if there are enough records to make it worthwhile.
+  unsigned NumThreads = 1;
+
+  /// If not empty, only the function records that refer to at least one of
+  /// these files are decoded and loaded. This is enough to compute the coverage
+  /// of these files and of the functions that are defined in them.
+  ///
+  /// The profile of the other records is still checked for hash mismatches,
+  /// so that getMismatchedCount() is the same. Counter mismatches can only be
+  /// found by decoding a record, so they are only counted for loaded records.
+  ArrayRef<StringRef> Files;
+};
+
 /// The mapping of profile information to coverage data.
 ///
 /// This is the main interface to get coverage information, using a profile to
@@ -514,10 +533,28 @@ class CoverageMapping {
 
   CoverageMapping() = default;
 
+  /// Compute the name of the function of \p Record into \p OrigFuncName.
+  /// Returns false if a record for the same function and files was seen.
+  Expected<bool> addRecordProvenance(const CoverageMappingRecord &Record,
+                                     StringRef &OrigFuncName);
+
   /// Add a function record corresponding to \p Record.
   Error loadFunctionRecord(const CoverageMappingRecord &Record,
                            IndexedInstrProfReader &ProfileReader);
 
+  /// Record a hash mismatch for \p Record, which is not loaded. Only its
+  /// function name, hash and files need to be decoded.
+  Error checkSkippedFunctionRecord(const CoverageMappingRecord &Record,
+                                   IndexedInstrProfReader &ProfileReader);
+
+  /// Add the function records of \p CoverageReader that refer to one of
+  /// \p Files, or all of them if \p Files is empty. The records are decoded
+  /// in batches on the threads of \p Pool, if any, and added in order.
+  Error loadFunctionRecords(const BinaryCoverageReader &CoverageReader,
+                            IndexedInstrProfReader &ProfileReader,
+                            const StringSet<> &Files, ThreadPool *Pool,
+                            unsigned NumThreads);
+
 public:
   CoverageMapping(const CoverageMapping &) = delete;
   CoverageMapping &operator=(const CoverageMapping &) = delete;
@@ -531,7 +568,8 @@ public:
   /// \p Arches is non-empty, it must specify an architecture for each object.
   static Expected<std::unique_ptr<CoverageMapping>>
   load(ArrayRef<StringRef> ObjectFilenames, StringRef ProfileFilename,
-       ArrayRef<StringRef> Arches = None);
+       ArrayRef<StringRef> Arches = None,
+       const CoverageLoadOptions &Options = CoverageLoadOptions());
 
   /// The number of functions that couldn't have their profiles mapped.
   ///
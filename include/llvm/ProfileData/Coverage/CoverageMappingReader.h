@@ -16,6 +16,7 @@
 #define LLVM_PROFILEDATA_COVERAGE_COVERAGEMAPPINGREADER_H
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ProfileData/Coverage/CoverageMapping.h"
 #include "llvm/ProfileData/InstrProf.h"
@@ -161,7 +162,12 @@ public:
 
   Error read();
 
+  /// Reads only the names of the files that the mapping refers to, without
+  /// decoding its expressions and regions.
+  Error readFilenames();
+
 private:
+  Error readVirtualFileMapping(SmallVectorImpl<unsigned> &VirtualFileMapping);
   Error decodeCounter(unsigned Value, Counter &C);
   Error readCounter(Counter &C);
   Error
@@ -209,6 +215,26 @@ public:
          StringRef Arch);
 
   Error readNextRecord(CoverageMappingRecord &Record) override;
+
+  /// Returns the number of function records in the coverage mapping.
+  size_t getNumRecords() const { return MappingRecords.size(); }
+
+  /// Reads the function name and hash of the function record at \p Index
+  /// into \p Record, and the names of the files that it refers to into
+  /// \p FunctionFilenames, without decoding its expressions and regions.
+  Error readRecordFilenames(size_t Index, CoverageMappingRecord &Record,
+                            std::vector<StringRef> &FunctionFilenames) const;
+
+  /// Decodes the function record at \p Index into \p Record, which refers to
+  /// the data stored in \p FunctionFilenames, \p FunctionExpressions and
+  /// \p FunctionMappingRegions. This does not change the state of the reader,
+  /// so different records can be decoded concurrently as long as each of them
+  /// uses its own storage.
+  Error readRecord(size_t Index, CoverageMappingRecord &Record,
+                   std::vector<StringRef> &FunctionFilenames,
+                   std::vector<CounterExpression> &FunctionExpressions,
+                   std::vector<CounterMappingRegion> &FunctionMappingRegions)
+      const;
 };
 
 } // end namespace coverage
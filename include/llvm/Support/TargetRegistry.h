@@ -123,6 +123,9 @@ public:
 
   using ArchMatchFnTy = bool (*)(Triple::ArchType Arch);
 
+  /// The initializers shared by the targets of a lazily initialized backend.
+  struct LazyInitializers;
+
   using MCAsmInfoCtorFnTy = MCAsmInfo *(*)(const MCRegisterInfo &MRI,
                                            const Triple &TT);
   using MCInstrInfoCtorFnTy = MCInstrInfo *(*)();
@@ -286,6 +289,10 @@ private:
   /// MCSymbolizer, if registered (default = llvm::createMCSymbolizer)
   MCSymbolizerCtorTy MCSymbolizerCtorFn = nullptr;
 
+  /// LazyInit - The deferred initialization of the backend this target
+  /// belongs to, if any. See TargetRegistry::RegisterLazyInitializer.
+  LazyInitializers *LazyInit = nullptr;
+
 public:
   Target() = default;
 
@@ -657,6 +664,26 @@ struct TargetRegistry {
   static const Target *lookupTarget(const std::string &ArchName,
                                     Triple &TheTriple, std::string &Error);
 
+  /// @}
+  /// @name Lazy Target Initialization
+  /// @{
+
+  /// RegisterLazyInitializer - Defer part of the initialization of a backend
+  /// until one of its targets is first returned by lookupTarget.
+  ///
+  /// \p TargetInfoFn is the function registering the targets of the backend
+  /// (LLVMInitialize<Backend>TargetInfo); it is run now. \p InitFn registers
+  /// another component of the backend (LLVMInitialize<Backend>TargetMC, for
+  /// example), and is run once, together with the other initializers of the
+  /// backend, by the first lookup that finds one of its targets. If the
+  /// targets of the backend had already been registered by other means,
+  /// \p InitFn is run immediately instead.
+  ///
+  /// Like the other registration functions, this must not race with accesses
+  /// to the registry. Lookups may race with each other.
+  static void RegisterLazyInitializer(void (*TargetInfoFn)(),
+                                      void (*InitFn)());
+
   /// @}
   /// @name Target Registration
   /// @{
@@ -896,6 +923,10 @@ struct TargetRegistry {
   }
 
   /// @}
+
+private:
+  /// Run the deferred initializers of the backend of \p T, if needed.
+  static const Target *initializeLazily(const Target *T);
 };
 
 //===--------------------------------------------------------------------===//
@@ -17,6 +17,7 @@
 #define LLVM_SUPPORT_TARGETSELECT_H
 
 #include "llvm/Config/llvm-config.h"
+#include "llvm/Support/TargetRegistry.h"
 
 extern "C" {
   // Declare all of the target-initialization functions that are available.
@@ -108,6 +109,54 @@ namespace llvm {
 #include "llvm/Config/Disassemblers.def"
   }
 
+  /// InitializeAllTargetsLazily - Like InitializeAllTargets, but only the
+  /// target infos are registered right away. The target machine of a backend
+  /// is registered the first time one of its targets is returned by
+  /// TargetRegistry::lookupTarget, so that programs that end up using a
+  /// single target do not pay for initializing all the others.
+  ///
+  /// The other InitializeAll*Lazily functions do the same for the other
+  /// components of the backends.
+  inline void InitializeAllTargetsLazily() {
+#define LLVM_TARGET(TargetName)                                                \
+  TargetRegistry::RegisterLazyInitializer(                                     \
+      LLVMInitialize##TargetName##TargetInfo,                                  \
+      LLVMInitialize##TargetName##Target);
+#include "llvm/Config/Targets.def"
+  }
+
+  inline void InitializeAllTargetMCsLazily() {
+#define LLVM_TARGET(TargetName)                                                \
+  TargetRegistry::RegisterLazyInitializer(                                     \
+      LLVMInitialize##TargetName##TargetInfo,                                  \
+      LLVMInitialize##TargetName##TargetMC);
+#include "llvm/Config/Targets.def"
+  }
+
+  inline void InitializeAllAsmPrintersLazily() {
+#define LLVM_ASM_PRINTER(TargetName)                                           \
+  TargetRegistry::RegisterLazyInitializer(                                     \
+      LLVMInitialize##TargetName##TargetInfo,                                  \
+      LLVMInitialize##TargetName##AsmPrinter);
+#include "llvm/Config/AsmPrinters.def"
+  }
+
+  inline void InitializeAllAsmParsersLazily() {
+#define LLVM_ASM_PARSER(TargetName)                                            \
+  TargetRegistry::RegisterLazyInitializer(                                     \
+      LLVMInitialize##TargetName##TargetInfo,                                  \
+      LLVMInitialize##TargetName##AsmParser);
+#include "llvm/Config/AsmParsers.def"
+  }
+
+  inline void InitializeAllDisassemblersLazily() {
+#define LLVM_DISASSEMBLER(TargetName)                                          \
+  TargetRegistry::RegisterLazyInitializer(                                     \
+      LLVMInitialize##TargetName##TargetInfo,                                  \
+      LLVMInitialize##TargetName##Disassembler);
+#include "llvm/Config/Disassemblers.def"
+  }
+
   /// InitializeNativeTarget - The main program should call this function to
   /// initialize the native target corresponding to the host.  This is useful
   /// for JIT applications to ensure that the target gets linked in correctly.
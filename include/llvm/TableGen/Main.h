@@ -14,6 +14,10 @@
 #ifndef LLVM_TABLEGEN_MAIN_H
 #define LLVM_TABLEGEN_MAIN_H
 
+#include "llvm/ADT/ArrayRef.h"
+#include <functional>
+#include <string>
+
 namespace llvm {
 
 class raw_ostream;
@@ -23,7 +27,18 @@ class RecordKeeper;
 /// Returns true on error, false otherwise.
 using TableGenMainFn = bool (raw_ostream &OS, RecordKeeper &Records);
 
-int TableGenMain(char *argv0, TableGenMainFn *MainFn);
+/// An output that is generated from the same records as the -o output, and
+/// written to its own file.
+struct TableGenOutput {
+  std::string Filename;
+  std::function<bool(raw_ostream &OS, RecordKeeper &Records)> Emit;
+};
+
+/// Parse the input file, then run MainFn and each of ExtraOutputs on the
+/// records. All the outputs are written the same way: they are named in the
+/// dependency file, and honour -write-if-changed.
+int TableGenMain(char *argv0, TableGenMainFn *MainFn,
+                 ArrayRef<TableGenOutput> ExtraOutputs = None);
 
 } // end namespace llvm
 
@@ -12,6 +12,7 @@
 
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/IR/Instruction.h"
 #include "llvm/Support/Compiler.h"
@@ -27,6 +28,10 @@ namespace llvm {
 class InstCombineWorklist {
   SmallVector<Instruction*, 256> Worklist;
   DenseMap<Instruction*, unsigned> WorklistMap;
+  /// Instructions that were created while visiting the current instruction.
+  /// They are only moved onto the worklist once that visit is complete, so
+  /// that they get processed in program order instead of in creation order.
+  SmallSetVector<Instruction *, 16> Deferred;
 
 public:
   InstCombineWorklist() = default;
@@ -34,7 +39,7 @@ public:
   InstCombineWorklist(InstCombineWorklist &&) = default;
   InstCombineWorklist &operator=(InstCombineWorklist &&) = default;
 
-  bool isEmpty() const { return Worklist.empty(); }
+  bool isEmpty() const { return Worklist.empty() && Deferred.empty(); }
 
   /// Add - Add the specified instruction to the worklist if it isn't already
   /// in it.
@@ -50,6 +55,23 @@ public:
       Add(I);
   }
 
+  /// AddDeferred - Add the specified instruction to the worklist once the
+  /// instruction that is currently being visited has been processed.  This is
+  /// used for instructions created by the combiner itself: a fold typically
+  /// creates them top-down, and they should also be revisited top-down.
+  void AddDeferred(Instruction *I) {
+    if (Deferred.insert(I))
+      LLVM_DEBUG(dbgs() << "IC: ADD DEFERRED: " << *I << '\n');
+  }
+
+  /// FlushDeferred - Move all deferred instructions onto the worklist in
+  /// reverse order, so that the first one created is the next one visited.
+  void FlushDeferred() {
+    for (Instruction *I : reverse(Deferred))
+      Add(I);
+    Deferred.clear();
+  }
+
   /// AddInitialGroup - Add the specified batch of stuff in reverse order.
   /// which should only be done when the worklist is empty and when the group
   /// has no duplicates.
@@ -68,6 +90,8 @@ public:
 
   // Remove - remove I from the worklist if it exists.
   void Remove(Instruction *I) {
+    Deferred.remove(I);
+
     DenseMap<Instruction*, unsigned>::iterator It = WorklistMap.find(I);
     if (It == WorklistMap.end()) return; // Not in worklist.
 
@@ -92,11 +116,23 @@ public:
       Add(cast<Instruction>(U));
   }
 
+  /// HandleUseCountDecrement - When an instruction loses a use, it may now be
+  /// dead or foldable, so revisit it.  Many folds are restricted to values
+  /// with one use, so if only one use is left, revisit that user as well.
+  void HandleUseCountDecrement(Value *V) {
+    if (Instruction *I = dyn_cast<Instruction>(V)) {
+      Add(I);
+      if (I->hasOneUse())
+        Add(cast<Instruction>(*I->user_begin()));
+    }
+  }
+
 
   /// Zap - check that the worklist is empty and nuke the backing store for
   /// the map if it is large.
   void Zap() {
     assert(WorklistMap.empty() && "Worklist empty, but map not?");
+    assert(Deferred.empty() && "Deferred instructions left behind?");
 
     // Do an explicit clear, this shrinks the map if needed.
     WorklistMap.clear();
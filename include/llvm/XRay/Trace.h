@@ -16,6 +16,7 @@
 #include <cstdint>
 #include <vector>
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileSystem.h"
@@ -65,6 +66,28 @@ public:
 /// |Filename|.
 Expected<Trace> loadTraceFile(StringRef Filename, bool Sort = false);
 
+/// This function decodes the XRay trace records from the provided |Filename|
+/// one at a time, straight from the memory-mapped file, and calls |Callback|
+/// with each of them in file order. Unlike loadTraceFile, the records are never
+/// all held in memory at once, so this is the interface to use for large
+/// traces whenever the records do not need to be sorted. |Header| is populated
+/// before the first record is handed to |Callback|. Errors returned from
+/// |Callback| stop the reading and are returned to the caller.
+///
+/// Usage:
+///
+///   XRayFileHeader Header;
+///   if (auto E = streamTraceFile("xray-log.something.xray", Header,
+///                                [&](const XRayRecord &R) -> Error {
+///                                  // ... do something with R here.
+///                                  return Error::success();
+///                                })) {
+///     // Handle the error here.
+///   }
+///
+Error streamTraceFile(StringRef Filename, XRayFileHeader &Header,
+                      function_ref<Error(const XRayRecord &)> Callback);
+
 } // namespace xray
 } // namespace llvm
 
@@ -34,6 +34,9 @@ using namespace llvm;
 
 STATISTIC(NumAssigned   , "Number of registers assigned");
 STATISTIC(NumUnassigned , "Number of registers unassigned");
+STATISTIC(NumInterferenceChecks, "Number of interference checks");
+STATISTIC(NumCachedInterferenceChecks,
+          "Number of interference checks answered from the cache");
 
 char LiveRegMatrix::ID = 0;
 INITIALIZE_PASS_BEGIN(LiveRegMatrix, "liveregmatrix",
@@ -64,6 +67,8 @@ bool LiveRegMatrix::runOnMachineFunction(MachineFunction &MF) {
 
   // Make sure no stale queries get reused.
   invalidateVirtRegs();
+  InterferenceCache.assign(TRI->getNumRegs(), CachedInterference());
+  FixedEpoch = VirtEpoch = 1;
   return false;
 }
 
@@ -114,6 +119,7 @@ void LiveRegMatrix::assign(LiveInterval &VirtReg, unsigned PhysReg) {
         return false;
       });
 
+  ++VirtEpoch;
   ++NumAssigned;
   LLVM_DEBUG(dbgs() << '\n');
 }
@@ -131,6 +137,7 @@ void LiveRegMatrix::unassign(LiveInterval &VirtReg) {
                 return false;
               });
 
+  ++VirtEpoch;
   ++NumUnassigned;
   LLVM_DEBUG(dbgs() << '\n');
 }
@@ -187,23 +194,48 @@ LiveRegMatrix::checkInterference(LiveInterval &VirtReg, unsigned PhysReg) {
   if (VirtReg.empty())
     return IK_Free;
 
-  // Regmask interference is the fastest check.
-  if (checkRegMaskInterference(VirtReg, PhysReg))
-    return IK_RegMask;
+  ++NumInterferenceChecks;
 
-  // Check for fixed interference.
-  if (checkRegUnitInterference(VirtReg, PhysReg))
-    return IK_RegUnit;
-
-  // Check the matrix for virtual register interference.
-  bool Interference = foreachUnit(TRI, VirtReg, PhysReg,
-                                  [&](unsigned Unit, const LiveRange &LR) {
-    return query(LR, Unit).checkInterference();
-  });
-  if (Interference)
-    return IK_VirtReg;
+  // Drop the cached results if they belong to another virtual register, or if
+  // virtual registers have been modified since they were computed.
+  if (InterferenceVirtReg != VirtReg.reg || InterferenceTag != UserTag) {
+    InterferenceVirtReg = VirtReg.reg;
+    InterferenceTag = UserTag;
+    ++FixedEpoch;
+    ++VirtEpoch;
+  }
+  CachedInterference &Cached = InterferenceCache[PhysReg];
+  bool IsCached = true;
+
+  if (Cached.FixedEpoch != FixedEpoch) {
+    IsCached = false;
+    Cached.FixedEpoch = FixedEpoch;
+    // Regmask interference is the fastest check.
+    if (checkRegMaskInterference(VirtReg, PhysReg))
+      Cached.FixedKind = IK_RegMask;
+    // Check for fixed interference.
+    else if (checkRegUnitInterference(VirtReg, PhysReg))
+      Cached.FixedKind = IK_RegUnit;
+    else
+      Cached.FixedKind = IK_Free;
+  }
+  if (Cached.FixedKind != IK_Free) {
+    NumCachedInterferenceChecks += IsCached;
+    return InterferenceKind(Cached.FixedKind);
+  }
 
-  return IK_Free;
+  if (Cached.VirtEpoch != VirtEpoch) {
+    IsCached = false;
+    Cached.VirtEpoch = VirtEpoch;
+    // Check the matrix for virtual register interference.
+    Cached.HasVirtInterference =
+        foreachUnit(TRI, VirtReg, PhysReg,
+                    [&](unsigned Unit, const LiveRange &LR) {
+                      return query(LR, Unit).checkInterference();
+                    });
+  }
+  NumCachedInterferenceChecks += IsCached;
+  return Cached.HasVirtInterference ? IK_VirtReg : IK_Free;
 }
 
 bool LiveRegMatrix::checkInterference(SlotIndex Start, SlotIndex End,
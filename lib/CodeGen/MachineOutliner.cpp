@@ -99,6 +99,16 @@ static cl::opt<bool> EnableLinkOnceODROutlining(
     cl::desc("Enable the machine outliner on linkonceodr functions"),
     cl::init(false));
 
+// Bounds the size of the suffix tree on very large modules (e.g. under full
+// LTO). Once this many instructions have been mapped, the functions mapped so
+// far are outlined from, and the remaining functions are mapped into a new
+// suffix tree. Repeated sequences are then only found within each group.
+static cl::opt<unsigned> OutlinerMaxMappedInstrs(
+    "outliner-max-mapped-instrs", cl::Hidden,
+    cl::desc("Maximum number of instructions to build a single suffix tree "
+             "over (0 = unlimited)"),
+    cl::init(0));
+
 namespace {
 
 /// Represents an undefined index in the suffix tree.
@@ -1359,10 +1369,9 @@ bool MachineOutliner::runOnModule(Module &M) {
   // it here.
   OutlineFromLinkOnceODRs = EnableLinkOnceODROutlining;
 
-  InstructionMapper Mapper;
-
-  // Build instruction mappings for each function in the module. Start by
-  // iterating over each Function in M.
+  // Collect the functions to outline from before creating any outlined
+  // functions.
+  std::vector<MachineFunction *> MFs;
   for (Function &F : M) {
 
     // If there's nothing in F, then there's no reason to try and outline from
@@ -1389,39 +1398,63 @@ bool MachineOutliner::runOnModule(Module &M) {
     if (!TII->isFunctionSafeToOutlineFrom(*MF, OutlineFromLinkOnceODRs))
       continue;
 
-    // We have a function suitable for outlining. Iterate over every
-    // MachineBasicBlock in MF and try to map its instructions to a list of
-    // unsigned integers.
-    for (MachineBasicBlock &MBB : *MF) {
-      // If there isn't anything in MBB, then there's no point in outlining from
-      // it.
-      if (MBB.empty())
-        continue;
-
-      // Check if MBB could be the target of an indirect branch. If it is, then
-      // we don't want to outline from it.
-      if (MBB.hasAddressTaken())
-        continue;
-
-      // MBB is suitable for outlining. Map it to a list of unsigneds.
-      Mapper.convertToUnsignedVec(MBB, *TII);
-    }
+    MFs.push_back(MF);
   }
 
-  // Construct a suffix tree, use it to find candidates, and then outline them.
-  SuffixTree ST(Mapper.UnsignedVec);
-  std::vector<std::shared_ptr<Candidate>> CandidateList;
-  std::vector<OutlinedFunction> FunctionList;
-
-  // Find all of the outlining candidates.
-  unsigned MaxCandidateLen =
-      buildCandidateList(CandidateList, FunctionList, ST, Mapper);
+  bool OutlinedSomething = false;
+  unsigned NumFunctionsInPrevRounds = 0;
+  auto NextMF = MFs.begin();
+  while (NextMF != MFs.end()) {
+    InstructionMapper Mapper;
+
+    // Build instruction mappings for each function until the suffix tree size
+    // limit is reached.
+    do {
+      MachineFunction *MF = *NextMF++;
+      const TargetInstrInfo *TII = MF->getSubtarget().getInstrInfo();
+
+      // Iterate over every MachineBasicBlock in MF and try to map its
+      // instructions to a list of unsigned integers.
+      for (MachineBasicBlock &MBB : *MF) {
+        // If there isn't anything in MBB, then there's no point in outlining
+        // from it.
+        if (MBB.empty())
+          continue;
 
-  // Remove candidates that overlap with other candidates.
-  pruneOverlaps(CandidateList, FunctionList, Mapper, MaxCandidateLen);
+        // Check if MBB could be the target of an indirect branch. If it is,
+        // then we don't want to outline from it.
+        if (MBB.hasAddressTaken())
+          continue;
 
-  // Outline each of the candidates and return true if something was outlined.
-  bool OutlinedSomething = outline(M, CandidateList, FunctionList, Mapper);
+        // MBB is suitable for outlining. Map it to a list of unsigneds.
+        Mapper.convertToUnsignedVec(MBB, *TII);
+      }
+    } while (NextMF != MFs.end() &&
+             (OutlinerMaxMappedInstrs == 0 ||
+              Mapper.UnsignedVec.size() < OutlinerMaxMappedInstrs));
+
+    // Construct a suffix tree, use it to find candidates, and then outline
+    // them.
+    SuffixTree ST(Mapper.UnsignedVec);
+    std::vector<std::shared_ptr<Candidate>> CandidateList;
+    std::vector<OutlinedFunction> FunctionList;
+
+    // Find all of the outlining candidates.
+    unsigned MaxCandidateLen =
+        buildCandidateList(CandidateList, FunctionList, ST, Mapper);
+
+    // Remove candidates that overlap with other candidates.
+    pruneOverlaps(CandidateList, FunctionList, Mapper, MaxCandidateLen);
+
+    // Keep the names of the outlined functions unique across rounds.
+    for (OutlinedFunction &OF : FunctionList)
+      OF.Name += NumFunctionsInPrevRounds;
+    NumFunctionsInPrevRounds += FunctionList.size();
+
+    // Outline each of the candidates and record whether something was
+    // outlined.
+    OutlinedSomething |= outline(M, CandidateList, FunctionList, Mapper);
+  }
 
   return OutlinedSomething;
 }
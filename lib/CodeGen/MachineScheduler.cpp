@@ -122,6 +122,14 @@ static cl::opt<bool> EnableMemOpCluster("misched-cluster", cl::Hidden,
 static cl::opt<bool> VerifyScheduling("verify-misched", cl::Hidden,
   cl::desc("Verify machine instrs before and after machine scheduling"));
 
+// Splitting huge regions bounds the cost of building the scheduling DAG, which
+// grows quadratically with the number of memory operations in a region.
+static cl::opt<unsigned> MaxRegionInstrs("misched-max-region-instrs",
+  cl::Hidden, cl::init(0),
+  cl::desc("Split scheduling regions with more instructions than this, "
+           "leaving one instruction unscheduled at each split "
+           "(0 = no limit)"));
+
 // DAG subtrees must have at least this many nodes.
 static const unsigned MinSubtreeSize = 8;
 
@@ -482,10 +490,14 @@ getSchedRegions(MachineBasicBlock *MBB,
       MachineInstr &MI = *std::prev(I);
       if (isSchedBoundary(&MI, &*MBB, MF, TII))
         break;
-      if (!MI.isDebugInstr())
+      if (!MI.isDebugInstr()) {
+        // Treat MI as a boundary if the region is already full.
+        if (MaxRegionInstrs && NumRegionInstrs == MaxRegionInstrs)
+          break;
         // MBB::size() uses instr_iterator to count. Here we need a bundle to
         // count as a single instruction.
         ++NumRegionInstrs;
+      }
     }
 
     Regions.push_back(SchedRegion(I, RegionEnd, NumRegionInstrs));
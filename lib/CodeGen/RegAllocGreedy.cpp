@@ -85,6 +85,11 @@ using namespace llvm;
 STATISTIC(NumGlobalSplits, "Number of split global live ranges");
 STATISTIC(NumLocalSplits,  "Number of split local live ranges");
 STATISTIC(NumEvicted,      "Number of interferences evicted");
+STATISTIC(NumAssignedFree, "Number of live ranges assigned a free register");
+STATISTIC(NumAssignedByEviction,
+          "Number of live ranges assigned by evicting interferences");
+STATISTIC(NumDeferredToSplit,
+          "Number of live ranges deferred to the split stage");
 
 static cl::opt<SplitEditor::ComplementSpillMode> SplitSpillMode(
     "split-spill-mode", cl::Hidden,
@@ -761,9 +766,15 @@ unsigned RAGreedy::tryAssign(LiveInterval &VirtReg,
                              SmallVectorImpl<unsigned> &NewVRegs) {
   Order.rewind();
   unsigned PhysReg;
-  while ((PhysReg = Order.next()))
-    if (!Matrix->checkInterference(VirtReg, PhysReg))
-      break;
+  {
+    // Only time the scan for a free register; the eviction below has its own
+    // timer.
+    NamedRegionTimer T("assign", "Assign", TimerGroupName,
+                       TimerGroupDescription, TimePassesIsEnabled);
+    while ((PhysReg = Order.next()))
+      if (!Matrix->checkInterference(VirtReg, PhysReg))
+        break;
+  }
   if (!PhysReg || Order.isHint())
     return PhysReg;
 
@@ -2430,10 +2441,11 @@ unsigned RAGreedy::trySplit(LiveInterval &VirtReg, AllocationOrder &Order,
     return tryInstructionSplit(VirtReg, Order, NewVRegs);
   }
 
-  NamedRegionTimer T("global_split", "Global Splitting", TimerGroupName,
-                     TimerGroupDescription, TimePassesIsEnabled);
-
-  SA->analyze(&VirtReg);
+  {
+    NamedRegionTimer T("global_split", "Global Splitting", TimerGroupName,
+                       TimerGroupDescription, TimePassesIsEnabled);
+    SA->analyze(&VirtReg);
+  }
 
   // FIXME: SplitAnalysis may repair broken live ranges coming from the
   // coalescer. That may cause the range to become allocatable which means that
@@ -2442,10 +2454,14 @@ unsigned RAGreedy::trySplit(LiveInterval &VirtReg, AllocationOrder &Order,
   if (SA->didRepairRange()) {
     // VirtReg has changed, so all cached queries are invalid.
     Matrix->invalidateVirtRegs();
+    // tryAssign has its own timer, keep it out of the global split region.
     if (unsigned PhysReg = tryAssign(VirtReg, Order, NewVRegs))
       return PhysReg;
   }
 
+  NamedRegionTimer T("global_split", "Global Splitting", TimerGroupName,
+                     TimerGroupDescription, TimePassesIsEnabled);
+
   // First try to split around a region spanning multiple blocks. RS_Split2
   // ranges already made dubious progress with region splitting, so they go
   // straight to single block splitting.
@@ -3006,8 +3022,10 @@ unsigned RAGreedy::selectOrSplitImpl(LiveInterval &VirtReg,
         // Return now if we decide to use a CSR or create new vregs due to
         // pre-splitting.
         return CSRReg;
-    } else
+    } else {
+      ++NumAssignedFree;
       return PhysReg;
+    }
   }
 
   LiveRangeStage Stage = getStage(VirtReg);
@@ -3031,6 +3049,7 @@ unsigned RAGreedy::selectOrSplitImpl(LiveInterval &VirtReg,
       // If VirtReg eviction someone, the eviction info for it as an evictee is
       // no longre relevant.
       LastEvicted.clearEvicteeInfo(VirtReg.reg);
+      ++NumAssignedByEviction;
       return PhysReg;
     }
 
@@ -3043,6 +3062,7 @@ unsigned RAGreedy::selectOrSplitImpl(LiveInterval &VirtReg,
     setStage(VirtReg, RS_Split);
     LLVM_DEBUG(dbgs() << "wait for second round\n");
     NewVRegs.push_back(VirtReg.reg);
+    ++NumDeferredToSplit;
     return 0;
   }
 
@@ -18,6 +18,7 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/SparseSet.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/iterator_range.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Analysis/ValueTracking.h"
@@ -48,12 +49,14 @@
 #include "llvm/IR/Value.h"
 #include "llvm/MC/LaneBitmask.h"
 #include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/Pass.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
@@ -66,6 +69,14 @@ using namespace llvm;
 
 #define DEBUG_TYPE "machine-scheduler"
 
+STATISTIC(NumMemDepQueries, "Number of memory dependence alias queries");
+STATISTIC(NumMemDeps, "Number of memory dependence edges added");
+STATISTIC(NumMemNodeMapReductions,
+          "Number of memory node map reductions in huge regions");
+
+static const char TimerGroupName[] = "sched";
+static const char TimerGroupDescription[] = "Instruction Scheduling";
+
 static cl::opt<bool> EnableAASchedMI("enable-aa-sched-mi", cl::Hidden,
     cl::ZeroOrMore, cl::init(false),
     cl::desc("Enable use of AA during MI DAG construction"));
@@ -509,10 +520,12 @@ static inline bool isGlobalMemoryObject(AliasAnalysis *AA, MachineInstr *MI) {
 
 void ScheduleDAGInstrs::addChainDependency (SUnit *SUa, SUnit *SUb,
                                             unsigned Latency) {
+  ++NumMemDepQueries;
   if (SUa->getInstr()->mayAlias(AAForDep, *SUb->getInstr(), UseTBAA)) {
     SDep Dep(SUa, SDep::MayAliasMem);
     Dep.setLatency(Latency);
-    SUb->addPred(Dep);
+    if (SUb->addPred(Dep))
+      ++NumMemDeps;
   }
 }
 
@@ -694,6 +707,8 @@ void ScheduleDAGInstrs::buildSchedGraph(AliasAnalysis *AA,
                                         PressureDiffs *PDiffs,
                                         LiveIntervals *LIS,
                                         bool TrackLaneMasks) {
+  NamedRegionTimer T("buildschedgraph", "Build Scheduling DAG", TimerGroupName,
+                     TimerGroupDescription, TimePassesIsEnabled);
   const TargetSubtargetInfo &ST = MF.getSubtarget();
   bool UseAA = EnableAASchedMI.getNumOccurrences() > 0 ? EnableAASchedMI
                                                        : ST.useAA();
@@ -986,6 +1001,7 @@ void ScheduleDAGInstrs::reduceHugeMemNodeMaps(Value2SUsMap &stores,
                                               Value2SUsMap &loads, unsigned N) {
   LLVM_DEBUG(dbgs() << "Before reduction:\nStoring SUnits:\n"; stores.dump();
              dbgs() << "Loading SUnits:\n"; loads.dump());
+  ++NumMemNodeMapReductions;
 
   // Insert all SU's NodeNums into a vector and sort it.
   std::vector<unsigned> NodeNums;
@@ -14,8 +14,11 @@
 #include "llvm/DebugInfo/CodeView/MergingTypeTableBuilder.h"
 #include "llvm/DebugInfo/CodeView/TypeIndex.h"
 #include "llvm/DebugInfo/CodeView/TypeIndexDiscovery.h"
+#include "llvm/DebugInfo/CodeView/TypeHashing.h"
 #include "llvm/DebugInfo/CodeView/TypeRecord.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 
 using namespace llvm;
 using namespace llvm::codeview;
@@ -447,3 +450,69 @@ Error llvm::codeview::mergeIdRecords(GlobalTypeTableBuilder &Dest,
   TypeStreamMerger M(SourceToDest);
   return M.mergeIdRecords(Dest, Types, Ids, Hashes);
 }
+
+Error llvm::codeview::mergeTypeStreams(GlobalTypeTableBuilder &DestIds,
+                                       GlobalTypeTableBuilder &DestTypes,
+                                       ArrayRef<TypeAndIdStreams> Sources,
+                                       unsigned NumThreads) {
+  struct SourceHashes {
+    std::vector<GloballyHashedType> Types;
+    std::vector<GloballyHashedType> Ids;
+  };
+  std::vector<SourceHashes> Hashes(Sources.size());
+
+  // The id hashes of a source depend on its type hashes, so both streams of a
+  // source are hashed by the same task.
+  auto HashSource = [&](size_t I) {
+    if (Sources[I].Types)
+      Hashes[I].Types = GloballyHashedType::hashTypes(*Sources[I].Types);
+    if (Sources[I].Ids)
+      Hashes[I].Ids =
+          GloballyHashedType::hashIds(*Sources[I].Ids, Hashes[I].Types);
+  };
+
+  auto MergeSource = [&](size_t I) -> Error {
+    SmallVector<TypeIndex, 128> TypeMap;
+    SmallVector<TypeIndex, 128> IdMap;
+    if (Sources[I].Types)
+      if (auto EC = mergeTypeRecords(DestTypes, TypeMap, *Sources[I].Types,
+                                     Hashes[I].Types))
+        return EC;
+    if (Sources[I].Ids)
+      if (auto EC = mergeIdRecords(DestIds, TypeMap, IdMap, *Sources[I].Ids,
+                                   Hashes[I].Ids))
+        return EC;
+    // The hashes of a merged source are not needed anymore.
+    Hashes[I] = SourceHashes();
+    return Error::success();
+  };
+
+  if (NumThreads == 0)
+    NumThreads = hardware_concurrency();
+  NumThreads = std::min<size_t>(NumThreads, Sources.size());
+
+  if (NumThreads <= 1) {
+    for (size_t I = 0, E = Sources.size(); I != E; ++I) {
+      HashSource(I);
+      if (auto EC = MergeSource(I))
+        return EC;
+    }
+    return Error::success();
+  }
+
+  // Merging is serial, but overlaps with the hashing of the sources that come
+  // after the one being merged. The pool is destroyed, and its pending tasks
+  // finished, before the hashes go away.
+  ThreadPool Pool(NumThreads);
+  std::vector<std::shared_future<void>> Hashed;
+  Hashed.reserve(Sources.size());
+  for (size_t I = 0, E = Sources.size(); I != E; ++I)
+    Hashed.push_back(Pool.async(HashSource, I));
+
+  for (size_t I = 0, E = Sources.size(); I != E; ++I) {
+    Hashed[I].wait();
+    if (auto EC = MergeSource(I))
+      return EC;
+  }
+  return Error::success();
+}
@@ -45,6 +45,8 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
@@ -619,6 +621,39 @@ DWARFDie DWARFContext::getDIEForOffset(uint32_t Offset) {
   return DWARFDie();
 }
 
+void DWARFContext::parseUnitDIEs(ArrayRef<DWARFUnit *> Units,
+                                 unsigned NumThreads) {
+  // DWARFDebugAbbrev extracts declaration sets lazily and caches the unit's
+  // set on first use, so do this before any DIE is extracted concurrently.
+  for (DWARFUnit *U : Units)
+    U->getAbbreviations();
+
+  if (NumThreads == 0)
+    NumThreads = hardware_concurrency();
+  NumThreads = std::min<size_t>(NumThreads, Units.size());
+  if (NumThreads <= 1) {
+    for (DWARFUnit *U : Units)
+      U->getUnitDIE(/*ExtractUnitDIEOnly=*/false);
+    return;
+  }
+
+  // Diagnostics are buffered per unit and printed in unit order, rather than
+  // interleaved in whatever order the threads find them.
+  std::vector<std::string> Diags(Units.size());
+  ThreadPool Pool(NumThreads);
+  for (size_t I = 0, E = Units.size(); I != E; ++I) {
+    DWARFUnit *U = Units[I];
+    std::string *Diag = &Diags[I];
+    Pool.async([U, Diag] {
+      raw_string_ostream OS(*Diag);
+      U->extractDIEs(OS);
+    });
+  }
+  Pool.wait();
+  for (const std::string &Diag : Diags)
+    errs() << Diag;
+}
+
 bool DWARFContext::verify(raw_ostream &OS, DIDumpOptions DumpOpts) {
   bool Success = true;
   DWARFVerifier verifier(OS, *this, DumpOpts);
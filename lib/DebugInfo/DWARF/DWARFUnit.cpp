@@ -253,9 +253,20 @@ void DWARFUnit::extractDIEsToVector(
   // should always terminate at or before the start of the next compilation
   // unit header).
   if (DIEOffset > NextCUOffset)
-    WithColor::warning() << format("DWARF compile unit extends beyond its "
-                                   "bounds cu 0x%8.8x at 0x%8.8x\n",
-                                   getOffset(), DIEOffset);
+    WithColor::warning(diagStream())
+        << format("DWARF compile unit extends beyond its "
+                  "bounds cu 0x%8.8x at 0x%8.8x\n",
+                  getOffset(), DIEOffset);
+}
+
+raw_ostream &DWARFUnit::diagStream() const {
+  return DiagOS ? *DiagOS : errs();
+}
+
+void DWARFUnit::extractDIEs(raw_ostream &OS) {
+  DiagOS = &OS;
+  extractDIEsIfNeeded(false);
+  DiagOS = nullptr;
 }
 
 size_t DWARFUnit::extractDIEsIfNeeded(bool CUDieOnly) {
@@ -323,7 +334,7 @@ size_t DWARFUnit::extractDIEsIfNeeded(bool CUDieOnly) {
                 parseRngListTableHeader(RangesDA, RangeSectionBase))
           RngListTable = TableOrError.get();
         else
-          WithColor::error() << "parsing a range list table: "
+          WithColor::error(diagStream()) << "parsing a range list table: "
                              << toString(TableOrError.takeError())
                              << '\n';
 
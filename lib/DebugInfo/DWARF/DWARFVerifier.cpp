@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/DebugInfo/DWARF/DWARFVerifier.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/DebugInfo/DWARF/DWARFCompileUnit.h"
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
@@ -18,10 +19,13 @@
 #include "llvm/DebugInfo/DWARF/DWARFSection.h"
 #include "llvm/Support/DJB.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/raw_ostream.h"
 #include <map>
 #include <set>
+#include <string>
 #include <vector>
 
 using namespace llvm;
@@ -266,6 +270,88 @@ bool DWARFVerifier::handleDebugInfo() {
   bool hasDIE = DebugInfoData.isValidOffset(Offset);
   DWARFUnitSection<DWARFTypeUnit> TUSection{};
   DWARFUnitSection<DWARFCompileUnit> CUSection{};
+  auto CreateUnit = [&](const DWARFUnitHeader &Header,
+                        uint8_t Type) -> std::unique_ptr<DWARFUnit> {
+    switch (Type) {
+    case dwarf::DW_UT_type:
+    case dwarf::DW_UT_split_type:
+      return llvm::make_unique<DWARFTypeUnit>(
+          DCtx, DObj.getInfoSection(), Header, DCtx.getDebugAbbrev(),
+          &DObj.getRangeSection(), DObj.getStringSection(),
+          DObj.getStringOffsetSection(), &DObj.getAppleObjCSection(),
+          DObj.getLineSection(), DCtx.isLittleEndian(), false, TUSection);
+    case dwarf::DW_UT_skeleton:
+    case dwarf::DW_UT_split_compile:
+    case dwarf::DW_UT_compile:
+    case dwarf::DW_UT_partial:
+    // UnitType = 0 means that we are
+    // verifying a compile unit in DWARF v4.
+    case 0:
+      return llvm::make_unique<DWARFCompileUnit>(
+          DCtx, DObj.getInfoSection(), Header, DCtx.getDebugAbbrev(),
+          &DObj.getRangeSection(), DObj.getStringSection(),
+          DObj.getStringOffsetSection(), &DObj.getAppleObjCSection(),
+          DObj.getLineSection(), DCtx.isLittleEndian(), false, CUSection);
+    default: { llvm_unreachable("Invalid UnitType."); }
+    }
+  };
+
+  // When more than one thread may be used, create the units of the leading
+  // well-formed headers up front and extract their DIEs on a thread pool, a
+  // bounded number of units ahead of the verification. The loop below still
+  // verifies the headers and units one by one, so diagnostics keep their order,
+  // and every unit is freed once it has been verified.
+  std::vector<std::pair<uint32_t, std::unique_ptr<DWARFUnit>>> Prepared;
+  unsigned NumThreads = DumpOpts.NumThreads;
+  if (NumThreads == 0)
+    NumThreads = hardware_concurrency();
+  if (NumThreads > 1) {
+    uint32_t PrepOffset = 0;
+    while (DebugInfoData.isValidOffset(PrepOffset)) {
+      uint32_t UnitOffset = PrepOffset;
+      DWARFUnitHeader Header;
+      if (!Header.extract(DCtx, DebugInfoData, &PrepOffset) ||
+          Header.getLength() == UINT32_MAX ||
+          !dwarf::isUnitType(Header.getUnitType()) ||
+          !DCtx.getDebugAbbrev()->getAbbreviationDeclarationSet(
+              Header.getAbbrOffset()))
+        break;
+      auto Unit = CreateUnit(Header, Header.getUnitType());
+      // The abbreviation set is resolved lazily, do it before the DIEs are
+      // extracted on another thread.
+      Unit->getAbbreviations();
+      Prepared.emplace_back(UnitOffset, std::move(Unit));
+      PrepOffset = Header.getNextUnitOffset();
+    }
+  }
+
+  // Declared after Prepared, so that the pool is joined before the units its
+  // tasks extract are destroyed.
+  std::unique_ptr<ThreadPool> Pool;
+  if (Prepared.size() > 1)
+    Pool = llvm::make_unique<ThreadPool>(
+        std::min<size_t>(NumThreads, Prepared.size()));
+  std::vector<std::shared_future<void>> Extracted;
+  // The diagnostics found while extracting each unit, printed when the unit is
+  // verified so that they do not interleave.
+  std::vector<std::string> ExtractDiags(Pool ? Prepared.size() : 0);
+  const size_t ExtractWindow = 2 * NumThreads;
+  auto ExtractAhead = [&](size_t End) {
+    if (!Pool)
+      return;
+    for (size_t I = Extracted.size(), E = std::min(End, Prepared.size());
+         I < E; ++I) {
+      DWARFUnit *U = Prepared[I].second.get();
+      std::string *Diag = &ExtractDiags[I];
+      Extracted.push_back(Pool->async([U, Diag] {
+        raw_string_ostream OS(*Diag);
+        U->extractDIEs(OS);
+      }));
+    }
+  };
+  ExtractAhead(ExtractWindow);
+  size_t NextPrepared = 0;
+
   while (hasDIE) {
     OffsetStart = Offset;
     if (!verifyUnitHeader(DebugInfoData, &Offset, UnitIdx, UnitType,
@@ -274,34 +360,20 @@ bool DWARFVerifier::handleDebugInfo() {
       if (isUnitDWARF64)
         break;
     } else {
-      DWARFUnitHeader Header;
-      Header.extract(DCtx, DebugInfoData, &OffsetStart);
       std::unique_ptr<DWARFUnit> Unit;
-      switch (UnitType) {
-      case dwarf::DW_UT_type:
-      case dwarf::DW_UT_split_type: {
-        Unit.reset(new DWARFTypeUnit(
-            DCtx, DObj.getInfoSection(), Header, DCtx.getDebugAbbrev(),
-            &DObj.getRangeSection(), DObj.getStringSection(),
-            DObj.getStringOffsetSection(), &DObj.getAppleObjCSection(),
-            DObj.getLineSection(), DCtx.isLittleEndian(), false, TUSection));
-        break;
-      }
-      case dwarf::DW_UT_skeleton:
-      case dwarf::DW_UT_split_compile:
-      case dwarf::DW_UT_compile:
-      case dwarf::DW_UT_partial:
-      // UnitType = 0 means that we are
-      // verifying a compile unit in DWARF v4.
-      case 0: {
-        Unit.reset(new DWARFCompileUnit(
-            DCtx, DObj.getInfoSection(), Header, DCtx.getDebugAbbrev(),
-            &DObj.getRangeSection(), DObj.getStringSection(),
-            DObj.getStringOffsetSection(), &DObj.getAppleObjCSection(),
-            DObj.getLineSection(), DCtx.isLittleEndian(), false, CUSection));
-        break;
-      }
-      default: { llvm_unreachable("Invalid UnitType."); }
+      if (NextPrepared < Prepared.size() &&
+          Prepared[NextPrepared].first == OffsetStart) {
+        ExtractAhead(NextPrepared + 1 + ExtractWindow);
+        if (NextPrepared < Extracted.size()) {
+          Extracted[NextPrepared].wait();
+          errs() << ExtractDiags[NextPrepared];
+          std::string().swap(ExtractDiags[NextPrepared]);
+        }
+        Unit = std::move(Prepared[NextPrepared++].second);
+      } else {
+        DWARFUnitHeader Header;
+        Header.extract(DCtx, DebugInfoData, &OffsetStart);
+        Unit = CreateUnit(Header, UnitType);
       }
       if (!verifyUnitContents(*Unit, UnitType))
         ++NumDebugInfoErrors;
@@ -0,0 +1,403 @@
+//===- SymbolizableIndex.cpp ----------------------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Implementation of SymbolizableIndex class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "SymbolizableIndex.h"
+#include "SymbolizableObjectFile.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/BinaryFormat/Dwarf.h"
+#include "llvm/DebugInfo/DWARF/DWARFContext.h"
+#include "llvm/DebugInfo/DWARF/DWARFDebugLine.h"
+#include "llvm/DebugInfo/DWARF/DWARFDie.h"
+#include "llvm/Support/Errc.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace llvm;
+using namespace symbolize;
+
+static const char IndexMagic[8] = {'L', 'L', 'V', 'M', 'S', 'Y', 'M', 'X'};
+static const uint32_t IndexVersion = 2;
+
+enum IndexFlags : uint32_t {
+  IF_Win32Module = 1U << 0,
+  IF_UseSymbolTable = 1U << 1,
+};
+
+static_assert(sizeof(index::Header) == 48, "unexpected index header size");
+static_assert(sizeof(index::Range) == 24, "unexpected index range size");
+static_assert(sizeof(index::Frame) == 24, "unexpected index frame size");
+static_assert(sizeof(index::Dependency) == 24,
+              "unexpected index dependency size");
+
+static Error createIndexError(const Twine &Path, const char *Reason) {
+  return createStringError(make_error_code(errc::invalid_argument), "%s: %s",
+                           Path.str().c_str(), Reason);
+}
+
+// Records whether the file at Path exists, and if so its size and
+// modification time.
+static void statDependency(StringRef Path, index::Dependency &D) {
+  sys::fs::file_status Status;
+  if (sys::fs::status(Path, Status) || !sys::fs::exists(Status)) {
+    D.Exists = 0;
+    D.Size = 0;
+    D.ModificationTime = 0;
+    return;
+  }
+  D.Exists = 1;
+  D.Size = Status.getSize();
+  D.ModificationTime =
+      Status.getLastModificationTime().time_since_epoch().count();
+}
+
+namespace {
+
+/// Accumulates the string table of an index.
+class StringTable {
+  StringMap<uint32_t> Offsets;
+  std::string Data;
+
+public:
+  uint32_t add(StringRef S) {
+    auto Inserted = Offsets.insert(std::make_pair(S, uint32_t(Data.size())));
+    if (Inserted.second) {
+      Data += S;
+      Data += '\0';
+    }
+    return Inserted.first->second;
+  }
+
+  StringRef data() const { return Data; }
+};
+
+} // end anonymous namespace
+
+Error SymbolizableIndex::write(StringRef Path,
+                               const SymbolizableObjectFile &Module,
+                               DWARFContext &DICtx, StringRef DWPName,
+                               ArrayRef<std::string> DebugFiles,
+                               FunctionNameKind FNKind, bool UseSymbolTable) {
+  // Addresses at which the answer of the module may change.
+  std::vector<uint64_t> Bounds;
+  // The address ranges described by a line table row.
+  std::vector<std::pair<uint64_t, uint64_t>> Rows;
+  // The files other than the binary the answers may depend on.
+  std::vector<std::string> DependencyPaths(DebugFiles.begin(),
+                                           DebugFiles.end());
+
+  for (const auto &CU : DICtx.compile_units()) {
+    // Find the .dwo file of a skeleton unit the way DWARFUnit::parseDWO()
+    // does.
+    DWARFDie UnitDie = CU->getUnitDIE();
+    if (auto DWOName =
+            dwarf::toString(UnitDie.find(dwarf::DW_AT_GNU_dwo_name))) {
+      SmallString<128> DWOPath;
+      auto CompDir = dwarf::toString(UnitDie.find(dwarf::DW_AT_comp_dir));
+      if (sys::path::is_relative(*DWOName) && CompDir && *CompDir)
+        sys::path::append(DWOPath, *CompDir);
+      sys::path::append(DWOPath, *DWOName);
+      DependencyPaths.push_back(DWOPath.str());
+    }
+
+    if (const DWARFDebugLine::LineTable *LT =
+            DICtx.getLineTableForUnit(CU.get()))
+      for (const DWARFDebugLine::Sequence &Seq : LT->Sequences)
+        for (unsigned I = Seq.FirstRowIndex; I + 1 < Seq.LastRowIndex; ++I) {
+          uint64_t Start = LT->Rows[I].Address;
+          uint64_t End = LT->Rows[I + 1].Address;
+          Bounds.push_back(Start);
+          if (Start < End)
+            Rows.emplace_back(Start, End);
+          else
+            // The line table answers with the first of the rows at an
+            // address, and with the last one after it.
+            Bounds.push_back(Start + 1);
+        }
+    for (const DWARFDebugInfoEntry &Entry : CU->dies()) {
+      DWARFDie Die(CU.get(), &Entry);
+      dwarf::Tag Tag = Die.getTag();
+      if (Tag != dwarf::DW_TAG_compile_unit &&
+          Tag != dwarf::DW_TAG_subprogram &&
+          Tag != dwarf::DW_TAG_inlined_subroutine)
+        continue;
+      auto RangesOrErr = Die.getAddressRanges();
+      if (!RangesOrErr) {
+        consumeError(RangesOrErr.takeError());
+        continue;
+      }
+      for (const DWARFAddressRange &R : *RangesOrErr) {
+        Bounds.push_back(R.LowPC);
+        Bounds.push_back(R.HighPC);
+      }
+    }
+  }
+
+  // The module overrides function names with its symbol table.
+  for (const auto &Sym : Module.getFunctionSymbols()) {
+    Bounds.push_back(Sym.first);
+    if (Sym.second)
+      Bounds.push_back(Sym.first + Sym.second);
+  }
+
+  llvm::sort(Bounds.begin(), Bounds.end());
+  Bounds.erase(std::unique(Bounds.begin(), Bounds.end()), Bounds.end());
+  llvm::sort(Rows.begin(), Rows.end());
+
+  std::vector<index::Range> Ranges;
+  std::vector<index::Frame> Frames;
+  StringTable Strings;
+  SmallVector<DILineInfo, 4> PrevInfos;
+  auto HasSource = [](const DILineInfo &Info) { return bool(Info.Source); };
+  uint64_t CoveredEnd = 0;
+  for (const auto &Row : Rows) {
+    // Rows of different units may overlap; index each address once.
+    uint64_t Start = std::max(Row.first, CoveredEnd);
+    uint64_t End = Row.second;
+    if (Start >= End)
+      continue;
+    CoveredEnd = End;
+
+    for (uint64_t Address = Start; Address < End;) {
+      auto NextBound = std::upper_bound(Bounds.begin(), Bounds.end(), Address);
+      uint64_t PieceEnd =
+          NextBound == Bounds.end() ? End : std::min(*NextBound, End);
+
+      SmallVector<DILineInfo, 4> Infos;
+      Infos.push_back(Module.symbolizeCode(Address, FNKind, UseSymbolTable));
+      DIInliningInfo Inlined =
+          Module.symbolizeInlinedCode(Address, FNKind, UseSymbolTable);
+      for (uint32_t I = 0, N = Inlined.getNumberOfFrames(); I != N; ++I)
+        Infos.push_back(Inlined.getFrame(I));
+
+      // Embedded source is not stored; leave these addresses to the module.
+      if (any_of(Infos, HasSource)) {
+        PrevInfos.clear();
+      } else if (!Ranges.empty() && Ranges.back().End == Address &&
+                 Infos == PrevInfos) {
+        Ranges.back().End = PieceEnd;
+      } else {
+        index::Range R;
+        R.Start = Address;
+        R.End = PieceEnd;
+        R.FirstFrame = Frames.size();
+        R.NumFrames = Infos.size();
+        Ranges.push_back(R);
+        for (const DILineInfo &Info : Infos) {
+          index::Frame F;
+          F.FunctionName = Strings.add(Info.FunctionName);
+          F.FileName = Strings.add(Info.FileName);
+          F.Line = Info.Line;
+          F.Column = Info.Column;
+          F.StartLine = Info.StartLine;
+          F.Discriminator = Info.Discriminator;
+          Frames.push_back(F);
+        }
+        PrevInfos = std::move(Infos);
+      }
+      Address = PieceEnd;
+    }
+  }
+
+  llvm::sort(DependencyPaths.begin(), DependencyPaths.end());
+  DependencyPaths.erase(
+      std::unique(DependencyPaths.begin(), DependencyPaths.end()),
+      DependencyPaths.end());
+  std::vector<index::Dependency> Dependencies(DependencyPaths.size());
+  for (size_t I = 0, E = DependencyPaths.size(); I != E; ++I) {
+    Dependencies[I].Path = Strings.add(DependencyPaths[I]);
+    statDependency(DependencyPaths[I], Dependencies[I]);
+  }
+
+  index::Header Hdr;
+  memcpy(Hdr.Magic, IndexMagic, sizeof(IndexMagic));
+  Hdr.Version = IndexVersion;
+  Hdr.Flags = (Module.isWin32Module() ? IF_Win32Module : 0) |
+              (UseSymbolTable ? IF_UseSymbolTable : 0);
+  Hdr.FNKind = static_cast<uint32_t>(FNKind);
+  Hdr.NumRanges = Ranges.size();
+  Hdr.NumFrames = Frames.size();
+  Hdr.PreferredBase = Module.getModulePreferredBase();
+  Hdr.NumDependencies = Dependencies.size();
+  Hdr.DWPName = Strings.add(DWPName);
+  Hdr.StringTableSize = Strings.data().size();
+
+  // Write to a temporary file and rename it, so that concurrent symbolizers
+  // never see a partial index.
+  int FD;
+  SmallString<128> TempPath;
+  if (std::error_code EC =
+          sys::fs::createUniqueFile(Path + ".tmp%%%%%%", FD, TempPath))
+    return errorCodeToError(EC);
+  {
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS.write(reinterpret_cast<const char *>(&Hdr), sizeof(Hdr));
+    OS.write(reinterpret_cast<const char *>(Ranges.data()),
+             Ranges.size() * sizeof(index::Range));
+    OS.write(reinterpret_cast<const char *>(Frames.data()),
+             Frames.size() * sizeof(index::Frame));
+    OS.write(reinterpret_cast<const char *>(Dependencies.data()),
+             Dependencies.size() * sizeof(index::Dependency));
+    OS << Strings.data();
+    OS.close();
+    if (OS.has_error()) {
+      OS.clear_error();
+      sys::fs::remove(TempPath);
+      return createIndexError(TempPath, "cannot write symbolization index");
+    }
+  }
+  if (std::error_code EC = sys::fs::rename(TempPath, Path)) {
+    sys::fs::remove(TempPath);
+    return errorCodeToError(EC);
+  }
+  return Error::success();
+}
+
+SymbolizableIndex::SymbolizableIndex(std::unique_ptr<MemoryBuffer> Buffer)
+    : Buffer(std::move(Buffer)), Hdr(nullptr) {}
+
+Expected<std::unique_ptr<SymbolizableIndex>>
+SymbolizableIndex::load(StringRef Path, FunctionNameKind FNKind,
+                        bool UseSymbolTable, StringRef DWPName) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr = MemoryBuffer::getFile(
+      Path, /*FileSize=*/-1, /*RequiresNullTerminator=*/false);
+  if (!BufOrErr)
+    return errorCodeToError(BufOrErr.getError());
+
+  std::unique_ptr<SymbolizableIndex> Index(
+      new SymbolizableIndex(std::move(*BufOrErr)));
+  StringRef Data = Index->Buffer->getBuffer();
+  if (Data.size() < sizeof(index::Header))
+    return createIndexError(Path, "truncated symbolization index");
+  const auto *Hdr = reinterpret_cast<const index::Header *>(Data.data());
+  if (memcmp(Hdr->Magic, IndexMagic, sizeof(IndexMagic)) != 0 ||
+      Hdr->Version != IndexVersion)
+    return createIndexError(Path, "not a symbolization index");
+  if (Hdr->FNKind != static_cast<uint32_t>(FNKind) ||
+      bool(Hdr->Flags & IF_UseSymbolTable) != UseSymbolTable)
+    return createIndexError(Path, "index was built with different options");
+
+  uint64_t RangesSize = uint64_t(Hdr->NumRanges) * sizeof(index::Range);
+  uint64_t FramesSize = uint64_t(Hdr->NumFrames) * sizeof(index::Frame);
+  uint64_t DependenciesSize =
+      uint64_t(Hdr->NumDependencies) * sizeof(index::Dependency);
+  if (Data.size() != sizeof(index::Header) + RangesSize + FramesSize +
+                         DependenciesSize + Hdr->StringTableSize)
+    return createIndexError(Path, "truncated symbolization index");
+  if (Hdr->StringTableSize != 0 && Data.back() != '\0')
+    return createIndexError(Path, "malformed string table");
+
+  const char *Cur = Data.data() + sizeof(index::Header);
+  Index->Hdr = Hdr;
+  Index->Ranges = makeArrayRef(reinterpret_cast<const index::Range *>(Cur),
+                               Hdr->NumRanges);
+  Cur += RangesSize;
+  Index->Frames = makeArrayRef(reinterpret_cast<const index::Frame *>(Cur),
+                               Hdr->NumFrames);
+  Cur += FramesSize;
+  ArrayRef<index::Dependency> Dependencies(
+      reinterpret_cast<const index::Dependency *>(Cur), Hdr->NumDependencies);
+  Cur += DependenciesSize;
+  Index->Strings = StringRef(Cur, Hdr->StringTableSize);
+
+  if (Index->getString(Hdr->DWPName) != DWPName)
+    return createIndexError(Path, "index was built with a different DWP file");
+  for (const index::Dependency &D : Dependencies) {
+    index::Dependency Current;
+    statDependency(Index->getString(D.Path), Current);
+    if (Current.Exists != D.Exists || Current.Size != D.Size ||
+        Current.ModificationTime != D.ModificationTime)
+      return createIndexError(Path, "index is out of date");
+  }
+  return std::move(Index);
+}
+
+const index::Range *SymbolizableIndex::lookup(uint64_t ModuleOffset) const {
+  auto It = std::upper_bound(Ranges.begin(), Ranges.end(), ModuleOffset,
+                             [](uint64_t Address, const index::Range &R) {
+                               return Address < R.Start;
+                             });
+  if (It == Ranges.begin())
+    return nullptr;
+  --It;
+  if (ModuleOffset >= It->End || It->NumFrames < 2 ||
+      uint64_t(It->FirstFrame) + It->NumFrames > Frames.size())
+    return nullptr;
+  return &*It;
+}
+
+StringRef SymbolizableIndex::getString(uint32_t Offset) const {
+  if (Offset >= Strings.size())
+    return StringRef();
+  return StringRef(Strings.data() + Offset);
+}
+
+DILineInfo SymbolizableIndex::getFrame(uint32_t Index) const {
+  const index::Frame &F = Frames[Index];
+  DILineInfo Info;
+  Info.FunctionName = getString(F.FunctionName);
+  Info.FileName = getString(F.FileName);
+  Info.Line = F.Line;
+  Info.Column = F.Column;
+  Info.StartLine = F.StartLine;
+  Info.Discriminator = F.Discriminator;
+  return Info;
+}
+
+DILineInfo SymbolizableIndex::symbolizeCode(uint64_t ModuleOffset,
+                                            FunctionNameKind FNKind,
+                                            bool UseSymbolTable) const {
+  assert(Hdr->FNKind == static_cast<uint32_t>(FNKind) &&
+         bool(Hdr->Flags & IF_UseSymbolTable) == UseSymbolTable &&
+         "index was built with different options");
+  const index::Range *R = lookup(ModuleOffset);
+  if (!R)
+    return DILineInfo();
+  return getFrame(R->FirstFrame);
+}
+
+DIInliningInfo SymbolizableIndex::symbolizeInlinedCode(
+    uint64_t ModuleOffset, FunctionNameKind FNKind, bool UseSymbolTable) const {
+  assert(Hdr->FNKind == static_cast<uint32_t>(FNKind) &&
+         bool(Hdr->Flags & IF_UseSymbolTable) == UseSymbolTable &&
+         "index was built with different options");
+  DIInliningInfo InlinedContext;
+  if (const index::Range *R = lookup(ModuleOffset))
+    for (uint32_t I = 1; I != R->NumFrames; ++I)
+      InlinedContext.addFrame(getFrame(R->FirstFrame + I));
+  // Make sure there is at least one frame in context.
+  if (InlinedContext.getNumberOfFrames() == 0)
+    InlinedContext.addFrame(DILineInfo());
+  return InlinedContext;
+}
+
+DIGlobal SymbolizableIndex::symbolizeData(uint64_t ModuleOffset) const {
+  // Data symbols are not indexed.
+  return DIGlobal();
+}
+
+bool SymbolizableIndex::isWin32Module() const {
+  return Hdr->Flags & IF_Win32Module;
+}
+
+uint64_t SymbolizableIndex::getModulePreferredBase() const {
+  return Hdr->PreferredBase;
+}
@@ -0,0 +1,152 @@
+//===- SymbolizableIndex.h --------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares the SymbolizableIndex class, an on-disk table of the
+// answers a SymbolizableModule gives for every address covered by the line
+// table of a binary.
+//
+//===----------------------------------------------------------------------===//
+#ifndef LLVM_LIB_DEBUGINFO_SYMBOLIZE_SYMBOLIZABLEINDEX_H
+#define LLVM_LIB_DEBUGINFO_SYMBOLIZE_SYMBOLIZABLEINDEX_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/DebugInfo/DIContext.h"
+#include "llvm/DebugInfo/Symbolize/SymbolizableModule.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace llvm {
+
+class DWARFContext;
+
+namespace symbolize {
+
+class SymbolizableObjectFile;
+
+namespace index {
+
+/// The file starts with a header, followed by the ranges sorted by address,
+/// the frames the ranges refer to, the files the index depends on and a table
+/// of null-terminated strings. Everything is little-endian.
+struct Header {
+  char Magic[8];
+  support::ulittle32_t Version;
+  support::ulittle32_t Flags;
+  support::ulittle32_t FNKind;
+  support::ulittle32_t NumRanges;
+  support::ulittle32_t NumFrames;
+  support::ulittle32_t StringTableSize;
+  support::ulittle64_t PreferredBase;
+  support::ulittle32_t NumDependencies;
+  /// The DWP file name the index was built with, as given by the caller.
+  support::ulittle32_t DWPName;
+};
+
+/// The addresses [Start, End) all symbolize to the frames [FirstFrame,
+/// FirstFrame + NumFrames). The first frame is the symbolizeCode() result,
+/// the others the symbolizeInlinedCode() ones.
+struct Range {
+  support::ulittle64_t Start;
+  support::ulittle64_t End;
+  support::ulittle32_t FirstFrame;
+  support::ulittle32_t NumFrames;
+};
+
+/// A DILineInfo. Names are offsets into the string table.
+struct Frame {
+  support::ulittle32_t FunctionName;
+  support::ulittle32_t FileName;
+  support::ulittle32_t Line;
+  support::ulittle32_t Column;
+  support::ulittle32_t StartLine;
+  support::ulittle32_t Discriminator;
+};
+
+/// A file, other than the binary itself, that debug info was or could have
+/// been read from when building the index. The index is out of date once the
+/// file changes, appears or goes away.
+struct Dependency {
+  support::ulittle32_t Path;
+  support::ulittle32_t Exists;
+  support::ulittle64_t Size;
+  support::ulittle64_t ModificationTime;
+};
+
+} // end namespace index
+
+/// A symbolization index maps the address ranges covered by the line table of
+/// a binary to the results of symbolizeCode() and symbolizeInlinedCode() for
+/// these ranges. The ranges are split wherever the answer may change (line
+/// table rows, subprogram and inlined subroutine ranges, function symbols), so
+/// a lookup gives exactly what the module would. The file is memory mapped
+/// and only the pages touched by lookups are read.
+///
+/// Only addresses covered by the line table are indexed; callers fall back to
+/// the module itself for anything else, and for data symbols.
+class SymbolizableIndex : public SymbolizableModule {
+public:
+  /// Map the index at \p Path. Fails if the file is not an index, was built
+  /// for a different function name kind, symbol table setting or DWP file
+  /// name, or if one of the files it depends on has changed since.
+  static Expected<std::unique_ptr<SymbolizableIndex>>
+  load(StringRef Path, FunctionNameKind FNKind, bool UseSymbolTable,
+       StringRef DWPName);
+
+  /// Write the index of \p Module to \p Path. \p DICtx is the DWARF the
+  /// module reads, built with \p DWPName. \p DebugFiles are the files other
+  /// than the binary the debug info may come from, such as a dSYM or a DWP
+  /// file; the index depends on them and on the .dwo files of the units.
+  static Error write(StringRef Path, const SymbolizableObjectFile &Module,
+                     DWARFContext &DICtx, StringRef DWPName,
+                     ArrayRef<std::string> DebugFiles,
+                     FunctionNameKind FNKind, bool UseSymbolTable);
+
+  /// Return true if \p ModuleOffset is covered by the index.
+  bool contains(uint64_t ModuleOffset) const {
+    return lookup(ModuleOffset) != nullptr;
+  }
+
+  DILineInfo symbolizeCode(uint64_t ModuleOffset, FunctionNameKind FNKind,
+                           bool UseSymbolTable) const override;
+  DIInliningInfo symbolizeInlinedCode(uint64_t ModuleOffset,
+                                      FunctionNameKind FNKind,
+                                      bool UseSymbolTable) const override;
+  DIGlobal symbolizeData(uint64_t ModuleOffset) const override;
+
+  // Return true if this is a 32-bit x86 PE COFF module.
+  bool isWin32Module() const override;
+
+  // Returns the preferred base of the module, i.e. where the loader would place
+  // it in memory assuming there were no conflicts.
+  uint64_t getModulePreferredBase() const override;
+
+private:
+  SymbolizableIndex(std::unique_ptr<MemoryBuffer> Buffer);
+
+  const index::Range *lookup(uint64_t ModuleOffset) const;
+  DILineInfo getFrame(uint32_t Index) const;
+  StringRef getString(uint32_t Offset) const;
+
+  std::unique_ptr<MemoryBuffer> Buffer;
+  const index::Header *Hdr;
+  ArrayRef<index::Range> Ranges;
+  ArrayRef<index::Frame> Frames;
+  StringRef Strings;
+};
+
+} // end namespace symbolize
+
+} // end namespace llvm
+
+#endif // LLVM_LIB_DEBUGINFO_SYMBOLIZE_SYMBOLIZABLEINDEX_H
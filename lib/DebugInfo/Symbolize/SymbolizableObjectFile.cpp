@@ -186,6 +186,15 @@ uint64_t SymbolizableObjectFile::getModulePreferredBase() const {
   return 0;
 }
 
+std::vector<std::pair<uint64_t, uint64_t>>
+SymbolizableObjectFile::getFunctionSymbols() const {
+  std::vector<std::pair<uint64_t, uint64_t>> Result;
+  Result.reserve(Functions.size());
+  for (const auto &F : Functions)
+    Result.emplace_back(F.first.Addr, F.first.Size);
+  return Result;
+}
+
 bool SymbolizableObjectFile::getNameFromSymbolTable(SymbolRef::Type Type,
                                                     uint64_t Address,
                                                     std::string &Name,
@@ -22,6 +22,8 @@
 #include <memory>
 #include <string>
 #include <system_error>
+#include <utility>
+#include <vector>
 
 namespace llvm {
 
@@ -48,6 +50,11 @@ public:
   // it in memory assuming there were no conflicts.
   uint64_t getModulePreferredBase() const override;
 
+  // Returns the start address and size of every function symbol the module
+  // may take function names from. A size of 0 means that the symbol extends
+  // up to the following one.
+  std::vector<std::pair<uint64_t, uint64_t>> getFunctionSymbols() const;
+
 private:
   bool shouldOverrideWithSymbolTable(FunctionNameKind FNKind,
                                      bool UseSymbolTable) const;
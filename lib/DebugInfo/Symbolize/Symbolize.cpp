@@ -13,9 +13,11 @@
 
 #include "llvm/DebugInfo/Symbolize/Symbolize.h"
 
+#include "SymbolizableIndex.h"
 #include "SymbolizableObjectFile.h"
 
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/BinaryFormat/COFF.h"
 #include "llvm/Config/config.h"
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
@@ -23,6 +25,7 @@
 #include "llvm/DebugInfo/PDB/PDBContext.h"
 #include "llvm/Demangle/Demangle.h"
 #include "llvm/Object/COFF.h"
+#include "llvm/Object/ELFObjectFile.h"
 #include "llvm/Object/MachO.h"
 #include "llvm/Object/MachOUniversal.h"
 #include "llvm/Support/Casting.h"
@@ -32,6 +35,7 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/xxhash.h"
 #include <algorithm>
 #include <cassert>
 #include <cstdlib>
@@ -56,6 +60,25 @@ namespace symbolize {
 Expected<DILineInfo>
 LLVMSymbolizer::symbolizeCode(const std::string &ModuleName,
                               uint64_t ModuleOffset, StringRef DWPName) {
+  if (!Opts.IndexDir.empty()) {
+    SymbolizableIndex *Index;
+    if (auto IndexOrErr = getOrCreateIndex(ModuleName, DWPName))
+      Index = IndexOrErr.get();
+    else
+      return IndexOrErr.takeError();
+
+    uint64_t Address = ModuleOffset;
+    if (Index && Opts.RelativeAddresses)
+      Address += Index->getModulePreferredBase();
+    if (Index && Index->contains(Address)) {
+      DILineInfo LineInfo = Index->symbolizeCode(Address, Opts.PrintFunctions,
+                                                 Opts.UseSymbolTable);
+      if (Opts.Demangle)
+        LineInfo.FunctionName = DemangleName(LineInfo.FunctionName, Index);
+      return LineInfo;
+    }
+  }
+
   SymbolizableModule *Info;
   if (auto InfoOrErr = getOrCreateModuleInfo(ModuleName, DWPName))
     Info = InfoOrErr.get();
@@ -82,6 +105,29 @@ LLVMSymbolizer::symbolizeCode(const std::string &ModuleName,
 Expected<DIInliningInfo>
 LLVMSymbolizer::symbolizeInlinedCode(const std::string &ModuleName,
                                      uint64_t ModuleOffset, StringRef DWPName) {
+  if (!Opts.IndexDir.empty()) {
+    SymbolizableIndex *Index;
+    if (auto IndexOrErr = getOrCreateIndex(ModuleName, DWPName))
+      Index = IndexOrErr.get();
+    else
+      return IndexOrErr.takeError();
+
+    uint64_t Address = ModuleOffset;
+    if (Index && Opts.RelativeAddresses)
+      Address += Index->getModulePreferredBase();
+    if (Index && Index->contains(Address)) {
+      DIInliningInfo InlinedContext = Index->symbolizeInlinedCode(
+          Address, Opts.PrintFunctions, Opts.UseSymbolTable);
+      if (Opts.Demangle) {
+        for (int i = 0, n = InlinedContext.getNumberOfFrames(); i < n; i++) {
+          auto *Frame = InlinedContext.getMutableFrame(i);
+          Frame->FunctionName = DemangleName(Frame->FunctionName, Index);
+        }
+      }
+      return InlinedContext;
+    }
+  }
+
   SymbolizableModule *Info;
   if (auto InfoOrErr = getOrCreateModuleInfo(ModuleName, DWPName))
     Info = InfoOrErr.get();
@@ -139,6 +185,7 @@ void LLVMSymbolizer::flush() {
   BinaryForPath.clear();
   ObjectPairForPathArch.clear();
   Modules.clear();
+  Indexes.clear();
 }
 
 namespace {
@@ -245,6 +292,65 @@ bool darwinDsymMatchesBinary(const MachOObjectFile *DbgObj,
   return !memcmp(dbg_uuid.data(), bin_uuid.data(), dbg_uuid.size());
 }
 
+template <typename ELFT>
+ArrayRef<uint8_t> getBuildID(const ELFFile<ELFT> *Obj) {
+  auto PhdrsOrErr = Obj->program_headers();
+  if (!PhdrsOrErr) {
+    consumeError(PhdrsOrErr.takeError());
+    return {};
+  }
+  for (const auto &P : *PhdrsOrErr) {
+    if (P.p_type != ELF::PT_NOTE)
+      continue;
+    ArrayRef<uint8_t> BuildID;
+    Error Err = Error::success();
+    for (const auto &N : Obj->notes(P, Err)) {
+      if (N.getType() == ELF::NT_GNU_BUILD_ID && N.getName() == "GNU") {
+        // The descriptor is sized in bytes.
+        BuildID = makeArrayRef(
+            reinterpret_cast<const uint8_t *>(N.getDesc().data()),
+            N.getDesc().size());
+        break;
+      }
+    }
+    consumeError(std::move(Err));
+    if (!BuildID.empty())
+      return BuildID;
+  }
+  return {};
+}
+
+ArrayRef<uint8_t> getBuildID(const ObjectFile *Obj) {
+  if (auto *O = dyn_cast<ELF32LEObjectFile>(Obj))
+    return getBuildID(O->getELFFile());
+  if (auto *O = dyn_cast<ELF32BEObjectFile>(Obj))
+    return getBuildID(O->getELFFile());
+  if (auto *O = dyn_cast<ELF64LEObjectFile>(Obj))
+    return getBuildID(O->getELFFile());
+  if (auto *O = dyn_cast<ELF64BEObjectFile>(Obj))
+    return getBuildID(O->getELFFile());
+  if (auto *O = dyn_cast<MachOObjectFile>(Obj))
+    return O->getUuid();
+  return {};
+}
+
+// Splits "path:arch" into its parts if arch is a valid architecture name.
+void splitModuleName(const std::string &ModuleName,
+                     const std::string &DefaultArch, std::string &BinaryName,
+                     std::string &ArchName) {
+  BinaryName = ModuleName;
+  ArchName = DefaultArch;
+  size_t ColonPos = ModuleName.find_last_of(':');
+  // Verify that substring after colon form a valid arch name.
+  if (ColonPos != std::string::npos) {
+    std::string ArchStr = ModuleName.substr(ColonPos + 1);
+    if (Triple(ArchStr).getArch() != Triple::UnknownArch) {
+      BinaryName = ModuleName.substr(0, ColonPos);
+      ArchName = ArchStr;
+    }
+  }
+}
+
 } // end anonymous namespace
 
 ObjectFile *LLVMSymbolizer::lookUpDsymFile(const std::string &ExePath,
@@ -376,17 +482,8 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName,
   if (I != Modules.end()) {
     return I->second.get();
   }
-  std::string BinaryName = ModuleName;
-  std::string ArchName = Opts.DefaultArch;
-  size_t ColonPos = ModuleName.find_last_of(':');
-  // Verify that substring after colon form a valid arch name.
-  if (ColonPos != std::string::npos) {
-    std::string ArchStr = ModuleName.substr(ColonPos + 1);
-    if (Triple(ArchStr).getArch() != Triple::UnknownArch) {
-      BinaryName = ModuleName.substr(0, ColonPos);
-      ArchName = ArchStr;
-    }
-  }
+  std::string BinaryName, ArchName;
+  splitModuleName(ModuleName, Opts.DefaultArch, BinaryName, ArchName);
   auto ObjectsOrErr = getOrCreateObjectPair(BinaryName, ArchName);
   if (!ObjectsOrErr) {
     // Failed to find valid object file.
@@ -432,6 +529,83 @@ LLVMSymbolizer::getOrCreateModuleInfo(const std::string &ModuleName,
   return InsertResult.first->second.get();
 }
 
+Expected<SymbolizableIndex *>
+LLVMSymbolizer::getOrCreateIndex(const std::string &ModuleName,
+                                 StringRef DWPName) {
+  const auto &I = Indexes.find(ModuleName);
+  if (I != Indexes.end())
+    return static_cast<SymbolizableIndex *>(I->second.get());
+  std::unique_ptr<SymbolizableModule> &Index = Indexes[ModuleName];
+
+  std::string BinaryName, ArchName;
+  splitModuleName(ModuleName, Opts.DefaultArch, BinaryName, ArchName);
+  auto ObjectsOrErr = getOrCreateObjectPair(BinaryName, ArchName);
+  if (!ObjectsOrErr) {
+    // Failed to find valid object file. The error is only reported once, so
+    // do not let getOrCreateModuleInfo() try again.
+    Modules.insert(
+        std::make_pair(ModuleName, std::unique_ptr<SymbolizableModule>()));
+    return ObjectsOrErr.takeError();
+  }
+  ObjectPair Objects = ObjectsOrErr.get();
+  if (!Objects.first)
+    return nullptr;
+  ArrayRef<uint8_t> BuildID = getBuildID(Objects.first);
+  if (BuildID.empty())
+    return nullptr;
+
+  // Indexes built with a -dwp file are kept apart from those built without.
+  std::string IndexName = StringRef(toHex(BuildID)).lower();
+  if (!DWPName.empty())
+    IndexName += "-" + utohexstr(xxHash64(DWPName), /*LowerCase=*/true);
+  SmallString<128> Path(Opts.IndexDir);
+  sys::path::append(Path, IndexName + ".symidx");
+  auto IndexOrErr = SymbolizableIndex::load(Path, Opts.PrintFunctions,
+                                            Opts.UseSymbolTable, DWPName);
+  if (!IndexOrErr) {
+    consumeError(IndexOrErr.takeError());
+
+    // Build the index from the module. The index is only an optimization, so
+    // failing to write it is not an error.
+    SymbolizableModule *Info;
+    if (auto InfoOrErr = getOrCreateModuleInfo(ModuleName, DWPName))
+      Info = InfoOrErr.get();
+    else
+      return InfoOrErr.takeError();
+    if (!Info)
+      return nullptr;
+    std::unique_ptr<DWARFContext> DICtx =
+        DWARFContext::create(*Objects.second, nullptr,
+                             DWARFContext::defaultErrorHandler, DWPName);
+
+    // The debug info may come from a dSYM or .gnu_debuglink file, and from
+    // the DWP file DWARFContext looks for whether or not it exists.
+    std::vector<std::string> DebugFiles;
+    if (Objects.second != Objects.first)
+      DebugFiles.push_back(Objects.second->getFileName());
+    DebugFiles.push_back(DWPName.empty()
+                             ? (Objects.second->getFileName() + ".dwp").str()
+                             : DWPName.str());
+
+    // getOrCreateModuleInfo() only creates SymbolizableObjectFiles.
+    auto *ObjInfo = static_cast<SymbolizableObjectFile *>(Info);
+    if (sys::fs::create_directories(Opts.IndexDir) ||
+        errorToBool(SymbolizableIndex::write(
+            Path, *ObjInfo, *DICtx, DWPName, DebugFiles, Opts.PrintFunctions,
+            Opts.UseSymbolTable)))
+      return nullptr;
+
+    IndexOrErr = SymbolizableIndex::load(Path, Opts.PrintFunctions,
+                                         Opts.UseSymbolTable, DWPName);
+    if (!IndexOrErr) {
+      consumeError(IndexOrErr.takeError());
+      return nullptr;
+    }
+  }
+  Index = std::move(IndexOrErr.get());
+  return static_cast<SymbolizableIndex *>(Index.get());
+}
+
 namespace {
 
 // Undo these various manglings for Win32 extern "C" functions:
@@ -40,7 +40,10 @@ static cl::opt<bool> PrintVolatile("interpreter-print-volatile", cl::Hidden,
 //===----------------------------------------------------------------------===//
 
 static void SetValue(Value *V, GenericValue Val, ExecutionContext &SF) {
-  SF.Values[V] = Val;
+  unsigned Slot = SF.Info->getSlot(V);
+  if (Slot >= SF.Values.size())
+    SF.Values.resize(Slot + 1);
+  SF.Values[Slot] = Val;
 }
 
 //===----------------------------------------------------------------------===//
@@ -2054,15 +2057,39 @@ GenericValue Interpreter::getConstantExprValue (ConstantExpr *CE,
 }
 
 GenericValue Interpreter::getOperandValue(Value *V, ExecutionContext &SF) {
-  if (ConstantExpr *CE = dyn_cast<ConstantExpr>(V)) {
-    return getConstantExprValue(CE, SF);
-  } else if (Constant *CPV = dyn_cast<Constant>(V)) {
-    return getConstantValue(CPV);
-  } else if (GlobalValue *GV = dyn_cast<GlobalValue>(V)) {
-    return PTOGV(getPointerToGlobal(GV));
-  } else {
-    return SF.Values[V];
+  if (Constant *CPV = dyn_cast<Constant>(V)) {
+    // Constants, including the addresses of globals, are evaluated once per
+    // function.
+    auto I = SF.Info->Constants.find(CPV);
+    if (I != SF.Info->Constants.end())
+      return I->second;
+    GenericValue Val;
+    if (ConstantExpr *CE = dyn_cast<ConstantExpr>(CPV))
+      Val = getConstantExprValue(CE, SF);
+    else
+      Val = getConstantValue(CPV);
+    SF.Info->Constants[CPV] = Val;
+    return Val;
   }
+
+  unsigned Slot = SF.Info->getSlot(V);
+  return Slot < SF.Values.size() ? SF.Values[Slot] : GenericValue();
+}
+
+FunctionInfo::FunctionInfo(const Function &F) {
+  for (const Argument &A : F.args())
+    getSlot(&A);
+  for (const BasicBlock &BB : F)
+    for (const Instruction &I : BB)
+      if (!I.getType()->isVoidTy())
+        getSlot(&I);
+}
+
+FunctionInfo &Interpreter::getFunctionInfo(const Function *F) {
+  std::unique_ptr<FunctionInfo> &Info = FunctionInfos[F];
+  if (!Info)
+    Info = llvm::make_unique<FunctionInfo>(*F);
+  return *Info;
 }
 
 //===----------------------------------------------------------------------===//
@@ -2089,6 +2116,10 @@ void Interpreter::callFunction(Function *F, ArrayRef<GenericValue> ArgVals) {
     return;
   }
 
+  // Lay out the frame, computing the slots of the function on its first call.
+  StackFrame.Info = &getFunctionInfo(F);
+  StackFrame.Values.resize(StackFrame.Info->Slots.size());
+
   // Get pointers to first LLVM BB & Instruction in function.
   StackFrame.CurBB     = &F->front();
   StackFrame.CurInst   = StackFrame.CurBB->begin();
@@ -101,3 +101,10 @@ GenericValue Interpreter::runFunction(Function *F,
 
   return ExitValue;
 }
+
+bool Interpreter::removeModule(Module *M) {
+  if (!ExecutionEngine::removeModule(M))
+    return false;
+  FunctionInfos.clear();
+  return true;
+}
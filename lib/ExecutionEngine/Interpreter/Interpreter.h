@@ -14,12 +14,14 @@
 #ifndef LLVM_LIB_EXECUTIONENGINE_INTERPRETER_INTERPRETER_H
 #define LLVM_LIB_EXECUTIONENGINE_INTERPRETER_INTERPRETER_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/GenericValue.h"
 #include "llvm/IR/CallSite.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/InstVisitor.h"
+#include "llvm/IR/ValueMap.h"
 #include "llvm/Support/DataTypes.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
@@ -55,6 +57,34 @@ public:
 
 typedef std::vector<GenericValue> ValuePlaneTy;
 
+// InterpreterCacheConfig - The interpreter's caches are keyed by the values
+// they describe. An entry goes away when its key is deleted, so a value later
+// allocated at the same address does not pick it up, and it stays with its key
+// when the key is replaced.
+//
+struct InterpreterCacheConfig : ValueMapConfig<const Value *> {
+  enum { FollowRAUW = false };
+};
+
+// FunctionInfo - What the interpreter computes about a function the first time
+// it is called, shared by all the stack frames of the function: the slot in
+// ExecutionContext::Values of every value the function defines, and the value
+// of every constant it uses.
+//
+struct FunctionInfo {
+  DenseMap<const Value *, unsigned> Slots;
+  ValueMap<const Constant *, GenericValue, InterpreterCacheConfig> Constants;
+
+  explicit FunctionInfo(const Function &F);
+
+  // getSlot - Return the slot of V. Intrinsic calls are lowered while the
+  // function runs, so values it did not have when it was first called get a
+  // slot on demand.
+  unsigned getSlot(const Value *V) {
+    return Slots.insert(std::make_pair(V, Slots.size())).first->second;
+  }
+};
+
 // ExecutionContext struct - This struct represents one stack frame currently
 // executing.
 //
@@ -64,11 +94,14 @@ struct ExecutionContext {
   BasicBlock::iterator  CurInst;    // The next instruction to execute
   CallSite             Caller;     // Holds the call that called subframes.
                                    // NULL if main func or debugger invoked fn
-  std::map<Value *, GenericValue> Values; // LLVM values used in this invocation
+  FunctionInfo         *Info;      // Slots and constants of CurFunction
+  ValuePlaneTy          Values;    // LLVM values used in this invocation
   std::vector<GenericValue>  VarArgs; // Values passed through an ellipsis
   AllocaHolder Allocas;            // Track memory allocated by alloca
 
-  ExecutionContext() : CurFunction(nullptr), CurBB(nullptr), CurInst(nullptr) {}
+  ExecutionContext()
+      : CurFunction(nullptr), CurBB(nullptr), CurInst(nullptr),
+        Info(nullptr) {}
 };
 
 // Interpreter - This class represents the entirety of the interpreter.
@@ -81,6 +114,11 @@ class Interpreter : public ExecutionEngine, public InstVisitor<Interpreter> {
   // function record.
   std::vector<ExecutionContext> ECStack;
 
+  // FunctionInfos - The slots and constants of the functions called so far.
+  ValueMap<const Function *, std::unique_ptr<FunctionInfo>,
+           InterpreterCacheConfig>
+      FunctionInfos;
+
   // AtExitHandlers - List of functions to call when the program exits,
   // registered with the atexit() library function.
   std::vector<Function*> AtExitHandlers;
@@ -108,6 +146,11 @@ public:
   GenericValue runFunction(Function *F,
                            ArrayRef<GenericValue> ArgValues) override;
 
+  /// removeModule - Forget the cached function info as well: it holds the
+  /// addresses of globals, which may be defined by the removed module.
+  ///
+  bool removeModule(Module *M) override;
+
   void *getPointerToNamedFunction(StringRef Name,
                                   bool AbortOnFailure = true) override {
     // FIXME: not implemented.
@@ -200,6 +243,7 @@ private:  // Helper functions
   void initializeExternalFunctions();
   GenericValue getConstantExprValue(ConstantExpr *CE, ExecutionContext &SF);
   GenericValue getOperandValue(Value *V, ExecutionContext &SF);
+  FunctionInfo &getFunctionInfo(const Function *F);
   GenericValue executeTruncInst(Value *SrcVal, Type *DstTy,
                                 ExecutionContext &SF);
   GenericValue executeSExtInst(Value *SrcVal, Type *DstTy,
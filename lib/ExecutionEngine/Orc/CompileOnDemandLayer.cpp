@@ -10,6 +10,8 @@
 #include "llvm/ExecutionEngine/Orc/CompileOnDemandLayer.h"
 #include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/ExecutionEngine/Orc/Speculation.h"
+#include "llvm/IR/CallSite.h"
 #include "llvm/IR/Mangler.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Support/raw_ostream.h"
@@ -118,6 +120,38 @@ extractAndClone(Module &M, LLVMContext &NewContext, StringRef Suffix,
   return ClonedModule;
 }
 
+/// Collect the direct callees of each function defined in \p M that are
+/// themselves defined (and will be compiled lazily) in \p M, with the number of
+/// call sites to each.
+static std::map<const Function *, Speculator::CalleeList>
+collectCallees(Module &M, MangleAndInterner &Mangle) {
+  std::map<const Function *, Speculator::CalleeList> Result;
+  for (auto &F : M.functions()) {
+    if (F.isDeclaration() || F.hasAvailableExternallyLinkage())
+      continue;
+
+    std::map<const Function *, unsigned> CallSites;
+    for (auto &BB : F)
+      for (auto &I : BB) {
+        ImmutableCallSite CS(&I);
+        if (!CS)
+          continue;
+        auto *Callee = dyn_cast_or_null<Function>(
+            CS.getCalledValue()->stripPointerCasts());
+        if (Callee && !Callee->isDeclaration() &&
+            !Callee->hasAvailableExternallyLinkage())
+          ++CallSites[Callee];
+      }
+
+    auto &Callees = Result[&F];
+    for (auto &KV : CallSites)
+      Callees.push_back(
+          std::make_pair(Mangle((KV.first->getName() + "$body").str()),
+                         KV.second));
+  }
+  return Result;
+}
+
 static std::unique_ptr<Module> extractGlobals(Module &M,
                                               LLVMContext &NewContext) {
   return extractAndClone(M, NewContext, ".globals", [](const GlobalValue *GV) {
@@ -241,6 +275,15 @@ void CompileOnDemandLayer2::emit(MaterializationResponsibility R, VModuleKey K,
 
   auto GlobalsModule = extractGlobals(*M, GetAvailableContext());
 
+  // The call graph has to be read before the functions are replaced by stubs.
+  // The functions are registered with the speculator once their stubs exist.
+  std::map<const Function *, Speculator::CalleeList> Callees;
+  std::vector<
+      std::tuple<SymbolStringPtr, SymbolStringPtr, Speculator::CalleeList>>
+      SpeculatedFunctions;
+  if (Spec)
+    Callees = collectCallees(*M, Mangle);
+
   // Delete the bodies of any available externally functions, rename the
   // rest, and build the compile callbacks.
   std::map<SymbolStringPtr, std::pair<JITTargetAddress, JITSymbolFlags>>
@@ -268,14 +311,41 @@ void CompileOnDemandLayer2::emit(MaterializationResponsibility R, VModuleKey K,
 
     auto StubName = Mangle(StubUnmangledName);
     auto BodyName = Mangle(F.getName());
+    if (Spec)
+      SpeculatedFunctions.push_back(
+          std::make_tuple(BodyName, StubName, std::move(Callees[&F])));
     if (auto CallbackAddr = CCMgr.getCompileCallback(
-            [BodyName, &TargetVSO, &ES]() -> JITTargetAddress {
-              if (auto Sym = lookup({&TargetVSO}, BodyName))
-                return Sym->getAddress();
-              else {
+            [this, StubName, BodyName, &TargetVSO, &ES]() -> JITTargetAddress {
+              if (!Spec) {
+                if (auto Sym = lookup({&TargetVSO}, BodyName))
+                  return Sym->getAddress();
+                else {
+                  ES.reportError(Sym.takeError());
+                  return 0;
+                }
+              }
+
+              // If the body was compiled speculatively, the stub points at
+              // it already, and there is no need to wait for the compile
+              // mutex.
+              if (auto Addr = Spec->notifyCall(BodyName))
+                return Addr;
+
+              std::lock_guard<std::recursive_mutex> Lock(
+                  Spec->getCompileMutex());
+              auto Sym = lookup({&TargetVSO}, BodyName);
+              if (!Sym) {
                 ES.reportError(Sym.takeError());
                 return 0;
               }
+              Spec->notifyCompiledOnCall(BodyName);
+
+              // Later calls go straight to the body rather than back through
+              // this callback.
+              if (auto Err = getStubsManager(TargetVSO).updatePointer(
+                      *StubName, Sym->getAddress()))
+                ES.reportError(std::move(Err));
+              return Sym->getAddress();
             })) {
       auto Flags = JITSymbolFlags::fromGlobalValue(F);
       Flags &= ~JITSymbolFlags::Weak;
@@ -311,6 +381,11 @@ void CompileOnDemandLayer2::emit(MaterializationResponsibility R, VModuleKey K,
     return;
   }
 
+  for (auto &SF : SpeculatedFunctions)
+    Spec->addFunction(TargetVSO, std::move(std::get<0>(SF)),
+                      std::move(std::get<1>(SF)), StubsMgr,
+                      std::move(std::get<2>(SF)));
+
   // Resolve and finalize stubs.
   SymbolMap ResolvedStubs;
   for (auto &KV : StubCallbacksAndLinkages) {
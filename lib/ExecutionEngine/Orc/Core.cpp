@@ -158,6 +158,12 @@ void ExecutionSessionBase::legacyFailQuery(AsynchronousSymbolQuery &Q,
     reportError(std::move(Err));
 }
 
+#if LLVM_ENABLE_THREADS
+template <typename T> static bool isReady(const std::future<T> &F) {
+  return F.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+#endif
+
 Expected<SymbolMap> ExecutionSessionBase::legacyLookup(
     ExecutionSessionBase &ES, LegacyAsyncLookupFunction AsyncLookup,
     SymbolNameSet Names, bool WaitUntilReady,
@@ -251,6 +257,7 @@ Expected<SymbolMap> ExecutionSessionBase::legacyLookup(
 
 #if LLVM_ENABLE_THREADS
   auto ResultFuture = PromisedResult.get_future();
+  ES.waitUntil([&]() { return isReady(ResultFuture); });
   auto Result = ResultFuture.get();
 
   {
@@ -264,6 +271,7 @@ Expected<SymbolMap> ExecutionSessionBase::legacyLookup(
 
   if (WaitUntilReady) {
     auto ReadyFuture = PromisedReady.get_future();
+    ES.waitUntil([&]() { return isReady(ReadyFuture); });
     ReadyFuture.get();
 
     {
@@ -438,6 +446,7 @@ ExecutionSessionBase::lookup(const VSOList &VSOs, const SymbolNameSet &Symbols,
 
 #if LLVM_ENABLE_THREADS
   auto ResultFuture = PromisedResult.get_future();
+  waitUntil([&]() { return isReady(ResultFuture); });
   auto Result = ResultFuture.get();
 
   {
@@ -451,6 +460,7 @@ ExecutionSessionBase::lookup(const VSOList &VSOs, const SymbolNameSet &Symbols,
 
   if (WaitUntilReady) {
     auto ReadyFuture = PromisedReady.get_future();
+    waitUntil([&]() { return isReady(ReadyFuture); });
     ReadyFuture.get();
 
     {
@@ -11,6 +11,8 @@
 #include "llvm/ExecutionEngine/Orc/OrcError.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/IR/Mangler.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/Threading.h"
 
 namespace llvm {
 namespace orc {
@@ -22,6 +24,25 @@ LLJIT::Create(std::unique_ptr<ExecutionSession> ES,
       new LLJIT(std::move(ES), std::move(TM), std::move(DL)));
 }
 
+Expected<std::unique_ptr<LLJIT>>
+LLJIT::Create(std::unique_ptr<ExecutionSession> ES,
+              JITTargetMachineBuilder JTMB, DataLayout DL,
+              unsigned NumCompileThreads) {
+  if (NumCompileThreads == 0 || !llvm_is_multithreaded()) {
+    auto TM = JTMB.createTargetMachine();
+    if (!TM)
+      return TM.takeError();
+    return Create(std::move(ES), std::move(*TM), std::move(DL));
+  }
+
+  // Make sure a TargetMachine can be built before any compile needs one.
+  if (auto Err = JTMB.createTargetMachine().takeError())
+    return std::move(Err);
+
+  return std::unique_ptr<LLJIT>(new LLJIT(std::move(ES), std::move(JTMB),
+                                          std::move(DL), NumCompileThreads));
+}
+
 Error LLJIT::defineAbsolute(StringRef Name, JITEvaluatedSymbol Sym) {
   auto InternedName = ES->getSymbolStringPool().intern(Name);
   SymbolMap Symbols({{InternedName, Sym}});
@@ -34,12 +55,15 @@ Error LLJIT::addIRModule(VSO &V, std::unique_ptr<Module> M) {
   if (auto Err = applyDataLayout(*M))
     return Err;
 
+  recordCtorDtors(*M);
+
   auto K = ES->allocateVModule();
   return CompileLayer.add(V, K, std::move(M));
 }
 
 Expected<JITEvaluatedSymbol> LLJIT::lookupLinkerMangled(VSO &V,
                                                         StringRef Name) {
+  auto Lock = lockCompiles();
   return llvm::orc::lookup({&V}, ES->getSymbolStringPool().intern(Name));
 }
 
@@ -49,9 +73,105 @@ LLJIT::LLJIT(std::unique_ptr<ExecutionSession> ES,
       DL(std::move(DL)),
       ObjLinkingLayer(*this->ES,
                       [this](VModuleKey K) { return getMemoryManager(K); }),
-      CompileLayer(*this->ES, ObjLinkingLayer, SimpleCompiler(*this->TM)),
+      CompileLayer(*this->ES, ObjLinkingLayer,
+                   [this](Module &M)
+                       -> Expected<std::unique_ptr<MemoryBuffer>> {
+                     return SimpleCompiler(*this->TM, ObjCache)(M);
+                   }),
       CtorRunner(Main), DtorRunner(Main) {}
 
+/// Compile with a MultiThreadedSimpleCompiler, using whatever object cache is
+/// set when the compile starts.
+static IRCompileLayer2::CompileFunction
+makeCompileFunction(JITTargetMachineBuilder JTMB,
+                    ObjectCache *const &ObjCache) {
+  MultiThreadedSimpleCompiler Compiler(std::move(JTMB));
+  return [Compiler, &ObjCache](Module &M)
+             -> Expected<std::unique_ptr<MemoryBuffer>> {
+    // Copies share their pool of TargetMachines.
+    auto C = Compiler;
+    C.setObjectCache(ObjCache);
+    return C(M);
+  };
+}
+
+/// Whether the current thread is a compile thread of some LLJIT instance.
+static LLVM_THREAD_LOCAL bool IsCompileThread = false;
+
+LLJIT::LLJIT(std::unique_ptr<ExecutionSession> ES,
+             JITTargetMachineBuilder JTMB, DataLayout DL,
+             unsigned NumCompileThreads)
+    : ES(std::move(ES)), Main(this->ES->createVSO("main")),
+      DL(std::move(DL)),
+      ObjLinkingLayer(*this->ES,
+                      [this](VModuleKey K) { return getMemoryManager(K); }),
+      CompileLayer(*this->ES, ObjLinkingLayer,
+                   makeCompileFunction(std::move(JTMB), ObjCache)),
+      CtorRunner(Main), DtorRunner(Main),
+      CompileThreads(llvm::make_unique<ThreadPool>(NumCompileThreads)) {
+  this->ES->setDispatchMaterialization(
+      [this](VSO &V, std::unique_ptr<MaterializationUnit> MU) {
+        // A unit needed while a compile thread is materializing another one
+        // is materialized right away on that thread.
+        if (IsCompileThread) {
+          MU->doMaterialize(V);
+          return;
+        }
+
+        {
+          std::lock_guard<std::mutex> Lock(PendingMUsMutex);
+          PendingMUs.push_back(std::make_pair(&V, std::move(MU)));
+          PendingMUsChanged.notify_all();
+        }
+        CompileThreads->async([this]() { runPendingMaterialization(); });
+      });
+
+  // A thread materializing one unit may block in a lookup until another unit
+  // is materialized. If that unit is still queued, possibly behind the blocked
+  // thread itself, the thread runs it.
+  this->ES->setWaitForLookup([this](std::function<bool()> IsDone) {
+    waitForLookup(std::move(IsDone));
+  });
+}
+
+bool LLJIT::runPendingMaterialization() {
+  std::pair<VSO *, std::unique_ptr<MaterializationUnit>> VAndMU;
+  {
+    std::lock_guard<std::mutex> Lock(PendingMUsMutex);
+    if (PendingMUs.empty())
+      return false;
+    VAndMU = std::move(PendingMUs.front());
+    PendingMUs.pop_front();
+  }
+
+  bool WasCompileThread = IsCompileThread;
+  IsCompileThread = true;
+  VAndMU.second->doMaterialize(*VAndMU.first);
+  IsCompileThread = WasCompileThread;
+
+  // The symbols some lookup is waiting for may be ready now.
+  std::lock_guard<std::mutex> Lock(PendingMUsMutex);
+  PendingMUsChanged.notify_all();
+  return true;
+}
+
+void LLJIT::waitForLookup(std::function<bool()> IsDone) {
+  // Symbols are resolved before their unit looks up anything, so the thread
+  // blocking here may have resolved symbols other lookups are waiting for.
+  {
+    std::lock_guard<std::mutex> Lock(PendingMUsMutex);
+    PendingMUsChanged.notify_all();
+  }
+
+  while (!IsDone()) {
+    if (runPendingMaterialization())
+      continue;
+    std::unique_lock<std::mutex> Lock(PendingMUsMutex);
+    if (PendingMUs.empty() && !IsDone())
+      PendingMUsChanged.wait(Lock);
+  }
+}
+
 std::shared_ptr<RuntimeDyld::MemoryManager>
 LLJIT::getMemoryManager(VModuleKey K) {
   return llvm::make_unique<SectionMemoryManager>();
@@ -116,10 +236,21 @@ Error LLLazyJIT::addLazyIRModule(VSO &V, std::unique_ptr<Module> M) {
 
   recordCtorDtors(*M);
 
+  auto Lock = lockCompiles();
   auto K = ES->allocateVModule();
   return CODLayer.add(V, K, std::move(M));
 }
 
+void LLLazyJIT::enableSpeculation(unsigned Budget) {
+  assert(!Spec && "Speculation already enabled");
+  if (!llvm_is_multithreaded())
+    return;
+
+  SerializeCompiles = true;
+  Spec = llvm::make_unique<Speculator>(*ES, CompileMutex, Budget);
+  CODLayer.setSpeculator(Spec.get());
+}
+
 LLLazyJIT::LLLazyJIT(
     std::unique_ptr<ExecutionSession> ES, std::unique_ptr<TargetMachine> TM,
     DataLayout DL, LLVMContext &Ctx,
@@ -0,0 +1,201 @@
+//===- PersistentObjectCache.cpp - On-disk object cache for ORC -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/PersistentObjectCache.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+
+#if !defined(_MSC_VER) && !defined(__MINGW32__)
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+#define DEBUG_TYPE "orc"
+
+STATISTIC(NumCacheHits, "Number of objects loaded from the object cache");
+STATISTIC(NumCacheMisses, "Number of objects not found in the object cache");
+
+namespace llvm {
+namespace orc {
+
+/// Map the cache entry at \p Path, or return null if there is none.
+static std::unique_ptr<MemoryBuffer> loadEntry(StringRef Path) {
+  // Bump the access time, which the pruner uses to find unused entries.
+  int FD;
+  if (sys::fs::openFileForRead(Path, FD, sys::fs::OF_UpdateAtime))
+    return nullptr;
+
+  auto MBOrErr = MemoryBuffer::getOpenFile(FD, Path, /*FileSize*/ -1,
+                                           /*RequiresNullTerminator*/ false);
+  close(FD);
+  if (!MBOrErr)
+    return nullptr;
+  return std::move(*MBOrErr);
+}
+
+Expected<std::unique_ptr<PersistentObjectCache>>
+PersistentObjectCache::Create(StringRef CacheDir, const TargetMachine &TM,
+                              CachePruningPolicy Policy) {
+  if (auto EC = sys::fs::create_directories(CacheDir))
+    return errorCodeToError(EC);
+
+  // Failing to prune is not fatal; the cache just grows.
+  pruneCache(CacheDir, Policy);
+
+  std::string TargetKey;
+  {
+    raw_string_ostream OS(TargetKey);
+    OS << LLVM_VERSION_STRING << '\0' << TM.getTargetTriple().str() << '\0'
+       << TM.getTargetCPU() << '\0' << TM.getTargetFeatureString() << '\0'
+       << static_cast<int>(TM.getOptLevel()) << '\0'
+       << static_cast<int>(TM.getRelocationModel()) << '\0'
+       << static_cast<int>(TM.getCodeModel());
+  }
+
+  return std::unique_ptr<PersistentObjectCache>(
+      new PersistentObjectCache(CacheDir.str(), std::move(TargetKey)));
+}
+
+std::string PersistentObjectCache::getKey(const Module &M) const {
+  SmallVector<char, 0> Bitcode;
+  {
+    raw_svector_ostream OS(Bitcode);
+    WriteBitcodeToFile(M, OS);
+  }
+
+  SHA1 Hasher;
+  Hasher.update(TargetKey);
+  Hasher.update(ArrayRef<uint8_t>(
+      reinterpret_cast<const uint8_t *>(Bitcode.data()), Bitcode.size()));
+
+  return toHex(Hasher.final());
+}
+
+std::string PersistentObjectCache::getEntryPath(StringRef Key) const {
+  // This choice of file name allows the cache to be pruned (see pruneCache()
+  // in include/llvm/Support/CachePruning.h).
+  SmallString<128> Path;
+  sys::path::append(Path, CacheDir, "llvmcache-orc-" + Key);
+  return Path.str();
+}
+
+std::unique_ptr<MemoryBuffer>
+PersistentObjectCache::getObject(const Module *M) {
+  std::string Key = getKey(*M);
+  std::string Path = getEntryPath(Key);
+  if (auto Obj = loadEntry(Path)) {
+    ++NumCacheHits;
+    return Obj;
+  }
+
+  // Lock the entry, so that other processes wait for this one to compile the
+  // module rather than compiling it too. The lock files are deliberately not
+  // named like entries, so that the pruner leaves them alone.
+  SmallString<128> LockPath;
+  sys::path::append(LockPath, CacheDir, "orc-" + Key);
+  auto Lock = llvm::make_unique<LockFileManager>(LockPath);
+  switch (Lock->getState()) {
+  case LockFileManager::LFS_Owned:
+    // Another process may have stored the object before the lock was taken.
+    if (auto Obj = loadEntry(Path)) {
+      ++NumCacheHits;
+      return Obj;
+    }
+    break;
+  case LockFileManager::LFS_Shared:
+    // If the owner stored the object, use it. Otherwise (the owner died,
+    // failed or is too slow) compile without coordinating.
+    Lock->waitForUnlock();
+    if (auto Obj = loadEntry(Path)) {
+      ++NumCacheHits;
+      return Obj;
+    }
+    Lock.reset();
+    break;
+  case LockFileManager::LFS_Error:
+    // Locking does not work here; compile without coordinating.
+    Lock.reset();
+    break;
+  }
+
+  ++NumCacheMisses;
+  std::lock_guard<std::mutex> PendingLock(PendingMutex);
+  auto &Entry = Pending[M];
+  Entry.Path = std::move(Path);
+  Entry.Lock = std::move(Lock);
+  return nullptr;
+}
+
+void PersistentObjectCache::notifyObjectCompiled(const Module *M,
+                                                 MemoryBufferRef Obj) {
+  // Keep the entry, and so the lock, until the object has been stored.
+  PendingEntry Entry;
+  {
+    std::lock_guard<std::mutex> PendingLock(PendingMutex);
+    auto I = Pending.find(M);
+    if (I != Pending.end()) {
+      Entry = std::move(I->second);
+      Pending.erase(I);
+    }
+  }
+  if (Entry.Path.empty())
+    Entry.Path = getEntryPath(getKey(*M));
+
+  // Write to a temporary file and rename it into place, so that readers never
+  // see a partial entry. Caching is best effort: if the object cannot be
+  // stored, the module is simply compiled again next time.
+  SmallString<128> TempModel;
+  sys::path::append(TempModel, CacheDir, "ORC-%%%%%%.tmp.o");
+  auto Temp = sys::fs::TempFile::create(TempModel, sys::fs::owner_read |
+                                                       sys::fs::owner_write);
+  if (!Temp) {
+    consumeError(Temp.takeError());
+    return;
+  }
+
+  {
+    raw_fd_ostream OS(Temp->FD, /*shouldClose*/ false);
+    OS << Obj.getBuffer();
+    OS.flush();
+    if (OS.has_error()) {
+      OS.clear_error();
+      consumeError(Temp->discard());
+      return;
+    }
+  }
+
+  if (auto Err = Temp->keep(Entry.Path)) {
+    consumeError(std::move(Err));
+    consumeError(Temp->discard());
+  }
+}
+
+void PersistentObjectCache::notifyObjectCompileFailed(const Module *M) {
+  // Dropping the entry releases its lock.
+  PendingEntry Entry;
+  std::lock_guard<std::mutex> PendingLock(PendingMutex);
+  auto I = Pending.find(M);
+  if (I != Pending.end()) {
+    Entry = std::move(I->second);
+    Pending.erase(I);
+  }
+}
+
+} // end namespace orc
+} // end namespace llvm
@@ -29,10 +29,14 @@ public:
       MR.addDependenciesForAll(Deps);
     };
 
+    // Don't hold the session lock while blocked in the lookup: the units that
+    // provide the symbols may be materializing on other threads.
+    VSOList SearchOrder;
+    MR.getTargetVSO().withSearchOrderDo(
+        [&](const VSOList &VSOs) { SearchOrder = VSOs; });
+
     auto InternedResult =
-        MR.getTargetVSO().withSearchOrderDo([&](const VSOList &VSOs) {
-          return ES.lookup(VSOs, InternedSymbols, RegisterDependencies, false);
-        });
+        ES.lookup(SearchOrder, InternedSymbols, RegisterDependencies, false);
 
     if (!InternedResult)
       return InternedResult.takeError();
@@ -0,0 +1,169 @@
+//===-------- Speculation.cpp - Compile lazy functions ahead of time ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/Speculation.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Statistic.h"
+
+#define DEBUG_TYPE "orc"
+
+STATISTIC(NumFunctionsSpeculated, "Number of functions compiled speculatively");
+STATISTIC(NumSpeculationHits,
+          "Number of stubs patched before the function's first call");
+STATISTIC(NumSpeculationMisses,
+          "Number of functions compiled on their first call");
+
+namespace llvm {
+namespace orc {
+
+Speculator::Speculator(ExecutionSession &ES,
+                       std::recursive_mutex &CompileMutex, unsigned Budget)
+    : ES(ES), CompileMutex(CompileMutex), Budget(Budget),
+      Thread([this]() { run(); }) {}
+
+Speculator::~Speculator() {
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Stop = true;
+  }
+  CandidatesChanged.notify_one();
+  IdleChanged.notify_all();
+  Thread.join();
+}
+
+void Speculator::addFunction(VSO &V, SymbolStringPtr Body, SymbolStringPtr Stub,
+                             IndirectStubsManager &StubsMgr,
+                             CalleeList Callees) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  FunctionInfo &F = Functions[std::move(Body)];
+  F.V = &V;
+  F.Stub = std::move(Stub);
+  F.StubsMgr = &StubsMgr;
+  F.Callees = std::move(Callees);
+}
+
+void Speculator::addCandidates(const FunctionInfo &F) {
+  for (auto &KV : F.Callees)
+    if (!Called.count(KV.first) && !Speculated.count(KV.first) &&
+        KV.first != Compiling)
+      Candidates[KV.first] += KV.second;
+}
+
+JITTargetAddress Speculator::notifyCall(const SymbolStringPtr &Body) {
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    // The call may have entered the stub just before it was patched.
+    auto I = Speculated.find(Body);
+    if (I != Speculated.end()) {
+      Called.insert(Body);
+      return I->second;
+    }
+
+    if (!Called.insert(Body).second)
+      return 0;
+    Candidates.erase(Body);
+    auto F = Functions.find(Body);
+    if (F != Functions.end())
+      addCandidates(F->second);
+  }
+  CandidatesChanged.notify_one();
+  IdleChanged.notify_all();
+  return 0;
+}
+
+void Speculator::notifyCompiledOnCall(const SymbolStringPtr &Body) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  // A call that waited for a speculative compile of the body is no miss.
+  if (Speculated.count(Body) || !CompiledOnCall.insert(Body).second)
+    return;
+  ++NumMisses;
+  ++NumSpeculationMisses;
+}
+
+void Speculator::waitUntilIdle() {
+  std::unique_lock<std::mutex> Lock(Mutex);
+  IdleChanged.wait(Lock, [this]() { return Stop || isIdle(); });
+}
+
+void Speculator::run() {
+  while (true) {
+    SymbolStringPtr Body;
+    const FunctionInfo *F = nullptr;
+    {
+      std::unique_lock<std::mutex> Lock(Mutex);
+      CandidatesChanged.wait(Lock, [this]() {
+        return Stop || (Budget != 0 && !Candidates.empty());
+      });
+      if (Stop)
+        return;
+
+      auto Best = std::max_element(
+          Candidates.begin(), Candidates.end(),
+          [](const std::pair<const SymbolStringPtr, unsigned> &LHS,
+             const std::pair<const SymbolStringPtr, unsigned> &RHS) {
+            return LHS.second < RHS.second;
+          });
+      auto I = Functions.find(Best->first);
+      if (I != Functions.end()) {
+        Body = Compiling = Best->first;
+        F = &I->second;
+      }
+      Candidates.erase(Best);
+    }
+
+    if (F) {
+      std::lock_guard<std::recursive_mutex> CompileLock(CompileMutex);
+      compile(Body, *F);
+    }
+
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      Compiling = SymbolStringPtr();
+    }
+    IdleChanged.notify_all();
+  }
+}
+
+void Speculator::compile(const SymbolStringPtr &Body, const FunctionInfo &F) {
+  {
+    // The function may have been called, and compiled, while this thread
+    // waited for the compile mutex.
+    std::lock_guard<std::mutex> Lock(Mutex);
+    if (Stop || Called.count(Body))
+      return;
+    --Budget;
+  }
+
+  auto Sym = lookup({F.V}, Body);
+  if (!Sym) {
+    ES.reportError(Sym.takeError());
+    return;
+  }
+
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Speculated[Body] = Sym->getAddress();
+  ++NumSpeculated;
+  ++NumFunctionsSpeculated;
+  addCandidates(F);
+
+  // A call that reached the compile callback while this thread compiled waits
+  // for the compile mutex, and then patches the stub itself. Otherwise patch
+  // it now, so that the first call goes straight to the body.
+  if (Called.count(Body))
+    return;
+  if (auto Err = F.StubsMgr->updatePointer(*F.Stub, Sym->getAddress())) {
+    ES.reportError(std::move(Err));
+    return;
+  }
+  ++NumHits;
+  ++NumSpeculationHits;
+}
+
+} // end namespace orc
+} // end namespace llvm
@@ -0,0 +1,378 @@
+//===- SlabMemoryManager.cpp - Slab-based memory manager for RtDyld -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a memory manager that carves the sections of JITed
+// objects out of large, dual-mapped slabs.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/SlabMemoryManager.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/ExecutionEngine/RuntimeDyld.h"
+#include "llvm/Support/Errno.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Memory.h"
+#include "llvm/Support/Process.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+
+#ifdef LLVM_ON_UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace llvm {
+
+struct SlabAllocator::Slab {
+  SectionKind Kind;
+  uint8_t *Working = nullptr;
+  uint8_t *Target = nullptr;
+  size_t Size = 0;
+  // The free ranges, as offset -> size. Adjacent ranges are always merged.
+  std::map<size_t, size_t> Free;
+};
+
+#ifdef LLVM_ON_UNIX
+
+static Error errnoError(const Twine &What) {
+  int Errno = errno;
+  return make_error<StringError>(
+      What + ": " + sys::StrError(Errno),
+      std::error_code(Errno, std::generic_category()));
+}
+
+/// Create an anonymous shared memory object of \p Size bytes, returning its
+/// file descriptor or -1.
+static int createSharedMemory(size_t Size, bool UseHugePages) {
+  int FD = -1;
+#if defined(__linux__) && defined(SYS_memfd_create)
+  // MFD_CLOEXEC and MFD_HUGETLB, which older headers lack.
+  const unsigned CloseOnExec = 0x1U, HugeTLB = 0x4U;
+  FD = syscall(SYS_memfd_create, "llvm-jit",
+               CloseOnExec | (UseHugePages ? HugeTLB : 0));
+#else
+  if (UseHugePages)
+    return -1;
+  static std::atomic<unsigned> Counter(0);
+  std::string Name = "/llvm-jit-" +
+                     std::to_string(sys::Process::getProcessId()) + "-" +
+                     std::to_string(Counter++);
+  FD = shm_open(Name.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+  if (FD != -1)
+    shm_unlink(Name.c_str());
+#endif
+  if (FD == -1)
+    return -1;
+  if (ftruncate(FD, Size) != 0) {
+    close(FD);
+    return -1;
+  }
+  return FD;
+}
+
+static void adviseHugePages(void *Addr, size_t Size) {
+#ifdef MADV_HUGEPAGE
+  // Only a hint: failing just means normal pages are used.
+  madvise(Addr, Size, MADV_HUGEPAGE);
+#endif
+}
+
+/// Map \p Size bytes of memory for sections of kind \p Kind. Code and
+/// read-only data get a writable view and a view with their final permissions
+/// of the same memory; read-write data gets a single writable mapping.
+static Error mapSlab(SlabAllocator::SectionKind Kind, size_t Size,
+                     bool UseHugePages, void *Hint, uint8_t *&Working,
+                     uint8_t *&Target) {
+  if (Kind == SlabAllocator::SectionKind::RWData) {
+    void *Addr = ::mmap(Hint, Size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (Addr == MAP_FAILED)
+      return errnoError("Cannot map JIT data slab");
+    if (UseHugePages)
+      adviseHugePages(Addr, Size);
+    Working = Target = static_cast<uint8_t *>(Addr);
+    return Error::success();
+  }
+
+  int TargetProt = PROT_READ;
+  if (Kind == SlabAllocator::SectionKind::Code)
+    TargetProt |= PROT_EXEC;
+
+  // Prefer explicit huge pages, falling back to transparent ones. Creating a
+  // hugetlb object succeeds even when no huge pages are reserved; it is
+  // mapping it that fails.
+  for (bool HugeTLB : {true, false}) {
+    if (HugeTLB && !UseHugePages)
+      continue;
+    int FD = createSharedMemory(Size, HugeTLB);
+    if (FD == -1) {
+      if (HugeTLB)
+        continue;
+      return errnoError("Cannot create JIT code slab");
+    }
+
+    void *W = ::mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_SHARED, FD, 0);
+    void *T = W == MAP_FAILED
+                  ? MAP_FAILED
+                  : ::mmap(Hint, Size, TargetProt, MAP_SHARED, FD, 0);
+    if (T == MAP_FAILED) {
+      auto Err = errnoError("Cannot map JIT code slab");
+      if (W != MAP_FAILED)
+        ::munmap(W, Size);
+      close(FD);
+      if (HugeTLB) {
+        consumeError(std::move(Err));
+        continue;
+      }
+      return Err;
+    }
+    close(FD);
+
+    if (UseHugePages && !HugeTLB) {
+      adviseHugePages(W, Size);
+      adviseHugePages(T, Size);
+    }
+    Working = static_cast<uint8_t *>(W);
+    Target = static_cast<uint8_t *>(T);
+    return Error::success();
+  }
+  llvm_unreachable("Normal pages always get a result");
+}
+
+static void unmapSlab(uint8_t *Working, uint8_t *Target, size_t Size) {
+  ::munmap(Target, Size);
+  if (Working != Target)
+    ::munmap(Working, Size);
+}
+
+#endif // LLVM_ON_UNIX
+
+SlabAllocator::SlabAllocator(size_t SlabSize, bool UseHugePages)
+    : SlabSize(SlabSize), UseHugePages(UseHugePages),
+      PageSize(sys::Process::getPageSize()) {}
+
+Expected<std::shared_ptr<SlabAllocator>>
+SlabAllocator::Create(size_t SlabSize, bool UseHugePages) {
+#ifdef LLVM_ON_UNIX
+  std::shared_ptr<SlabAllocator> A(new SlabAllocator(SlabSize, UseHugePages));
+  // Make sure the host can dual-map memory before anything relies on it.
+  if (auto S = A->createSlab(SectionKind::Code, SlabSize))
+    return std::move(A);
+  else
+    return S.takeError();
+#else
+  return make_error<StringError>(
+      "Dual-mapped JIT memory is not supported on this host",
+      inconvertibleErrorCode());
+#endif
+}
+
+SlabAllocator::~SlabAllocator() {
+#ifdef LLVM_ON_UNIX
+  for (auto &S : Slabs) {
+    assert(S->Free.size() == 1 && S->Free.begin()->second == S->Size &&
+           "Slab still has allocations");
+    unmapSlab(S->Working, S->Target, S->Size);
+  }
+#endif
+}
+
+Expected<SlabAllocator::Slab *> SlabAllocator::createSlab(SectionKind Kind,
+                                                         size_t MinSize) {
+#ifdef LLVM_ON_UNIX
+  // Huge pages are 2MB on the common hosts; a multiple of that also suits any
+  // other page size.
+  size_t Granularity = UseHugePages ? std::max<size_t>(PageSize, 2 << 20)
+                                    : PageSize;
+  size_t Size = alignTo(std::max(MinSize, SlabSize), Granularity);
+
+  // Keep the slabs close together, as code may refer to data PC-relatively.
+  void *Hint = nullptr;
+  if (!Slabs.empty())
+    Hint = Slabs.back()->Target + Slabs.back()->Size;
+
+  auto S = llvm::make_unique<Slab>();
+  S->Kind = Kind;
+  S->Size = Size;
+  if (auto Err =
+          mapSlab(Kind, Size, UseHugePages, Hint, S->Working, S->Target))
+    return std::move(Err);
+  S->Free[0] = Size;
+  Slabs.push_back(std::move(S));
+  return Slabs.back().get();
+#else
+  llvm_unreachable("SlabAllocator cannot be created on this host");
+#endif
+}
+
+/// Try to carve \p Size bytes, aligned to \p Alignment at their target
+/// address, out of the free ranges \p Free of the slab at \p Target.
+static bool allocateFromSlab(std::map<size_t, size_t> &Free, uint8_t *Target,
+                             size_t Size, size_t Alignment, size_t &Offset) {
+  for (auto I = Free.begin(), E = Free.end(); I != E; ++I) {
+    size_t Start = I->first, End = I->first + I->second;
+    size_t Aligned = alignAddr(Target + Start, Alignment) -
+                     reinterpret_cast<uintptr_t>(Target);
+    if (Aligned + Size > End)
+      continue;
+
+    Free.erase(I);
+    if (Aligned != Start)
+      Free[Start] = Aligned - Start;
+    if (Aligned + Size != End)
+      Free[Aligned + Size] = End - (Aligned + Size);
+    Offset = Aligned;
+    return true;
+  }
+  return false;
+}
+
+Expected<SlabAllocator::Allocation>
+SlabAllocator::allocate(SectionKind Kind, size_t Size, unsigned Alignment) {
+  if (!Alignment)
+    Alignment = 16;
+  assert(isPowerOf2_32(Alignment) && "Alignment must be a power of two.");
+
+  // Keep every block 16-byte aligned, and never hand out empty ones.
+  Size = alignTo(std::max<size_t>(Size, 1), 16);
+
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Slab *S = nullptr;
+  size_t Offset;
+  for (auto &Candidate : Slabs)
+    if (Candidate->Kind == Kind &&
+        allocateFromSlab(Candidate->Free, Candidate->Target, Size, Alignment,
+                         Offset)) {
+      S = Candidate.get();
+      break;
+    }
+
+  if (!S) {
+    auto NewSlab = createSlab(Kind, Size + Alignment);
+    if (!NewSlab)
+      return NewSlab.takeError();
+    S = *NewSlab;
+    bool Allocated =
+        allocateFromSlab(S->Free, S->Target, Size, Alignment, Offset);
+    (void)Allocated;
+    assert(Allocated && "New slab is too small");
+  }
+
+  Allocation A;
+  A.WorkingAddr = S->Working + Offset;
+  A.TargetAddr = S->Target + Offset;
+  A.Size = Size;
+  A.Kind = Kind;
+  return A;
+}
+
+void SlabAllocator::deallocate(const Allocation &A) {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  auto I = std::find_if(Slabs.begin(), Slabs.end(),
+                        [&](const std::unique_ptr<Slab> &S) {
+                          return S->Target <= A.TargetAddr &&
+                                 A.TargetAddr < S->Target + S->Size;
+                        });
+  assert(I != Slabs.end() && "Allocation is not from this allocator");
+  auto &Free = (*I)->Free;
+
+  size_t Start = A.TargetAddr - (*I)->Target, Size = A.Size;
+  auto Next = Free.lower_bound(Start);
+  if (Next != Free.end() && Start + Size == Next->first) {
+    Size += Next->second;
+    Next = Free.erase(Next);
+  }
+  if (Next != Free.begin()) {
+    auto Prev = std::prev(Next);
+    if (Prev->first + Prev->second == Start) {
+      Prev->second += Size;
+      return;
+    }
+  }
+  Free[Start] = Size;
+}
+
+SlabMemoryManager::SlabMemoryManager(std::shared_ptr<SlabAllocator> Allocator)
+    : Allocator(std::move(Allocator)) {}
+
+SlabMemoryManager::~SlabMemoryManager() {
+  // The frames live in the memory about to be released.
+  deregisterEHFrames();
+  for (auto &A : Allocations)
+    Allocator->deallocate(A);
+}
+
+uint8_t *SlabMemoryManager::allocateCodeSection(uintptr_t Size,
+                                                unsigned Alignment,
+                                                unsigned SectionID,
+                                                StringRef SectionName) {
+  return allocateSection(SlabAllocator::SectionKind::Code, Size, Alignment);
+}
+
+uint8_t *SlabMemoryManager::allocateDataSection(uintptr_t Size,
+                                                unsigned Alignment,
+                                                unsigned SectionID,
+                                                StringRef SectionName,
+                                                bool IsReadOnly) {
+  return allocateSection(IsReadOnly ? SlabAllocator::SectionKind::ROData
+                                    : SlabAllocator::SectionKind::RWData,
+                         Size, Alignment);
+}
+
+uint8_t *SlabMemoryManager::allocateSection(SlabAllocator::SectionKind Kind,
+                                            uintptr_t Size,
+                                            unsigned Alignment) {
+  auto A = Allocator->allocate(Kind, Size, Alignment);
+  if (!A) {
+    // RuntimeDyld reports the failure.
+    consumeError(A.takeError());
+    return nullptr;
+  }
+  Allocations.push_back(*A);
+  return A->WorkingAddr;
+}
+
+void SlabMemoryManager::notifyObjectLoaded(RuntimeDyld &RTDyld,
+                                           const object::ObjectFile &Obj) {
+  for (size_t I = NumMapped, E = Allocations.size(); I != E; ++I) {
+    auto &A = Allocations[I];
+    if (A.WorkingAddr != A.TargetAddr)
+      RTDyld.mapSectionAddress(
+          A.WorkingAddr,
+          static_cast<uint64_t>(reinterpret_cast<uintptr_t>(A.TargetAddr)));
+  }
+  NumMapped = Allocations.size();
+}
+
+void SlabMemoryManager::registerEHFrames(uint8_t *Addr, uint64_t LoadAddr,
+                                         size_t Size) {
+  // Addr is the working view of the frames. The unwinder needs them at the
+  // address their PC-relative fields were resolved against.
+  RTDyldMemoryManager::registerEHFrames(
+      reinterpret_cast<uint8_t *>(static_cast<uintptr_t>(LoadAddr)), LoadAddr,
+      Size);
+}
+
+bool SlabMemoryManager::finalizeMemory(std::string *ErrMsg) {
+  // The code is already executable at its target address; it only needs to
+  // become visible to instruction fetch.
+  for (size_t I = NumFinalized, E = Allocations.size(); I != E; ++I)
+    if (Allocations[I].Kind == SlabAllocator::SectionKind::Code)
+      sys::Memory::InvalidateInstructionCache(Allocations[I].TargetAddr,
+                                              Allocations[I].Size);
+  NumFinalized = Allocations.size();
+  return false;
+}
+
+} // end namespace llvm
@@ -32,6 +32,7 @@
 #include "llvm/MC/MCSymbol.h"
 #include "llvm/MC/MCValue.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/LEB128.h"
@@ -68,6 +69,8 @@ STATISTIC(FragmentLayouts, "Number of fragment layouts");
 STATISTIC(ObjectBytes, "Number of emitted object file bytes");
 STATISTIC(RelaxationSteps, "Number of assembler layout and relaxation steps");
 STATISTIC(RelaxedInstructions, "Number of relaxed instructions");
+STATISTIC(SkippedRelaxationChecks,
+          "Number of relaxable fragments not re-checked during layout");
 STATISTIC(PaddingFragmentsRelaxations,
           "Number of Padding Fragments relaxations");
 STATISTIC(PaddingFragmentsBytes,
@@ -76,6 +79,11 @@ STATISTIC(PaddingFragmentsBytes,
 } // end namespace stats
 } // end anonymous namespace
 
+static cl::opt<bool> IncrementalRelaxation(
+    "mc-incremental-relaxation", cl::init(true), cl::Hidden,
+    cl::desc("Only re-check relaxable fragments whose fixups span a "
+             "fragment that changed size in the previous layout pass"));
+
 // FIXME FIXME FIXME: There are number of places in this file where we convert
 // what is a 64-bit assembler value used for computation into a value in the
 // object file, which may truncate it. We should detect that truncation where
@@ -111,6 +119,7 @@ void MCAssembler::reset() {
   ELFHeaderEFlags = 0;
   LOHContainer.reset();
   VersionInfo.Major = 0;
+  RelaxStates.clear();
 
   // reset objects owned by us
   if (getBackendPtr())
@@ -775,9 +784,11 @@ void MCAssembler::layout(MCAsmLayout &Layout) {
   }
 
   // Layout until everything fits.
+  RelaxStates.clear();
   while (layoutOnce(Layout))
     if (getContext().hadError())
       return;
+  RelaxStates.clear();
 
   DEBUG_WITH_TYPE("mc-dump", {
       errs() << "assembler backend - post-relaxation\n--\n";
@@ -881,6 +892,54 @@ bool MCAssembler::fragmentNeedsRelaxation(const MCRelaxableFragment *F,
   return false;
 }
 
+bool MCAssembler::needsRelaxationCheck(const MCRelaxableFragment &F,
+                                       const SectionRelaxState &State) const {
+  if (!State.Visited || isBundlingEnabled())
+    return true;
+
+  // A PC-relative fixup against a label in the same section only depends on
+  // the sizes of the fragments between the fixup and the label. If none of
+  // them changed, the result of the last check still holds.
+  unsigned Lo = F.getLayoutOrder(), Hi = F.getLayoutOrder();
+  for (const MCFixup &Fixup : F.getFixups()) {
+    const MCFixupKindInfo &Info = getBackend().getFixupKindInfo(Fixup.getKind());
+    if (!(Info.Flags & MCFixupKindInfo::FKF_IsPCRel) ||
+        (Info.Flags & MCFixupKindInfo::FKF_IsAlignedDownTo32Bits))
+      return true;
+    // Targets typically fold an addend into the fixup value (X86 branches
+    // are "sym + -1" or "sym + -4"), which doesn't depend on the layout.
+    // Anything other than a plain symbol plus a constant may.
+    MCValue Target;
+    if (!Fixup.getValue()->evaluateAsRelocatable(Target, nullptr, &Fixup) ||
+        !Target.getSymA() || Target.getSymB() || Target.getRefKind() ||
+        Target.getSymA()->getKind() != MCSymbolRefExpr::VK_None)
+      return true;
+    const MCSymbol &Sym = Target.getSymA()->getSymbol();
+    if (Sym.isVariable() || !Sym.isInSection())
+      return true;
+    const MCFragment *SymFrag = Sym.getFragment();
+    if (SymFrag->getParent() != F.getParent())
+      return true;
+    Lo = std::min(Lo, SymFrag->getLayoutOrder());
+    Hi = std::max(Hi, SymFrag->getLayoutOrder());
+  }
+
+  // Org and non-constant fill fragments can change size without being
+  // relaxed, so be conservative when one lies in the range.
+  if (State.NumLayoutDependent[Hi + 1] != State.NumLayoutDependent[Lo])
+    return true;
+
+  const auto &Changed = State.ChangedFragments;
+  if (Changed.empty())
+    return false;
+  // Alignment and padding fragments in the range change size when anything
+  // before them does.
+  if (State.NumOffsetDependent[Hi + 1] != State.NumOffsetDependent[Lo])
+    return Changed.front() <= Hi;
+  auto I = std::lower_bound(Changed.begin(), Changed.end(), Lo);
+  return I != Changed.end() && *I <= Hi;
+}
+
 bool MCAssembler::relaxInstruction(MCAsmLayout &Layout,
                                    MCRelaxableFragment &F) {
   assert(getEmitterPtr() &&
@@ -1024,6 +1083,36 @@ bool MCAssembler::relaxCVDefRange(MCAsmLayout &Layout,
 }
 
 bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
+  SectionRelaxState &State = RelaxStates[&Sec];
+  if (!State.Visited) {
+    // Count the fragments whose size can change without being relaxed.
+    State.NumOffsetDependent.push_back(0);
+    State.NumLayoutDependent.push_back(0);
+    for (const MCFragment &F : Sec) {
+      bool OffsetDependent = false, LayoutDependent = false;
+      switch (F.getKind()) {
+      default:
+        break;
+      case MCFragment::FT_Align:
+      case MCFragment::FT_Padding:
+        OffsetDependent = true;
+        break;
+      case MCFragment::FT_Org:
+        LayoutDependent = true;
+        break;
+      case MCFragment::FT_Fill:
+        LayoutDependent =
+            !isa<MCConstantExpr>(cast<MCFillFragment>(F).getNumValues());
+        break;
+      }
+      State.NumOffsetDependent.push_back(State.NumOffsetDependent.back() +
+                                         OffsetDependent);
+      State.NumLayoutDependent.push_back(State.NumLayoutDependent.back() +
+                                         LayoutDependent);
+    }
+  }
+  SmallVector<unsigned, 16> ChangedFragments;
+
   // Holds the first fragment which needed relaxing during this layout. It will
   // remain NULL if none were relaxed.
   // When a fragment is relaxed, all the fragments following it should get
@@ -1040,6 +1129,11 @@ bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
     case MCFragment::FT_Relaxable:
       assert(!getRelaxAll() &&
              "Did not expect a MCRelaxableFragment in RelaxAll mode");
+      if (IncrementalRelaxation &&
+          !needsRelaxationCheck(*cast<MCRelaxableFragment>(I), State)) {
+        ++stats::SkippedRelaxationChecks;
+        break;
+      }
       RelaxedFrag = relaxInstruction(Layout, *cast<MCRelaxableFragment>(I));
       break;
     case MCFragment::FT_Dwarf:
@@ -1065,9 +1159,14 @@ bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
       RelaxedFrag = relaxCVDefRange(Layout, *cast<MCCVDefRangeFragment>(I));
       break;
     }
-    if (RelaxedFrag && !FirstRelaxedFragment)
-      FirstRelaxedFragment = &*I;
+    if (RelaxedFrag) {
+      if (!FirstRelaxedFragment)
+        FirstRelaxedFragment = &*I;
+      ChangedFragments.push_back(I->getLayoutOrder());
+    }
   }
+  State.Visited = true;
+  State.ChangedFragments = std::move(ChangedFragments);
   if (FirstRelaxedFragment) {
     Layout.invalidateFragmentsFrom(FirstRelaxedFragment);
     return true;
@@ -15,17 +15,21 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/BinaryFormat/Magic.h"
+#include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/Object/Archive.h"
+#include "llvm/Object/IRObjectFile.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Object/SymbolicFile.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileOutputBuffer.h"
 #include "llvm/Support/Format.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/Path.h"
-#include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
 #include <unistd.h>
@@ -372,8 +376,28 @@ static void writeSymbolTable(raw_ostream &Out, object::Archive::Kind Kind,
 static Expected<std::vector<unsigned>>
 getSymbols(MemoryBufferRef Buf, raw_ostream &SymNames, bool &HasObject) {
   std::vector<unsigned> Ret;
-  LLVMContext Context;
 
+  // Bitcode files usually carry a symbol table (see IRSymtab.h), which can be
+  // read without loading the modules. If the file has none, or an outdated
+  // one, readIRSymtab builds it from the modules. If that fails, for example
+  // because a module has no target triple, fall back to IRObjectFile below.
+  if (identify_magic(Buf.getBuffer()) == file_magic::bitcode) {
+    Expected<object::IRSymtabFile> SymtabOrErr = object::readIRSymtab(Buf);
+    if (SymtabOrErr) {
+      HasObject = true;
+      for (const irsymtab::Reader::SymbolRef &S :
+           SymtabOrErr->TheReader.symbols()) {
+        if (S.isFormatSpecific() || !S.isGlobal() || S.isUndefined())
+          continue;
+        Ret.push_back(SymNames.tell());
+        SymNames << S.getName() << '\0';
+      }
+      return Ret;
+    }
+    consumeError(SymtabOrErr.takeError());
+  }
+
+  LLVMContext Context;
   Expected<std::unique_ptr<object::SymbolicFile>> ObjOrErr =
       object::SymbolicFile::createSymbolicFile(Buf, llvm::file_magic::unknown,
                                                &Context);
@@ -406,9 +430,36 @@ computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
   // symbol table is aligned to be a multiple of 8 bytes
   uint64_t Pos = 0;
 
+  // Reading the symbols of a member, which may mean parsing a bitcode module,
+  // is by far the most expensive part of writing an archive. Do it for all
+  // members in parallel: each member writes its symbol names to a buffer of
+  // its own, and the buffers are concatenated in member order below.
+  struct MemberSymbols {
+    Expected<std::vector<unsigned>> Offsets = std::vector<unsigned>();
+    std::string Names;
+    bool HasObject = false;
+  };
+  size_t NumMembers = NewMembers.size();
+  std::vector<MemberSymbols> Symbols(NumMembers);
+  parallel::for_each_n(parallel::par, size_t(0), NumMembers, [&](size_t I) {
+    MemberSymbols &S = Symbols[I];
+    raw_string_ostream Names(S.Names);
+    // The default value is never an error, so it can be replaced unchecked.
+    consumeError(S.Offsets.takeError());
+    S.Offsets =
+        getSymbols(NewMembers[I].Buf->getMemBufferRef(), Names, S.HasObject);
+  });
+
+  Error Err = Error::success();
+  for (MemberSymbols &S : Symbols)
+    Err = joinErrors(std::move(Err), S.Offsets.takeError());
+  if (Err)
+    return std::move(Err);
+
   std::vector<MemberData> Ret;
   bool HasObject = false;
-  for (const NewArchiveMember &M : NewMembers) {
+  for (size_t I = 0; I != NumMembers; ++I) {
+    const NewArchiveMember &M = NewMembers[I];
     std::string Header;
     raw_string_ostream Out(Header);
 
@@ -429,13 +480,15 @@ computeMemberData(raw_ostream &StringTable, raw_ostream &SymNames,
                       Buf.getBufferSize() + MemberPadding);
     Out.flush();
 
-    Expected<std::vector<unsigned>> Symbols =
-        getSymbols(Buf, SymNames, HasObject);
-    if (auto E = Symbols.takeError())
-      return std::move(E);
+    MemberSymbols &S = Symbols[I];
+    HasObject |= S.HasObject;
+    uint64_t NamesPos = SymNames.tell();
+    for (unsigned &Offset : *S.Offsets)
+      Offset += NamesPos;
+    SymNames << S.Names;
 
     Pos += Header.size() + Data.size() + Padding.size();
-    Ret.push_back({std::move(*Symbols), std::move(Header), Data, Padding});
+    Ret.push_back({std::move(*S.Offsets), std::move(Header), Data, Padding});
   }
   // If there are no symbols, emit an empty symbol table, to satisfy Solaris
   // tools, older versions of which expect a symbol table in a non-empty
@@ -498,12 +551,10 @@ Error llvm::writeArchive(StringRef ArcName,
       Kind = object::Archive::K_GNU64;
   }
 
-  Expected<sys::fs::TempFile> Temp =
-      sys::fs::TempFile::create(ArcName + ".temp-archive-%%%%%%%.a");
-  if (!Temp)
-    return Temp.takeError();
-
-  raw_fd_ostream Out(Temp->FD, false);
+  // The magic and the symbol table are small; format them in memory. The
+  // symbol table uses the stream position as the offset in the archive.
+  SmallString<0> PrefixBuf;
+  raw_svector_ostream Out(PrefixBuf);
   if (Thin)
     Out << "!<thin>\n";
   else
@@ -512,10 +563,30 @@ Error llvm::writeArchive(StringRef ArcName,
   if (WriteSymtab)
     writeSymbolTable(Out, Kind, Deterministic, Data, SymNamesBuf);
 
-  for (const MemberData &M : Data)
-    Out << M.Header << M.Data << M.Padding;
+  // Copy the members straight from their buffers to the output file, in
+  // parallel.
+  std::vector<uint64_t> MemberOffsets;
+  MemberOffsets.reserve(Data.size());
+  uint64_t Size = PrefixBuf.size();
+  for (const MemberData &M : Data) {
+    MemberOffsets.push_back(Size);
+    Size += M.Header.size() + M.Data.size() + M.Padding.size();
+  }
 
-  Out.flush();
+  Expected<std::unique_ptr<FileOutputBuffer>> BufferOrErr =
+      FileOutputBuffer::create(ArcName, Size);
+  if (!BufferOrErr)
+    return BufferOrErr.takeError();
+  std::unique_ptr<FileOutputBuffer> &Buffer = *BufferOrErr;
+
+  uint8_t *BufferStart = Buffer->getBufferStart();
+  std::copy(PrefixBuf.begin(), PrefixBuf.end(), BufferStart);
+  parallel::for_each_n(parallel::par, size_t(0), Data.size(), [&](size_t I) {
+    const MemberData &M = Data[I];
+    uint8_t *Ptr = BufferStart + MemberOffsets[I];
+    for (StringRef Part : {StringRef(M.Header), M.Data, M.Padding})
+      Ptr = std::copy(Part.begin(), Part.end(), Ptr);
+  });
 
   // At this point, we no longer need whatever backing memory
   // was used to generate the NewMembers. On Windows, this buffer
@@ -529,5 +600,5 @@ Error llvm::writeArchive(StringRef ArcName,
   // closed before we attempt to rename.
   OldArchiveBuf.reset();
 
-  return Temp->keep(ArcName);
+  return Buffer->commit();
 }
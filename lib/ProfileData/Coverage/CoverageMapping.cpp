@@ -28,6 +28,8 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cassert>
@@ -35,6 +37,7 @@
 #include <iterator>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <system_error>
 #include <utility>
@@ -195,10 +198,10 @@ void FunctionRecordIterator::skipOtherFiles() {
     *this = FunctionRecordIterator();
 }
 
-Error CoverageMapping::loadFunctionRecord(
-    const CoverageMappingRecord &Record,
-    IndexedInstrProfReader &ProfileReader) {
-  StringRef OrigFuncName = Record.FunctionName;
+Expected<bool>
+CoverageMapping::addRecordProvenance(const CoverageMappingRecord &Record,
+                                     StringRef &OrigFuncName) {
+  OrigFuncName = Record.FunctionName;
   if (OrigFuncName.empty())
     return make_error<CoverageMapError>(coveragemap_error::malformed);
 
@@ -207,10 +210,22 @@ Error CoverageMapping::loadFunctionRecord(
   else
     OrigFuncName = getFuncNameWithoutPrefix(OrigFuncName, Record.Filenames[0]);
 
-  // Don't load records for (filenames, function) pairs we've already seen.
   auto FilenamesHash = hash_combine_range(Record.Filenames.begin(),
                                           Record.Filenames.end());
-  if (!RecordProvenance[FilenamesHash].insert(hash_value(OrigFuncName)).second)
+  return RecordProvenance[FilenamesHash]
+      .insert(hash_value(OrigFuncName))
+      .second;
+}
+
+Error CoverageMapping::loadFunctionRecord(
+    const CoverageMappingRecord &Record,
+    IndexedInstrProfReader &ProfileReader) {
+  // Don't load records for (filenames, function) pairs we've already seen.
+  StringRef OrigFuncName;
+  Expected<bool> IsNew = addRecordProvenance(Record, OrigFuncName);
+  if (!IsNew)
+    return IsNew.takeError();
+  if (!*IsNew)
     return Error::success();
 
   CounterMappingContext Ctx(Record.Expressions);
@@ -249,6 +264,28 @@ Error CoverageMapping::loadFunctionRecord(
   return Error::success();
 }
 
+Error CoverageMapping::checkSkippedFunctionRecord(
+    const CoverageMappingRecord &Record,
+    IndexedInstrProfReader &ProfileReader) {
+  StringRef OrigFuncName;
+  Expected<bool> IsNew = addRecordProvenance(Record, OrigFuncName);
+  if (!IsNew)
+    return IsNew.takeError();
+  if (!*IsNew)
+    return Error::success();
+
+  std::vector<uint64_t> Counts;
+  if (Error E = ProfileReader.getFunctionCounts(Record.FunctionName,
+                                                Record.FunctionHash, Counts)) {
+    instrprof_error IPE = InstrProfError::take(std::move(E));
+    if (IPE == instrprof_error::hash_mismatch)
+      FuncHashMismatches.emplace_back(Record.FunctionName, Record.FunctionHash);
+    else if (IPE != instrprof_error::unknown_function)
+      return make_error<InstrProfError>(IPE);
+  }
+  return Error::success();
+}
+
 Expected<std::unique_ptr<CoverageMapping>> CoverageMapping::load(
     ArrayRef<std::unique_ptr<CoverageMappingReader>> CoverageReaders,
     IndexedInstrProfReader &ProfileReader) {
@@ -267,15 +304,102 @@ Expected<std::unique_ptr<CoverageMapping>> CoverageMapping::load(
   return std::move(Coverage);
 }
 
+namespace {
+
+/// A function record decoded by BinaryCoverageReader::readRecord, together with
+/// the data it refers to.
+struct DecodedFunctionRecord {
+  CoverageMappingRecord Record;
+  std::vector<StringRef> Filenames;
+  std::vector<CounterExpression> Expressions;
+  std::vector<CounterMappingRegion> MappingRegions;
+  bool Selected = false;
+};
+
+/// The number of function records that are decoded before they are added.
+/// This bounds the memory used by the decoded records.
+constexpr size_t DecodeBatchSize = 4096;
+
+} // end anonymous namespace
+
+Error CoverageMapping::loadFunctionRecords(
+    const BinaryCoverageReader &CoverageReader,
+    IndexedInstrProfReader &ProfileReader, const StringSet<> &Files,
+    ThreadPool *Pool, unsigned NumThreads) {
+  // Decodes the record at Index into D, unless it is not needed.
+  auto Decode = [&](DecodedFunctionRecord &D, size_t Index) -> Error {
+    if (!Files.empty()) {
+      // Only look at the files of the record to decide whether it is needed,
+      // which is much cheaper than decoding its regions.
+      if (Error E =
+              CoverageReader.readRecordFilenames(Index, D.Record, D.Filenames))
+        return E;
+      if (llvm::none_of(D.Filenames, [&](StringRef Filename) {
+            return Files.count(Filename);
+          }))
+        return Error::success();
+      D.Filenames.clear();
+    }
+    D.Selected = true;
+    return CoverageReader.readRecord(Index, D.Record, D.Filenames,
+                                     D.Expressions, D.MappingRegions);
+  };
+
+  std::vector<DecodedFunctionRecord> Batch;
+  size_t NumRecords = CoverageReader.getNumRecords();
+  for (size_t Begin = 0; Begin < NumRecords; Begin += DecodeBatchSize) {
+    size_t BatchSize = std::min(DecodeBatchSize, NumRecords - Begin);
+    Batch.clear();
+    Batch.resize(BatchSize);
+
+    if (!Pool) {
+      for (size_t I = 0; I < BatchSize; ++I)
+        if (Error E = Decode(Batch[I], Begin + I))
+          return E;
+    } else {
+      // Decoding a record only reads the coverage mapping, so the records of
+      // the batch are split evenly among the threads.
+      Error Err = Error::success();
+      std::mutex ErrMutex;
+      size_t ChunkSize = (BatchSize + NumThreads - 1) / NumThreads;
+      for (size_t From = 0; From < BatchSize; From += ChunkSize) {
+        size_t To = std::min(From + ChunkSize, BatchSize);
+        Pool->async([&, From, To] {
+          for (size_t I = From; I < To; ++I)
+            if (Error E = Decode(Batch[I], Begin + I)) {
+              std::lock_guard<std::mutex> Lock(ErrMutex);
+              Err = joinErrors(std::move(Err), std::move(E));
+              return;
+            }
+        });
+      }
+      Pool->wait();
+      if (Err)
+        return Err;
+    }
+
+    // Add the records in their original order, so that the result does not
+    // depend on the number of threads.
+    for (const DecodedFunctionRecord &D : Batch) {
+      if (Error E = D.Selected
+                        ? loadFunctionRecord(D.Record, ProfileReader)
+                        : checkSkippedFunctionRecord(D.Record, ProfileReader))
+        return E;
+    }
+  }
+  return Error::success();
+}
+
 Expected<std::unique_ptr<CoverageMapping>>
 CoverageMapping::load(ArrayRef<StringRef> ObjectFilenames,
-                      StringRef ProfileFilename, ArrayRef<StringRef> Arches) {
+                      StringRef ProfileFilename, ArrayRef<StringRef> Arches,
+                      const CoverageLoadOptions &Options) {
   auto ProfileReaderOrErr = IndexedInstrProfReader::create(ProfileFilename);
   if (Error E = ProfileReaderOrErr.takeError())
     return std::move(E);
   auto ProfileReader = std::move(ProfileReaderOrErr.get());
 
-  SmallVector<std::unique_ptr<CoverageMappingReader>, 4> Readers;
+  SmallVector<std::unique_ptr<BinaryCoverageReader>, 4> Readers;
   SmallVector<std::unique_ptr<MemoryBuffer>, 4> Buffers;
   for (const auto &File : llvm::enumerate(ObjectFilenames)) {
     auto CovMappingBufOrErr = MemoryBuffer::getFileOrSTDIN(File.value());
@@ -289,7 +413,31 @@ CoverageMapping::load(ArrayRef<StringRef> ObjectFilenames,
     Readers.push_back(std::move(CoverageReaderOrErr.get()));
     Buffers.push_back(std::move(CovMappingBufOrErr.get()));
   }
-  return load(Readers, *ProfileReader);
+
+  // Unless asked for explicitly, only use threads if there are several
+  // batches of records to decode.
+  unsigned NumThreads = Options.NumThreads;
+  if (NumThreads == 0) {
+    size_t NumRecords = 0;
+    for (const auto &Reader : Readers)
+      NumRecords += Reader->getNumRecords();
+    NumThreads =
+        NumRecords > DecodeBatchSize ? heavyweight_hardware_concurrency() : 1;
+  }
+  std::unique_ptr<ThreadPool> Pool;
+  if (NumThreads > 1)
+    Pool = llvm::make_unique<ThreadPool>(NumThreads);
+
+  StringSet<> Files;
+  for (StringRef Filename : Options.Files)
+    Files.insert(Filename);
+
+  auto Coverage = std::unique_ptr<CoverageMapping>(new CoverageMapping());
+  for (const auto &Reader : Readers)
+    if (Error E = Coverage->loadFunctionRecords(*Reader, *ProfileReader, Files,
+                                                Pool.get(), NumThreads))
+      return std::move(E);
+  return std::move(Coverage);
 }
 
 namespace {
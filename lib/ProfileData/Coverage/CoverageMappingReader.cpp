@@ -249,9 +249,8 @@ Error RawCoverageMappingReader::readMappingRegionsSubArray(
   return Error::success();
 }
 
-Error RawCoverageMappingReader::read() {
-  // Read the virtual file mapping.
-  SmallVector<unsigned, 8> VirtualFileMapping;
+Error RawCoverageMappingReader::readVirtualFileMapping(
+    SmallVectorImpl<unsigned> &VirtualFileMapping) {
   uint64_t NumFileMappings;
   if (auto Err = readSize(NumFileMappings))
     return Err;
@@ -266,6 +265,19 @@ Error RawCoverageMappingReader::read() {
   for (auto I : VirtualFileMapping) {
     Filenames.push_back(TranslationUnitFilenames[I]);
   }
+  return Error::success();
+}
+
+Error RawCoverageMappingReader::readFilenames() {
+  SmallVector<unsigned, 8> VirtualFileMapping;
+  return readVirtualFileMapping(VirtualFileMapping);
+}
+
+Error RawCoverageMappingReader::read() {
+  // Read the virtual file mapping.
+  SmallVector<unsigned, 8> VirtualFileMapping;
+  if (auto Err = readVirtualFileMapping(VirtualFileMapping))
+    return Err;
 
   // Read the expressions.
   uint64_t NumExpressions;
@@ -724,26 +736,58 @@ BinaryCoverageReader::create(std::unique_ptr<MemoryBuffer> &ObjectBuffer,
   return std::move(Reader);
 }
 
-Error BinaryCoverageReader::readNextRecord(CoverageMappingRecord &Record) {
-  if (CurrentRecord >= MappingRecords.size())
-    return make_error<CoverageMapError>(coveragemap_error::eof);
+Error BinaryCoverageReader::readRecordFilenames(
+    size_t Index, CoverageMappingRecord &Record,
+    std::vector<StringRef> &FunctionFilenames) const {
+  std::vector<CounterExpression> FunctionExpressions;
+  std::vector<CounterMappingRegion> FunctionMappingRegions;
+  auto &R = MappingRecords[Index];
+  RawCoverageMappingReader Reader(
+      R.CoverageMapping,
+      makeArrayRef(Filenames).slice(R.FilenamesBegin, R.FilenamesSize),
+      FunctionFilenames, FunctionExpressions, FunctionMappingRegions);
+  if (auto Err = Reader.readFilenames())
+    return Err;
 
-  FunctionsFilenames.clear();
-  Expressions.clear();
-  MappingRegions.clear();
-  auto &R = MappingRecords[CurrentRecord];
+  Record.FunctionName = R.FunctionName;
+  Record.FunctionHash = R.FunctionHash;
+  Record.Filenames = FunctionFilenames;
+  Record.Expressions = None;
+  Record.MappingRegions = None;
+  return Error::success();
+}
+
+Error BinaryCoverageReader::readRecord(
+    size_t Index, CoverageMappingRecord &Record,
+    std::vector<StringRef> &FunctionFilenames,
+    std::vector<CounterExpression> &FunctionExpressions,
+    std::vector<CounterMappingRegion> &FunctionMappingRegions) const {
+  auto &R = MappingRecords[Index];
   RawCoverageMappingReader Reader(
       R.CoverageMapping,
       makeArrayRef(Filenames).slice(R.FilenamesBegin, R.FilenamesSize),
-      FunctionsFilenames, Expressions, MappingRegions);
+      FunctionFilenames, FunctionExpressions, FunctionMappingRegions);
   if (auto Err = Reader.read())
     return Err;
 
   Record.FunctionName = R.FunctionName;
   Record.FunctionHash = R.FunctionHash;
-  Record.Filenames = FunctionsFilenames;
-  Record.Expressions = Expressions;
-  Record.MappingRegions = MappingRegions;
+  Record.Filenames = FunctionFilenames;
+  Record.Expressions = FunctionExpressions;
+  Record.MappingRegions = FunctionMappingRegions;
+  return Error::success();
+}
+
+Error BinaryCoverageReader::readNextRecord(CoverageMappingRecord &Record) {
+  if (CurrentRecord >= MappingRecords.size())
+    return make_error<CoverageMapError>(coveragemap_error::eof);
+
+  FunctionsFilenames.clear();
+  Expressions.clear();
+  MappingRegions.clear();
+  if (auto Err = readRecord(CurrentRecord, Record, FunctionsFilenames,
+                            Expressions, MappingRegions))
+    return Err;
 
   ++CurrentRecord;
   return Error::success();
@@ -10,6 +10,8 @@
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cassert>
 #include <vector>
@@ -18,6 +20,18 @@ using namespace llvm;
 // Clients are responsible for avoid race conditions in registration.
 static Target *FirstTarget = nullptr;
 
+/// The initializers of a backend that run when one of its targets is first
+/// looked up. Shared by all the targets the backend registers.
+struct Target::LazyInitializers {
+  void (*TargetInfoFn)();
+  std::vector<void (*)()> InitFns;
+  llvm::once_flag Initialized;
+  bool HasRun = false;
+};
+
+static ManagedStatic<std::vector<std::unique_ptr<Target::LazyInitializers>>>
+    LazyBackends;
+
 iterator_range<TargetRegistry::iterator> TargetRegistry::targets() {
   return make_range(iterator(FirstTarget), iterator());
 }
@@ -38,7 +52,7 @@ const Target *TargetRegistry::lookupTarget(const std::string &ArchName,
       return nullptr;
     }
 
-    TheTarget = &*I;
+    TheTarget = initializeLazily(&*I);
 
     // Adjust the triple to match (if known), otherwise stick with the
     // given triple.
@@ -83,7 +97,50 @@ const Target *TargetRegistry::lookupTarget(const std::string &TT,
     return nullptr;
   }
 
-  return &*I;
+  return initializeLazily(&*I);
+}
+
+const Target *TargetRegistry::initializeLazily(const Target *T) {
+  if (Target::LazyInitializers *Lazy = T->LazyInit)
+    llvm::call_once(Lazy->Initialized, [Lazy] {
+      for (auto InitFn : Lazy->InitFns)
+        InitFn();
+      Lazy->HasRun = true;
+    });
+  return T;
+}
+
+void TargetRegistry::RegisterLazyInitializer(void (*TargetInfoFn)(),
+                                             void (*InitFn)()) {
+  auto I = find_if(*LazyBackends,
+                   [&](const std::unique_ptr<Target::LazyInitializers> &Lazy) {
+    return Lazy->TargetInfoFn == TargetInfoFn;
+  });
+  if (I != LazyBackends->end()) {
+    // A backend that has already been looked up is not lazy anymore.
+    if ((*I)->HasRun)
+      InitFn();
+    else
+      (*I)->InitFns.push_back(InitFn);
+    return;
+  }
+
+  // The targets registered by TargetInfoFn are the ones that end up in front
+  // of the current head of the list.
+  Target *OldFirst = FirstTarget;
+  TargetInfoFn();
+  if (FirstTarget == OldFirst) {
+    // The backend was initialized eagerly before, or registers no target.
+    InitFn();
+    return;
+  }
+
+  auto Lazy = llvm::make_unique<Target::LazyInitializers>();
+  Lazy->TargetInfoFn = TargetInfoFn;
+  Lazy->InitFns.push_back(InitFn);
+  for (Target *T = FirstTarget; T != OldFirst; T = T->Next)
+    T->LazyInit = Lazy.get();
+  LazyBackends->push_back(std::move(Lazy));
 }
 
 void TargetRegistry::RegisterTarget(Target &T, const char *Name,
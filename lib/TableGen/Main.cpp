@@ -42,6 +42,10 @@ DependFilename("d",
 static cl::opt<std::string>
 InputFilename(cl::Positional, cl::desc("<input file>"), cl::init("-"));
 
+static cl::opt<bool>
+WriteIfChanged("write-if-changed",
+               cl::desc("Only write the output files if they changed"));
+
 static cl::list<std::string>
 IncludeDirs("I", cl::desc("Directory of include files"),
             cl::value_desc("directory"), cl::Prefix);
@@ -56,7 +60,8 @@ static int reportError(const char *ProgName, Twine Msg) {
 ///
 /// This functionality is really only for the benefit of the build system.
 /// It is similar to GCC's `-M*` family of options.
-static int createDependencyFile(const TGParser &Parser, const char *argv0) {
+static int createDependencyFile(const TGParser &Parser, const char *argv0,
+                                ArrayRef<TableGenOutput> ExtraOutputs) {
   if (OutputFilename == "-")
     return reportError(argv0, "the option -d must be used together with -o\n");
 
@@ -65,7 +70,11 @@ static int createDependencyFile(const TGParser &Parser, const char *argv0) {
   if (EC)
     return reportError(argv0, "error opening " + DependFilename + ":" +
                                   EC.message() + "\n");
-  DepOut.os() << OutputFilename << ":";
+  // All the outputs are generated from the same inputs.
+  DepOut.os() << OutputFilename;
+  for (const TableGenOutput &Output : ExtraOutputs)
+    DepOut.os() << ' ' << Output.Filename;
+  DepOut.os() << ":";
   for (const auto &Dep : Parser.getDependencies()) {
     DepOut.os() << ' ' << Dep.first;
   }
@@ -74,7 +83,45 @@ static int createDependencyFile(const TGParser &Parser, const char *argv0) {
   return 0;
 }
 
-int llvm::TableGenMain(char *argv0, TableGenMainFn *MainFn) {
+/// Run Emit on the records and write its output to Filename.
+static int writeOutput(const char *argv0, StringRef Filename,
+                       const std::function<bool(raw_ostream &,
+                                                RecordKeeper &)> &Emit,
+                       RecordKeeper &Records) {
+  std::string OutString;
+  raw_string_ostream Out(OutString);
+  bool Failed = Emit(Out, Records);
+  Out.flush();
+
+  // Leaving an unchanged file alone keeps the files that include it from
+  // being rebuilt.
+  if (WriteIfChanged && !Failed && ErrorsPrinted == 0) {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> OldOrErr =
+        MemoryBuffer::getFile(Filename);
+    if (OldOrErr && (*OldOrErr)->getBuffer() == OutString)
+      return 0;
+  }
+
+  std::error_code EC;
+  ToolOutputFile OutFile(Filename, EC, sys::fs::F_Text);
+  if (EC)
+    return reportError(argv0, "error opening " + Filename + ":" +
+                                  EC.message() + "\n");
+  // Output to stdout is printed even if there were errors; a file is only
+  // kept on success.
+  OutFile.os() << OutString;
+  if (Failed)
+    return 1;
+
+  if (ErrorsPrinted > 0)
+    return reportError(argv0, Twine(ErrorsPrinted) + " errors.\n");
+
+  OutFile.keep();
+  return 0;
+}
+
+int llvm::TableGenMain(char *argv0, TableGenMainFn *MainFn,
+                       ArrayRef<TableGenOutput> ExtraOutputs) {
   RecordKeeper Records;
 
   // Parse the input file.
@@ -96,23 +143,19 @@ int llvm::TableGenMain(char *argv0, TableGenMainFn *MainFn) {
   if (Parser.ParseFile())
     return 1;
 
-  std::error_code EC;
-  ToolOutputFile Out(OutputFilename, EC, sys::fs::F_Text);
-  if (EC)
-    return reportError(argv0, "error opening " + OutputFilename + ":" +
-                                  EC.message() + "\n");
   if (!DependFilename.empty()) {
-    if (int Ret = createDependencyFile(Parser, argv0))
+    if (int Ret = createDependencyFile(Parser, argv0, ExtraOutputs))
       return Ret;
   }
 
-  if (MainFn(Out.os(), Records))
-    return 1;
-
-  if (ErrorsPrinted > 0)
-    return reportError(argv0, Twine(ErrorsPrinted) + " errors.\n");
+  // The outputs are generated one after the other, since they share the
+  // records, and the records are not thread safe.
+  if (int Ret = writeOutput(argv0, OutputFilename, MainFn, Records))
+    return Ret;
+  for (const TableGenOutput &Output : ExtraOutputs)
+    if (int Ret = writeOutput(argv0, Output.Filename, Output.Emit, Records))
+      return Ret;
 
   // Declare success.
-  Out.keep();
   return 0;
 }
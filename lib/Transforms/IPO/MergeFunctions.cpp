@@ -120,6 +120,7 @@
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Parallel.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/Utils/FunctionComparator.h"
@@ -145,6 +146,16 @@ static cl::opt<unsigned> NumFunctionsForSanityCheck(
              "'0' disables this check. Works only with '-debug' key."),
     cl::init(0), cl::Hidden);
 
+// Under option -mergefunc-parallel-hash the structural hash of every function
+// is computed concurrently. functionHash() only reads the function body, and
+// each result is stored in its own slot before the (stable) sort, so the
+// functions that get merged do not depend on the thread scheduling.
+static cl::opt<bool>
+    MergeFunctionsParallelHash("mergefunc-parallel-hash", cl::Hidden,
+                               cl::init(false),
+                               cl::desc("Compute function hashes in parallel "
+                                        "before merging functions."));
+
 // Under option -mergefunc-preserve-debug-info we:
 // - Do not create a new function for a thunk.
 // - Retain the debug info for a thunk's parameters (and associated
@@ -382,10 +393,21 @@ bool MergeFunctions::runOnModule(Module &M) {
     HashedFuncs;
   for (Function &Func : M) {
     if (!Func.isDeclaration() && !Func.hasAvailableExternallyLinkage()) {
-      HashedFuncs.push_back({FunctionComparator::functionHash(Func), &Func});
+      HashedFuncs.push_back({0, &Func});
     }
   }
 
+  auto HashFunc =
+      [](std::pair<FunctionComparator::FunctionHash, Function *> &HF) {
+        HF.first = FunctionComparator::functionHash(*HF.second);
+      };
+  if (MergeFunctionsParallelHash)
+    parallel::for_each(parallel::par, HashedFuncs.begin(), HashedFuncs.end(),
+                       HashFunc);
+  else
+    parallel::for_each(parallel::seq, HashedFuncs.begin(), HashedFuncs.end(),
+                       HashFunc);
+
   std::stable_sort(
       HashedFuncs.begin(), HashedFuncs.end(),
       [](const std::pair<FunctionComparator::FunctionHash, Function *> &a,
@@ -620,13 +620,13 @@ public:
 
     // Make sure that we reprocess all operands now that we reduced their
     // use counts.
-    if (I.getNumOperands() < 8) {
-      for (Use &Operand : I.operands())
-        if (auto *Inst = dyn_cast<Instruction>(Operand))
-          Worklist.Add(Inst);
-    }
+    SmallVector<Value *, 8> Ops;
+    if (I.getNumOperands() < 8)
+      Ops.append(I.op_begin(), I.op_end());
     Worklist.Remove(&I);
     I.eraseFromParent();
+    for (Value *Op : Ops)
+      Worklist.HandleUseCountDecrement(Op);
     MadeIRChange = true;
     return nullptr; // Don't do anything with FI
   }
@@ -116,6 +116,13 @@ STATISTIC(NumSunkInst , "Number of instructions sunk");
 STATISTIC(NumExpand,    "Number of expansions");
 STATISTIC(NumFactor   , "Number of factorizations");
 STATISTIC(NumReassoc  , "Number of reassociations");
+STATISTIC(NumWorklistIterations,
+          "Number of instruction combining iterations performed");
+STATISTIC(NumOneIteration, "Number of functions with one iteration");
+STATISTIC(NumTwoIterations, "Number of functions with two iterations");
+STATISTIC(NumThreeIterations, "Number of functions with three iterations");
+STATISTIC(NumFourOrMoreIterations,
+          "Number of functions with four or more iterations");
 DEBUG_COUNTER(VisitCounter, "instcombine-visit",
               "Controls which instructions are visited");
 
@@ -123,6 +130,18 @@ static cl::opt<bool>
 EnableExpensiveCombines("expensive-combines",
                         cl::desc("Enable expensive instruction combines"));
 
+static constexpr unsigned InstCombineDefaultMaxIterations = 1000;
+
+static cl::opt<unsigned> MaxIterations(
+    "instcombine-max-iterations", cl::Hidden,
+    cl::desc("Limit the maximum number of instruction combining iterations"),
+    cl::init(InstCombineDefaultMaxIterations));
+
+static cl::opt<bool> VerifyFixpoint(
+    "instcombine-verify-fixpoint", cl::Hidden, cl::init(false),
+    cl::desc("Report an error if instruction combining did not reach a "
+             "fixpoint after its first iteration"));
+
 static cl::opt<unsigned>
 MaxArraySize("instcombine-maxarray-size", cl::init(1024),
              cl::desc("Maximum array size considered when doing a combine"));
@@ -2947,6 +2966,9 @@ static bool TryToSinkInstruction(Instruction *I, BasicBlock *DestBlock) {
 
 bool InstCombiner::run() {
   while (!Worklist.isEmpty()) {
+    // Instructions created while visiting the previous instruction go onto
+    // the worklist now, so that they are visited next and in program order.
+    Worklist.FlushDeferred();
     Instruction *I = Worklist.RemoveOne();
     if (I == nullptr) continue;  // skip null values.
 
@@ -3257,7 +3279,7 @@ static bool combineInstructionsOverFunction(
   IRBuilder<TargetFolder, IRBuilderCallbackInserter> Builder(
       F.getContext(), TargetFolder(DL),
       IRBuilderCallbackInserter([&Worklist, &AC](Instruction *I) {
-        Worklist.Add(I);
+        Worklist.AddDeferred(I);
         if (match(I, m_Intrinsic<Intrinsic::assume>()))
           AC.registerAssumption(cast<CallInst>(I));
       }));
@@ -3269,8 +3291,9 @@ static bool combineInstructionsOverFunction(
     MadeIRChange = LowerDbgDeclare(F);
 
   // Iterate while there is work to do.
-  int Iteration = 0;
+  unsigned Iteration = 0;
   while (true) {
+    ++NumWorklistIterations;
     ++Iteration;
     LLVM_DEBUG(dbgs() << "\n\nINSTCOMBINE ITERATION #" << Iteration << " on "
                       << F.getName() << "\n");
@@ -3283,9 +3306,34 @@ static bool combineInstructionsOverFunction(
 
     if (!IC.run())
       break;
+    MadeIRChange = true;
+
+    // The first iteration sees every instruction, and every fold pushes the
+    // users and operands it affects back onto the worklist, so anything found
+    // by a later iteration is a fold that the worklist failed to revisit.
+    if (Iteration > 1 && VerifyFixpoint)
+      report_fatal_error("Instruction Combining did not reach a fixpoint "
+                         "after 1 iteration in function '" +
+                         F.getName() + "'");
+
+    if (Iteration >= MaxIterations) {
+      LLVM_DEBUG(dbgs() << "\n\n[IC] Iteration limit #" << MaxIterations
+                        << " on " << F.getName()
+                        << " reached; stopping before reaching a fixpoint\n");
+      break;
+    }
   }
 
-  return MadeIRChange || Iteration > 1;
+  if (Iteration == 1)
+    ++NumOneIteration;
+  else if (Iteration == 2)
+    ++NumTwoIterations;
+  else if (Iteration == 3)
+    ++NumThreeIterations;
+  else
+    ++NumFourOrMoreIterations;
+
+  return MadeIRChange;
 }
 
 PreservedAnalyses InstCombinePass::run(Function &F,
@@ -25,6 +25,42 @@ namespace {
 using XRayRecordStorage =
     std::aligned_storage<sizeof(XRayRecord), alignof(XRayRecord)>::type;
 
+/// The readers below decode one record at a time and hand it to a RecordSink,
+/// which forwards it to the consumer. Call argument records amend the function
+/// record that precedes them, so the sink holds on to the latest record until
+/// the next one starts or the log ends. This lets us stream arbitrarily large
+/// logs while only keeping a single record in memory.
+class RecordSink {
+  function_ref<Error(const XRayRecord &)> Consumer;
+  XRayRecord Pending;
+  bool HasPending = false;
+
+public:
+  explicit RecordSink(function_ref<Error(const XRayRecord &)> Consumer)
+      : Consumer(Consumer) {}
+
+  /// Hands the pending record (if any) to the consumer, and returns a freshly
+  /// cleared record to be populated by the reader.
+  Expected<XRayRecord &> next() {
+    if (auto E = flush())
+      return std::move(E);
+    Pending.CallArgs.clear();
+    HasPending = true;
+    return Pending;
+  }
+
+  /// Returns the record that was started last, or nullptr if there is none.
+  XRayRecord *back() { return HasPending ? &Pending : nullptr; }
+
+  /// Hands the pending record (if any) to the consumer.
+  Error flush() {
+    if (!HasPending)
+      return Error::success();
+    HasPending = false;
+    return Consumer(Pending);
+  }
+};
+
 // Populates the FileHeader reference by reading the first 32 bytes of the file.
 Error readBinaryFormatHeader(StringRef Data, XRayFileHeader &FileHeader) {
   // FIXME: Maybe deduce whether the data is little or big-endian using some
@@ -57,7 +93,7 @@ Error readBinaryFormatHeader(StringRef Data, XRayFileHeader &FileHeader) {
 }
 
 Error loadNaiveFormatLog(StringRef Data, XRayFileHeader &FileHeader,
-                         std::vector<XRayRecord> &Records) {
+                         RecordSink &Records) {
   if (Data.size() < 32)
     return make_error<StringError>(
         "Not enough bytes for an XRay log.",
@@ -86,8 +122,10 @@ Error loadNaiveFormatLog(StringRef Data, XRayFileHeader &FileHeader,
     uint32_t OffsetPtr = 0;
     switch (auto RecordType = RecordExtractor.getU16(&OffsetPtr)) {
     case 0: { // Normal records.
-      Records.emplace_back();
-      auto &Record = Records.back();
+      auto RecordOrErr = Records.next();
+      if (!RecordOrErr)
+        return RecordOrErr.takeError();
+      auto &Record = *RecordOrErr;
       Record.RecordType = RecordType;
       Record.CPU = RecordExtractor.getU8(&OffsetPtr);
       auto Type = RecordExtractor.getU8(&OffsetPtr);
@@ -116,7 +154,13 @@ Error loadNaiveFormatLog(StringRef Data, XRayFileHeader &FileHeader,
       break;
     }
     case 1: { // Arg payload record.
-      auto &Record = Records.back();
+      if (!Records.back())
+        return make_error<StringError>(
+            Twine("Corrupted log, found arg payload without a preceding "
+                  "function record; offset: ") +
+                Twine(S.data() - Data.data()),
+            std::make_error_code(std::errc::executable_format_error));
+      auto &Record = *Records.back();
       // Advance two bytes to avoid padding.
       OffsetPtr += 2;
       int32_t FuncId = RecordExtractor.getSigned(&OffsetPtr, sizeof(int32_t));
@@ -330,16 +374,16 @@ Error processBufferExtents(FDRState &State, uint8_t RecordFirstByte,
 /// State transition when a CallArgumentRecord is encountered.
 Error processFDRCallArgumentRecord(FDRState &State, uint8_t RecordFirstByte,
                                    DataExtractor &RecordExtractor,
-                                   std::vector<XRayRecord> &Records) {
+                                   RecordSink &Records) {
   uint32_t OffsetPtr = 1; // Read starting after the first byte.
-  auto &Enter = Records.back();
+  XRayRecord *Enter = Records.back();
 
-  if (Enter.Type != RecordTypes::ENTER)
+  if (!Enter || Enter->Type != RecordTypes::ENTER)
     return make_error<StringError>(
         "CallArgument needs to be right after a function entry",
         std::make_error_code(std::errc::executable_format_error));
-  Enter.Type = RecordTypes::ENTER_ARG;
-  Enter.CallArgs.emplace_back(RecordExtractor.getU64(&OffsetPtr));
+  Enter->Type = RecordTypes::ENTER_ARG;
+  Enter->CallArgs.emplace_back(RecordExtractor.getU64(&OffsetPtr));
   return Error::success();
 }
 
@@ -357,8 +401,7 @@ Error processFDRCallArgumentRecord(FDRState &State, uint8_t RecordFirstByte,
 /// WallTimeMarker
 Error processFDRMetadataRecord(FDRState &State, uint8_t RecordFirstByte,
                                DataExtractor &RecordExtractor,
-                               size_t &RecordSize,
-                               std::vector<XRayRecord> &Records,
+                               size_t &RecordSize, RecordSink &Records,
                                uint16_t Version) {
   // The remaining 7 bits are the RecordKind enum.
   uint8_t RecordKind = RecordFirstByte >> 1;
@@ -432,7 +475,7 @@ Error processFDRMetadataRecord(FDRState &State, uint8_t RecordFirstByte,
 /// State.
 Error processFDRFunctionRecord(FDRState &State, uint8_t RecordFirstByte,
                                DataExtractor &RecordExtractor,
-                               std::vector<XRayRecord> &Records) {
+                               RecordSink &Records) {
   switch (State.Expects) {
   case FDRState::Token::NEW_BUFFER_RECORD_OR_EOF:
     return make_error<StringError>(
@@ -451,8 +494,10 @@ Error processFDRFunctionRecord(FDRState &State, uint8_t RecordFirstByte,
         "Malformed log. Received Function Record before first CPU record.",
         std::make_error_code(std::errc::executable_format_error));
   default:
-    Records.emplace_back();
-    auto &Record = Records.back();
+    auto RecordOrErr = Records.next();
+    if (!RecordOrErr)
+      return RecordOrErr.takeError();
+    auto &Record = *RecordOrErr;
     Record.RecordType = 0; // Record is type NORMAL.
     // Strip off record type bit and use the next three bits.
     uint8_t RecordType = (RecordFirstByte >> 1) & 0x07;
@@ -540,7 +585,7 @@ Error processFDRFunctionRecord(FDRState &State, uint8_t RecordFirstByte,
 ///               FunctionSequence
 /// EOB: *deprecated*
 Error loadFDRLog(StringRef Data, XRayFileHeader &FileHeader,
-                 std::vector<XRayRecord> &Records) {
+                 RecordSink &Records) {
   if (Data.size() < 32)
     return make_error<StringError>(
         "Not enough bytes for an XRay log.",
@@ -649,7 +694,7 @@ Error loadFDRLog(StringRef Data, XRayFileHeader &FileHeader,
 }
 
 Error loadYAMLLog(StringRef Data, XRayFileHeader &FileHeader,
-                  std::vector<XRayRecord> &Records) {
+                  RecordSink &Records) {
   YAMLXRayTrace Trace;
   Input In(Data);
   In >> Trace;
@@ -667,17 +712,20 @@ Error loadYAMLLog(StringRef Data, XRayFileHeader &FileHeader,
         Twine("Unsupported XRay file version: ") + Twine(FileHeader.Version),
         std::make_error_code(std::errc::invalid_argument));
 
-  Records.clear();
-  std::transform(Trace.Records.begin(), Trace.Records.end(),
-                 std::back_inserter(Records), [&](const YAMLXRayRecord &R) {
-                   return XRayRecord{R.RecordType, R.CPU, R.Type, R.FuncId,
-                                     R.TSC,        R.TId, R.PId,  R.CallArgs};
-                 });
+  for (const YAMLXRayRecord &R : Trace.Records) {
+    auto RecordOrErr = Records.next();
+    if (!RecordOrErr)
+      return RecordOrErr.takeError();
+    *RecordOrErr = XRayRecord{R.RecordType, R.CPU, R.Type, R.FuncId,
+                              R.TSC,        R.TId, R.PId,  R.CallArgs};
+  }
   return Error::success();
 }
-} // namespace
 
-Expected<Trace> llvm::xray::loadTraceFile(StringRef Filename, bool Sort) {
+/// Maps |Filename| into memory and hands its contents to |Fn|. The contents are
+/// only valid for the duration of the call.
+Error withMappedTraceFile(StringRef Filename,
+                          function_ref<Error(StringRef)> Fn) {
   int Fd;
   if (auto EC = sys::fs::openFileForRead(Filename, Fd)) {
     return make_error<StringError>(
@@ -703,8 +751,13 @@ Expected<Trace> llvm::xray::loadTraceFile(StringRef Filename, bool Sort) {
     return make_error<StringError>(
         Twine("Cannot read log from '") + Filename + "'", EC);
   }
-  auto Data = StringRef(MappedFile.data(), MappedFile.size());
+  return Fn(StringRef(MappedFile.data(), MappedFile.size()));
+}
 
+/// Detects the format of the log in |Data|, reads its header into |FileHeader|
+/// and decodes every record into |Records|.
+Error readTraceData(StringRef Data, XRayFileHeader &FileHeader,
+                    RecordSink &Records) {
   // Attempt to detect the file type using file magic. We have a slight bias
   // towards the binary format, and we do this by making sure that the first 4
   // bytes of the binary file is some combination of the following byte
@@ -719,7 +772,7 @@ Expected<Trace> llvm::xray::loadTraceFile(StringRef Filename, bool Sort) {
   //
   // Only if we can't load either the binary or the YAML format will we yield an
   // error.
-  StringRef Magic(MappedFile.data(), 4);
+  StringRef Magic = Data.take_front(4);
   DataExtractor HeaderExtractor(Magic, true, 8);
   uint32_t OffsetPtr = 0;
   uint16_t Version = HeaderExtractor.getU16(&OffsetPtr);
@@ -727,12 +780,11 @@ Expected<Trace> llvm::xray::loadTraceFile(StringRef Filename, bool Sort) {
 
   enum BinaryFormatType { NAIVE_FORMAT = 0, FLIGHT_DATA_RECORDER_FORMAT = 1 };
 
-  Trace T;
   switch (Type) {
   case NAIVE_FORMAT:
     if (Version == 1 || Version == 2 || Version == 3) {
-      if (auto E = loadNaiveFormatLog(Data, T.FileHeader, T.Records))
-        return std::move(E);
+      if (auto E = loadNaiveFormatLog(Data, FileHeader, Records))
+        return E;
     } else {
       return make_error<StringError>(
           Twine("Unsupported version for Basic/Naive Mode logging: ") +
@@ -742,8 +794,8 @@ Expected<Trace> llvm::xray::loadTraceFile(StringRef Filename, bool Sort) {
     break;
   case FLIGHT_DATA_RECORDER_FORMAT:
     if (Version == 1 || Version == 2 || Version == 3) {
-      if (auto E = loadFDRLog(Data, T.FileHeader, T.Records))
-        return std::move(E);
+      if (auto E = loadFDRLog(Data, FileHeader, Records))
+        return E;
     } else {
       return make_error<StringError>(
           Twine("Unsupported version for FDR Mode logging: ") + Twine(Version),
@@ -751,10 +803,26 @@ Expected<Trace> llvm::xray::loadTraceFile(StringRef Filename, bool Sort) {
     }
     break;
   default:
-    if (auto E = loadYAMLLog(Data, T.FileHeader, T.Records))
-      return std::move(E);
+    if (auto E = loadYAMLLog(Data, FileHeader, Records))
+      return E;
   }
 
+  return Records.flush();
+}
+} // namespace
+
+Expected<Trace> llvm::xray::loadTraceFile(StringRef Filename, bool Sort) {
+  Trace T;
+  auto Append = [&](const XRayRecord &R) {
+    T.Records.push_back(R);
+    return Error::success();
+  };
+  if (auto E = withMappedTraceFile(Filename, [&](StringRef Data) {
+        RecordSink Records(Append);
+        return readTraceData(Data, T.FileHeader, Records);
+      }))
+    return std::move(E);
+
   if (Sort)
     std::stable_sort(T.Records.begin(), T.Records.end(),
               [&](const XRayRecord &L, const XRayRecord &R) {
@@ -763,3 +831,12 @@ Expected<Trace> llvm::xray::loadTraceFile(StringRef Filename, bool Sort) {
 
   return std::move(T);
 }
+
+Error llvm::xray::streamTraceFile(
+    StringRef Filename, XRayFileHeader &Header,
+    function_ref<Error(const XRayRecord &)> Callback) {
+  return withMappedTraceFile(Filename, [&](StringRef Data) {
+    RecordSink Records(Callback);
+    return readTraceData(Data, Header, Records);
+  });
+}
@@ -1,4 +1,10 @@
 ; RUN: llc -verify-machineinstrs -enable-machine-outliner -mtriple=x86_64-apple-darwin < %s | FileCheck %s
+; RUN: llc -verify-machineinstrs -enable-machine-outliner -outliner-max-mapped-instrs=1000 -mtriple=x86_64-apple-darwin < %s | FileCheck %s
+; RUN: llc -verify-machineinstrs -enable-machine-outliner -outliner-max-mapped-instrs=1 -mtriple=x86_64-apple-darwin < %s | FileCheck %s --check-prefix=SPLIT
+
+; With a one-instruction limit every function gets its own suffix tree, so
+; the sequence shared by foo0 and foo1 is not found.
+; SPLIT-NOT: OUTLINED_FUNCTION
 
 @x = common local_unnamed_addr global i32 0, align 4
 
@@ -0,0 +1,16 @@
+; REQUIRES: asserts
+; RUN: llc < %s -mtriple=x86_64-- -enable-misched -debug-only=machine-scheduler -o /dev/null 2>&1 | FileCheck %s --check-prefix=DEFAULT
+; RUN: llc < %s -mtriple=x86_64-- -enable-misched -misched-max-region-instrs=1 -debug-only=machine-scheduler -o /dev/null 2>&1 | FileCheck %s --check-prefix=SPLIT
+;
+; With a limit of one instruction per region, every region is too small to be
+; scheduled.
+;
+; DEFAULT: MI Scheduling
+; SPLIT-NOT: MI Scheduling
+
+define i32 @f(i32 %a, i32 %b, i32 %c, i32 %d) {
+  %x = add i32 %a, %b
+  %y = mul i32 %c, %d
+  %z = xor i32 %x, %y
+  ret i32 %z
+}
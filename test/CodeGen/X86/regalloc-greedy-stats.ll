@@ -0,0 +1,43 @@
+; REQUIRES: asserts
+; RUN: llc < %s -mtriple=x86_64-- -regalloc=greedy -stats -o /dev/null 2>&1 \
+; RUN:   | FileCheck %s --check-prefix=STATS
+; RUN: llc < %s -mtriple=x86_64-- -regalloc=greedy -time-passes -o /dev/null \
+; RUN:   2>&1 | FileCheck %s --check-prefix=TIMERS
+
+; Check that greedy reports its assignment statistics and timers. The values
+; live across the calls force some live ranges to be split.
+
+; STATS-DAG: {{[0-9]+}} regalloc - Number of interference checks{{$}}
+; STATS-DAG: {{[0-9]+}} regalloc - Number of interference checks answered from the cache
+; STATS-DAG: {{[0-9]+}} regalloc - Number of live ranges assigned a free register
+; STATS-DAG: {{[0-9]+}} regalloc - Number of live ranges deferred to the split stage
+
+; TIMERS: Register Allocation
+; TIMERS-DAG: Assign
+; TIMERS-DAG: Global Splitting
+
+declare void @f()
+
+define i32 @g(i32 %a, i32 %b, i32 %c, i32 %d, i32 %e, i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i32 [ 0, %entry ], [ %acc.next, %loop ]
+  call void @f()
+  %x0 = add i32 %a, %i
+  %x1 = mul i32 %b, %x0
+  call void @f()
+  %x2 = xor i32 %c, %x1
+  %x3 = sub i32 %d, %x2
+  call void @f()
+  %x4 = add i32 %e, %x3
+  %acc.next = add i32 %acc, %x4
+  %i.next = add i32 %i, 1
+  %cond = icmp slt i32 %i.next, %n
+  br i1 %cond, label %loop, label %exit
+
+exit:
+  ret i32 %acc.next
+}
@@ -0,0 +1,26 @@
+@llvm.global_ctors = appending global [1 x { i32, void ()*, i8* }] [{ i32, void ()*, i8* } { i32 65535, void ()* @ctor_a, i8* null }]
+@ctor_a_str = private unnamed_addr constant [7 x i8] c"ctor a\00"
+
+declare i32 @puts(i8*)
+declare i32 @b(i32)
+
+define internal void @ctor_a() {
+entry:
+  %0 = call i32 @puts(i8* getelementptr inbounds ([7 x i8], [7 x i8]* @ctor_a_str, i64 0, i64 0))
+  ret void
+}
+
+; a and b call each other until the counter reaches zero.
+define i32 @a(i32 %n) {
+entry:
+  %done = icmp eq i32 %n, 0
+  br i1 %done, label %exit, label %recurse
+
+recurse:
+  %n1 = sub i32 %n, 1
+  %r = call i32 @b(i32 %n1)
+  ret i32 %r
+
+exit:
+  ret i32 42
+}
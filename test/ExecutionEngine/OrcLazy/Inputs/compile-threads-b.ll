@@ -0,0 +1,17 @@
+@llvm.global_ctors = appending global [1 x { i32, void ()*, i8* }] [{ i32, void ()*, i8* } { i32 65535, void ()* @ctor_b, i8* null }]
+@ctor_b_str = private unnamed_addr constant [7 x i8] c"ctor b\00"
+
+declare i32 @puts(i8*)
+declare i32 @a(i32)
+
+define internal void @ctor_b() {
+entry:
+  %0 = call i32 @puts(i8* getelementptr inbounds ([7 x i8], [7 x i8]* @ctor_b_str, i64 0, i64 0))
+  ret void
+}
+
+define i32 @b(i32 %n) {
+entry:
+  %r = call i32 @a(i32 %n)
+  ret i32 %r
+}
@@ -0,0 +1,40 @@
+; RUN: lli -jit-kind=orc -compile-threads=0 \
+; RUN:   -extra-module %p/Inputs/compile-threads-a.ll \
+; RUN:   -extra-module %p/Inputs/compile-threads-b.ll %s | FileCheck %s
+; RUN: lli -jit-kind=orc -compile-threads=1 \
+; RUN:   -extra-module %p/Inputs/compile-threads-a.ll \
+; RUN:   -extra-module %p/Inputs/compile-threads-b.ll %s | FileCheck %s
+; RUN: lli -jit-kind=orc -compile-threads=4 \
+; RUN:   -extra-module %p/Inputs/compile-threads-a.ll \
+; RUN:   -extra-module %p/Inputs/compile-threads-b.ll %s | FileCheck %s
+;
+; Every module has a static constructor, so running the constructors queues
+; all of them at once, and linking each module needs the symbols of the others.
+; A compile thread that links one module must not wait for a module queued
+; behind it.
+;
+; CHECK-DAG: ctor main
+; CHECK-DAG: ctor a
+; CHECK-DAG: ctor b
+; CHECK: main 42
+
+@llvm.global_ctors = appending global [1 x { i32, void ()*, i8* }] [{ i32, void ()*, i8* } { i32 65535, void ()* @ctor_main, i8* null }]
+@ctor_main_str = private unnamed_addr constant [10 x i8] c"ctor main\00"
+@main_fmt = private unnamed_addr constant [9 x i8] c"main %d\0A\00"
+
+declare i32 @puts(i8*)
+declare i32 @printf(i8*, ...)
+declare i32 @a(i32)
+
+define internal void @ctor_main() {
+entry:
+  %0 = call i32 @puts(i8* getelementptr inbounds ([10 x i8], [10 x i8]* @ctor_main_str, i64 0, i64 0))
+  ret void
+}
+
+define i32 @main(i32 %argc, i8** %argv) {
+entry:
+  %r = call i32 @a(i32 3)
+  %0 = call i32 (i8*, ...) @printf(i8* getelementptr inbounds ([9 x i8], [9 x i8]* @main_fmt, i64 0, i64 0), i32 %r)
+  ret i32 0
+}
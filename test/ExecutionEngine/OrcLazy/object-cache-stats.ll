@@ -0,0 +1,17 @@
+; RUN: rm -rf %t && mkdir -p %t
+; RUN: lli -jit-kind=orc-lazy -enable-cache-manager -object-cache-dir=%t \
+; RUN:   -stats %S/object-cache.ll 2>&1 | FileCheck %s --check-prefix=FIRST
+; RUN: lli -jit-kind=orc-lazy -enable-cache-manager -object-cache-dir=%t \
+; RUN:   -stats %S/object-cache.ll 2>&1 | FileCheck %s --check-prefix=SECOND
+; REQUIRES: asserts
+;
+; Check that the first run compiles every object and stores it, and that the
+; second run loads them all from the cache instead.
+;
+; FIRST-NOT: Number of objects loaded from the object cache
+; FIRST: {{[0-9]+}} orc - Number of objects not found in the object cache
+; FIRST-NOT: Number of objects loaded from the object cache
+;
+; SECOND-NOT: Number of objects not found in the object cache
+; SECOND: {{[0-9]+}} orc - Number of objects loaded from the object cache
+; SECOND-NOT: Number of objects not found in the object cache
@@ -0,0 +1,22 @@
+; RUN: rm -rf %t && mkdir -p %t
+; RUN: lli -jit-kind=orc-lazy -enable-cache-manager -object-cache-dir=%t %s
+; RUN: ls %t | FileCheck %s
+; RUN: lli -jit-kind=orc-lazy -enable-cache-manager -object-cache-dir=%t %s
+; RUN: ls %t | FileCheck %s
+;
+; Check that compiled objects are stored in the cache directory, and that a
+; second run using them still works.
+;
+; CHECK-NOT: .tmp.o
+; CHECK: llvmcache-orc-
+
+define internal i32 @foo() {
+entry:
+  ret i32 0
+}
+
+define i32 @main(i32 %argc, i8** %argv) {
+entry:
+  %call = tail call i32 @foo()
+  ret i32 %call
+}
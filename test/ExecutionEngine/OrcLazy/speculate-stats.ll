@@ -0,0 +1,50 @@
+; RUN: lli -jit-kind=orc-lazy -orc-lazy-speculate=8 -orc-lazy-speculate-wait \
+; RUN:   -stats %s 2>&1 | FileCheck %s
+; REQUIRES: asserts
+;
+; Check that functions compiled in the background have their stubs patched
+; before their first call, so that the call does not go through the compile
+; callback. The constructor makes @work a candidate without calling it, and
+; compiling @work makes @helper one. Only @init and @main are compiled on
+; their first call.
+;
+; CHECK-DAG: {{^ *2}} orc - Number of functions compiled speculatively{{$}}
+; CHECK-DAG: {{^ *2}} orc - Number of stubs patched before the function's first call
+; CHECK-DAG: {{^ *2}} orc - Number of functions compiled on their first call
+
+@llvm.global_ctors = appending global [1 x { i32, void ()*, i8* }] [{ i32, void ()*, i8* } { i32 65535, void ()* @init, i8* null }]
+
+@flag = global i32 0
+
+define void @init() {
+entry:
+  %v = load i32, i32* @flag
+  %c = icmp ne i32 %v, 0
+  br i1 %c, label %call, label %done
+
+call:
+  %r = call i32 @work(i32 1)
+  br label %done
+
+done:
+  ret void
+}
+
+define i32 @helper(i32 %x) {
+entry:
+  %add = add nsw i32 %x, 1
+  ret i32 %add
+}
+
+define i32 @work(i32 %x) {
+entry:
+  %r = call i32 @helper(i32 %x)
+  ret i32 %r
+}
+
+define i32 @main(i32 %argc, i8** %argv) {
+entry:
+  %r = call i32 @work(i32 0)
+  %sub = sub nsw i32 %r, 1
+  ret i32 %sub
+}
@@ -0,0 +1,31 @@
+; RUN: lli -jit-kind=orc-lazy -orc-lazy-speculate=8 %s
+;
+; Check that functions compiled in the background before their first call,
+; and calls made through stubs that have been patched, still work.
+
+define internal i32 @baz(i32 %x) {
+entry:
+  %add = add nsw i32 %x, 1
+  ret i32 %add
+}
+
+define internal i32 @foo(i32 %x) {
+entry:
+  %call = tail call i32 @baz(i32 %x)
+  %call1 = tail call i32 @baz(i32 %call)
+  ret i32 %call1
+}
+
+define internal i32 @bar(i32 %x) {
+entry:
+  %sub = sub nsw i32 %x, 4
+  ret i32 %sub
+}
+
+define i32 @main(i32 %argc, i8** %argv) {
+entry:
+  %call = tail call i32 @foo(i32 0)
+  %call1 = tail call i32 @foo(i32 %call)
+  %call2 = tail call i32 @bar(i32 %call1)
+  ret i32 %call2
+}
@@ -0,0 +1,102 @@
+; RUN: %lli -force-interpreter=true %s
+
+; The frames of a recursive function share its value slots, but not the values
+; stored in them. The PHIs at the start of a block read their incoming values
+; before any of them is updated.
+
+define i32 @fib(i32 %n) {
+entry:
+  %small = icmp slt i32 %n, 2
+  br i1 %small, label %done, label %recurse
+
+recurse:
+  %n1 = sub i32 %n, 1
+  %f1 = call i32 @fib(i32 %n1)
+  %n2 = sub i32 %n, 2
+  %f2 = call i32 @fib(i32 %n2)
+  %sum = add i32 %f1, %f2
+  ret i32 %sum
+
+done:
+  ret i32 %n
+}
+
+define i32 @sum(i32 %n) {
+entry:
+  %zero = icmp eq i32 %n, 0
+  br i1 %zero, label %done, label %recurse
+
+recurse:
+  %n1 = sub i32 %n, 1
+  %s1 = call i32 @sum(i32 %n1)
+  ; %n must still hold this frame's argument after the recursive call.
+  %s = add i32 %s1, %n
+  ret i32 %s
+
+done:
+  ret i32 0
+}
+
+define i32 @fib_loop(i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %a = phi i32 [ 0, %entry ], [ %b, %loop ]
+  %b = phi i32 [ 1, %entry ], [ %ab, %loop ]
+  %ab = add i32 %a, %b
+  %i.next = add i32 %i, 1
+  %cont = icmp slt i32 %i.next, %n
+  br i1 %cont, label %loop, label %exit
+
+exit:
+  ret i32 %b
+}
+
+define i32 @swap_loop(i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %x = phi i32 [ 1, %entry ], [ %y, %loop ]
+  %y = phi i32 [ 2, %entry ], [ %x, %loop ]
+  %i.next = add i32 %i, 1
+  %cont = icmp slt i32 %i.next, %n
+  br i1 %cont, label %loop, label %exit
+
+exit:
+  %x10 = mul i32 %x, 10
+  %xy = add i32 %x10, %y
+  ret i32 %xy
+}
+
+define i32 @main() {
+entry:
+  %fib = call i32 @fib(i32 15)
+  %fib.ok = icmp eq i32 %fib, 610
+  br i1 %fib.ok, label %check.sum, label %fail
+
+check.sum:
+  %sum = call i32 @sum(i32 100)
+  %sum.ok = icmp eq i32 %sum, 5050
+  br i1 %sum.ok, label %check.fib_loop, label %fail
+
+check.fib_loop:
+  %fib_loop = call i32 @fib_loop(i32 15)
+  %fib_loop.ok = icmp eq i32 %fib_loop, 610
+  br i1 %fib_loop.ok, label %check.swap_loop, label %fail
+
+check.swap_loop:
+  ; After 5 iterations the values have been swapped 4 times.
+  %swap = call i32 @swap_loop(i32 5)
+  %swap.ok = icmp eq i32 %swap, 12
+  br i1 %swap.ok, label %pass, label %fail
+
+pass:
+  ret i32 0
+
+fail:
+  ret i32 1
+}
@@ -0,0 +1,36 @@
+# Each jump only goes out of range once the jump it spans has been relaxed, so
+# relaxation needs one layout pass per jump. Check that only re-checking the
+# jumps that span a relaxed fragment gives the same result as re-checking all
+# of them.
+
+# RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux %s -o %t
+# RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux %s -o %t.full \
+# RUN:   -mc-incremental-relaxation=false
+# RUN: cmp %t %t.full
+# RUN: llvm-objdump -d %t | FileCheck %s
+
+# CHECK:        0: e9 80 00 00 00
+# CHECK:       80: e9 80 00 00 00
+# CHECK:      100: e9 80 00 00 00
+# CHECK:      180: e9 c8 00 00 00
+# CHECK:      24d: c3
+# CHECK:      250: eb fe
+
+	.text
+foo:
+	jmp	.L1
+	.fill	123, 1, 0x90
+	jmp	.L2
+.L1:
+	.fill	123, 1, 0x90
+	jmp	.L3
+.L2:
+	.fill	123, 1, 0x90
+	jmp	.Lfar
+.L3:
+	.fill	200, 1, 0x90
+.Lfar:
+	retq
+	.p2align	4
+1:
+	jmp	1b
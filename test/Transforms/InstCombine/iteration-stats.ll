@@ -0,0 +1,31 @@
+; REQUIRES: asserts
+; RUN: opt < %s -instcombine -disable-output -stats 2>&1 | FileCheck %s --check-prefix=STATS
+; RUN: opt < %s -instcombine -instcombine-max-iterations=1 -disable-output -stats 2>&1 | FileCheck %s --check-prefix=LIMIT
+; RUN: opt < %s -instcombine -instcombine-verify-fixpoint -S | FileCheck %s
+
+; A function that needs no folding is done after one iteration, a function
+; whose folds are all found in the first iteration needs a second one only to
+; confirm the fixpoint.
+
+; STATS: 1 instcombine - Number of functions with one iteration
+; STATS: 1 instcombine - Number of functions with two iterations
+; STATS: 3 instcombine - Number of instruction combining iterations performed
+
+; LIMIT: 2 instcombine - Number of functions with one iteration
+; LIMIT-NOT: Number of functions with two iterations
+; LIMIT: 2 instcombine - Number of instruction combining iterations performed
+
+define i32 @no_fold(i32 %x) {
+; CHECK-LABEL: @no_fold(
+; CHECK-NEXT:    ret i32 [[X:%.*]]
+;
+  ret i32 %x
+}
+
+define i32 @one_fold(i32 %x) {
+; CHECK-LABEL: @one_fold(
+; CHECK-NEXT:    ret i32 [[X:%.*]]
+;
+  %a = add i32 %x, 0
+  ret i32 %a
+}
@@ -0,0 +1,31 @@
+; Check the archive symbol table of bitcode members, both for a module whose
+; symbols can be read from its irsymtab and for one that has no target triple
+; and is read with IRObjectFile instead.
+
+; RUN: llvm-as %s -o %t-symtab.bc
+; RUN: llvm-as %p/../../Object/Inputs/trivial.ll -o %t-notriple.bc
+; RUN: llvm-bcanalyzer -dump %t-symtab.bc | FileCheck --check-prefix=BCA %s
+; RUN: rm -f %t.a
+; RUN: llvm-ar rcs %t.a %t-symtab.bc %t-notriple.bc
+; RUN: llvm-nm -M %t.a | FileCheck %s
+
+; BCA: <SYMTAB_BLOCK
+
+; CHECK:      Archive map
+; CHECK-NEXT: bar in {{.*}}-symtab.bc
+; CHECK-NEXT: foo in {{.*}}-symtab.bc
+; CHECK-NEXT: main in {{.*}}-notriple.bc
+; CHECK-NEXT: var in {{.*}}-notriple.bc
+; CHECK-EMPTY:
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+@foo = global i32 0
+@hidden = internal global i32 0
+@undef = external global i32
+@llvm.used = appending global [1 x i8*] [i8* bitcast (i32* @hidden to i8*)]
+
+define void @bar() {
+  ret void
+}
@@ -0,0 +1,86 @@
+; RUN: llc -O0 %s -o %t.o -filetype=obj
+; RUN: llvm-dwarfdump -statistics -num-threads=1 %t.o > %t.1
+; RUN: llvm-dwarfdump -statistics -num-threads=4 %t.o > %t.4
+; RUN: diff %t.1 %t.4
+; RUN: FileCheck %s --input-file %t.4
+
+; The statistics visit the DIEs of all units, which are extracted on a thread
+; pool. The module has three compile units, each of them with:
+;
+; int GlobalN;
+; int fN(int i) { return i; }
+
+; CHECK: "source functions":3
+; CHECK: "unique source variables":6
+; CHECK: "source variables":6
+; CHECK: "variables with location":6
+
+source_filename = "multi-cu"
+target datalayout = "e-m:o-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.12.0"
+
+@Global1 = global i32 0, align 4, !dbg !0
+@Global2 = global i32 0, align 4, !dbg !3
+@Global3 = global i32 0, align 4, !dbg !6
+
+define i32 @f1(i32 %i) !dbg !20 {
+entry:
+  %i.addr = alloca i32, align 4
+  store i32 %i, i32* %i.addr, align 4
+  call void @llvm.dbg.declare(metadata i32* %i.addr, metadata !23, metadata !DIExpression()), !dbg !24
+  %0 = load i32, i32* %i.addr, align 4, !dbg !24
+  ret i32 %0, !dbg !24
+}
+
+define i32 @f2(i32 %i) !dbg !30 {
+entry:
+  %i.addr = alloca i32, align 4
+  store i32 %i, i32* %i.addr, align 4
+  call void @llvm.dbg.declare(metadata i32* %i.addr, metadata !31, metadata !DIExpression()), !dbg !32
+  %0 = load i32, i32* %i.addr, align 4, !dbg !32
+  ret i32 %0, !dbg !32
+}
+
+define i32 @f3(i32 %i) !dbg !40 {
+entry:
+  %i.addr = alloca i32, align 4
+  store i32 %i, i32* %i.addr, align 4
+  call void @llvm.dbg.declare(metadata i32* %i.addr, metadata !41, metadata !DIExpression()), !dbg !42
+  %0 = load i32, i32* %i.addr, align 4, !dbg !42
+  ret i32 %0, !dbg !42
+}
+
+declare void @llvm.dbg.declare(metadata, metadata, metadata)
+
+!llvm.dbg.cu = !{!10, !11, !12}
+!llvm.module.flags = !{!50, !51}
+
+!0 = !DIGlobalVariableExpression(var: !1, expr: !DIExpression())
+!1 = distinct !DIGlobalVariable(name: "Global1", scope: !10, file: !13, line: 1, type: !9, isLocal: false, isDefinition: true)
+!3 = !DIGlobalVariableExpression(var: !4, expr: !DIExpression())
+!4 = distinct !DIGlobalVariable(name: "Global2", scope: !11, file: !14, line: 1, type: !9, isLocal: false, isDefinition: true)
+!6 = !DIGlobalVariableExpression(var: !7, expr: !DIExpression())
+!7 = distinct !DIGlobalVariable(name: "Global3", scope: !12, file: !15, line: 1, type: !9, isLocal: false, isDefinition: true)
+!8 = !{}
+!9 = !DIBasicType(name: "int", size: 32, encoding: DW_ATE_signed)
+!10 = distinct !DICompileUnit(language: DW_LANG_C99, file: !13, isOptimized: false, runtimeVersion: 0, emissionKind: FullDebug, globals: !16)
+!11 = distinct !DICompileUnit(language: DW_LANG_C99, file: !14, isOptimized: false, runtimeVersion: 0, emissionKind: FullDebug, globals: !17)
+!12 = distinct !DICompileUnit(language: DW_LANG_C99, file: !15, isOptimized: false, runtimeVersion: 0, emissionKind: FullDebug, globals: !18)
+!13 = !DIFile(filename: "/tmp/one.c", directory: "/tmp")
+!14 = !DIFile(filename: "/tmp/two.c", directory: "/tmp")
+!15 = !DIFile(filename: "/tmp/three.c", directory: "/tmp")
+!16 = !{!0}
+!17 = !{!3}
+!18 = !{!6}
+!19 = !DISubroutineType(types: !{!9, !9})
+!20 = distinct !DISubprogram(name: "f1", scope: !13, file: !13, line: 2, type: !19, isLocal: false, isDefinition: true, scopeLine: 2, flags: DIFlagPrototyped, isOptimized: false, unit: !10, retainedNodes: !8)
+!23 = !DILocalVariable(name: "i", arg: 1, scope: !20, file: !13, line: 2, type: !9)
+!24 = !DILocation(line: 2, column: 17, scope: !20)
+!30 = distinct !DISubprogram(name: "f2", scope: !14, file: !14, line: 2, type: !19, isLocal: false, isDefinition: true, scopeLine: 2, flags: DIFlagPrototyped, isOptimized: false, unit: !11, retainedNodes: !8)
+!31 = !DILocalVariable(name: "i", arg: 1, scope: !30, file: !14, line: 2, type: !9)
+!32 = !DILocation(line: 2, column: 17, scope: !30)
+!40 = distinct !DISubprogram(name: "f3", scope: !15, file: !15, line: 2, type: !19, isLocal: false, isDefinition: true, scopeLine: 2, flags: DIFlagPrototyped, isOptimized: false, unit: !12, retainedNodes: !8)
+!41 = !DILocalVariable(name: "i", arg: 1, scope: !40, file: !15, line: 2, type: !9)
+!42 = !DILocation(line: 2, column: 17, scope: !40)
+!50 = !{i32 2, !"Dwarf Version", i32 4}
+!51 = !{i32 2, !"Debug Info Version", i32 3}
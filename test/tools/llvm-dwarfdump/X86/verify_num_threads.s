@@ -0,0 +1,62 @@
+# RUN: llvm-mc %s -filetype obj -triple x86_64-unknown-linux -o %t.o
+# RUN: not llvm-dwarfdump -verify -num-threads=1 %t.o > %t.1.out 2> %t.1.err
+# RUN: not llvm-dwarfdump -verify -num-threads=4 %t.o > %t.4.out 2> %t.4.err
+# RUN: diff %t.1.out %t.4.out
+# RUN: diff %t.1.err %t.4.err
+# RUN: FileCheck %s --input-file %t.4.out
+# RUN: FileCheck %s --input-file %t.4.err --check-prefix=DIAG
+
+# RUN: llvm-dwarfdump -statistics -num-threads=4 %t.o 2> %t.stats.err
+# RUN: FileCheck %s --input-file %t.stats.err --check-prefix=DIAG
+
+# The DIEs of these units are extracted on worker threads. Each unit has a
+# bad DW_AT_stmt_list, which the verifier reports, and a bad
+# DW_AT_rnglists_base, which is diagnosed while its DIEs are extracted. Both
+# must come out in unit order, as when the units are verified serially.
+
+# CHECK: error: DW_AT_stmt_list offset is beyond .debug_line bounds: 0x00000010
+# CHECK: error: DW_AT_stmt_list offset is beyond .debug_line bounds: 0x00000020
+# CHECK: error: DW_AT_stmt_list offset is beyond .debug_line bounds: 0x00000030
+# CHECK: error: DW_AT_stmt_list offset is beyond .debug_line bounds: 0x00000040
+# CHECK: error: DW_AT_stmt_list offset is beyond .debug_line bounds: 0x00000050
+# CHECK: error: DW_AT_stmt_list offset is beyond .debug_line bounds: 0x00000060
+# CHECK: error: DW_AT_stmt_list offset is beyond .debug_line bounds: 0x00000070
+# CHECK: error: DW_AT_stmt_list offset is beyond .debug_line bounds: 0x00000080
+# CHECK-NOT: error:
+# CHECK: Errors detected.
+
+# DIAG: error: parsing a range list table: {{.*}} at offset 0x4{{$}}
+# DIAG-NEXT: error: parsing a range list table: {{.*}} at offset 0x14{{$}}
+# DIAG-NEXT: error: parsing a range list table: {{.*}} at offset 0x24{{$}}
+# DIAG-NEXT: error: parsing a range list table: {{.*}} at offset 0x34{{$}}
+# DIAG-NEXT: error: parsing a range list table: {{.*}} at offset 0x44{{$}}
+# DIAG-NEXT: error: parsing a range list table: {{.*}} at offset 0x54{{$}}
+# DIAG-NEXT: error: parsing a range list table: {{.*}} at offset 0x64{{$}}
+# DIAG-NEXT: error: parsing a range list table: {{.*}} at offset 0x74{{$}}
+
+        .section .debug_abbrev,"",@progbits
+        .byte 0x01  # Abbrev code
+        .byte 0x11  # DW_TAG_compile_unit
+        .byte 0x00  # DW_CHILDREN_no
+        .byte 0x74  # DW_AT_rnglists_base
+        .byte 0x17  # DW_FORM_sec_offset
+        .byte 0x10  # DW_AT_stmt_list
+        .byte 0x17  # DW_FORM_sec_offset
+        .byte 0x00  # EOM(1)
+        .byte 0x00  # EOM(2)
+        .byte 0x00  # EOM(3)
+
+        .section .debug_info,"",@progbits
+        .irp base,0x10,0x20,0x30,0x40,0x50,0x60,0x70,0x80
+        .long 17               # Length of Unit
+        .short 5               # DWARF version number
+        .byte 1                # DWARF Unit Type
+        .byte 4                # Address Size (in bytes)
+        .long .debug_abbrev    # Offset Into Abbrev. Section
+        .byte 1                # Abbreviation code
+        .long \base            # DW_AT_rnglists_base
+        .long \base            # DW_AT_stmt_list
+        .endr
+
+        .section .debug_rnglists,"",@progbits
+        .long 0
@@ -0,0 +1,89 @@
+# RUN: llvm-mca -mtriple=x86_64-unknown-unknown -mcpu=btver2 -resource-pressure=false -instruction-info=false -num-threads=3 %s %s | FileCheck --check-prefix=TEXT %s
+# RUN: llvm-mca -mtriple=x86_64-unknown-unknown -mcpu=btver2 -json -j=2 %s | FileCheck --check-prefix=JSON %s
+# RUN: not llvm-mca -mtriple=x86_64-unknown-unknown -mcpu=btver2 -json -instruction-tables %s 2>&1 | FileCheck --check-prefix=TABLES %s
+
+# LLVM-MCA-BEGIN dependencies
+  imul %eax, %eax
+  imul %eax, %eax
+# LLVM-MCA-END
+
+# LLVM-MCA-BEGIN throughput
+  add %edi, %esi
+  add %ecx, %edx
+  add %r8d, %r9d
+# LLVM-MCA-END
+
+# LLVM-MCA-BEGIN divider
+  vdivps %ymm0, %ymm1, %ymm2
+# LLVM-MCA-END
+
+# Regions are reported in order, and files are named when there are several.
+
+# TEXT:      {{.*}}batch-mode.s:
+# TEXT:      [0] Code Region - dependencies
+# TEXT:      Total Cycles:      603
+# TEXT:      [1] Code Region - throughput
+# TEXT:      Total Cycles:      153
+# TEXT:      [2] Code Region - divider
+# TEXT:      Total Cycles:      3803
+# TEXT:      {{.*}}batch-mode.s:
+# TEXT:      [0] Code Region - dependencies
+# TEXT:      Total Cycles:      603
+# TEXT:      [1] Code Region - throughput
+# TEXT:      Total Cycles:      153
+# TEXT:      [2] Code Region - divider
+# TEXT:      Total Cycles:      3803
+
+# JSON:      "cpu": "btver2",
+# JSON-NEXT: "regions": [
+
+# JSON:      "bottlenecks": [
+# JSON-NEXT:   "dependencies"
+# JSON-NEXT: ],
+# JSON-NEXT: "cycles": 603,
+# JSON-NEXT: "description": "dependencies",
+# JSON:      "ipc": 0.33{{[0-9]*}},
+# JSON-NEXT: "iterations": 100,
+# JSON-NEXT: "region": 0,
+# JSON:      "JALU1": 2,
+# JSON:      "JMul": 2,
+
+# JSON:      "block_rthroughput": 1.5,
+# JSON-NEXT: "bottlenecks": [
+# JSON-NEXT:   "dispatch",
+# JSON-NEXT:   "resource:JALU0"
+# JSON-NEXT: ],
+# JSON-NEXT: "cycles": 153,
+# JSON-NEXT: "description": "throughput",
+# JSON-NEXT: "dispatch_stalls": {
+# JSON-NEXT:   "GROUP": 0,
+# JSON-NEXT:   "LQ": 0,
+# JSON-NEXT:   "RAT": 0,
+# JSON-NEXT:   "RCU": 0,
+# JSON-NEXT:   "SCHEDQ": 0,
+# JSON-NEXT:   "SQ": 0
+# JSON-NEXT: },
+# JSON-NEXT: "dispatch_width": 2,
+# JSON-NEXT: "file": "{{.*}}batch-mode.s",
+# JSON-NEXT: "instructions": 300,
+# JSON-NEXT: "ipc": 1.96,
+# JSON-NEXT: "iterations": 100,
+# JSON-NEXT: "region": 1,
+# JSON-NEXT: "resource_pressure": {
+# JSON-NEXT:   "JALU0": 1.5,
+# JSON-NEXT:   "JALU1": 1.5,
+
+# JSON:      "block_rthroughput": 38,
+# JSON-NEXT: "bottlenecks": [
+# JSON-NEXT:   "resource:JFPM"
+# JSON-NEXT: ],
+# JSON-NEXT: "cycles": 3803,
+# JSON-NEXT: "description": "divider",
+# JSON:      "SCHEDQ": 2980,
+# JSON:      "region": 2,
+# JSON:      "JFPM": 38,
+# JSON:      "uops_per_iteration": 2
+
+# JSON:      "triple": "x86_64-unknown-unknown"
+
+# TABLES: error: -json is not supported with -instruction-tables.
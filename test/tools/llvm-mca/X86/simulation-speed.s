@@ -0,0 +1,13 @@
+# RUN: llvm-mca -mtriple=x86_64-unknown-unknown -mcpu=btver2 -iterations=100 -print-simulation-speed -o /dev/null %s 2>&1 | FileCheck %s
+
+# LLVM-MCA-BEGIN add
+  add %edi, %esi
+# LLVM-MCA-END
+
+# LLVM-MCA-BEGIN imul
+  imul %eax, %eax
+# LLVM-MCA-END
+
+# CHECK:      {{.*}}simulation-speed.s [0]: simulated 103 cycles in {{[0-9.]+}}s
+# CHECK-NEXT: {{.*}}simulation-speed.s [1]: simulated 303 cycles in {{[0-9.]+}}s
+# CHECK-NEXT: total: simulated 406 cycles in {{[0-9.]+}}s
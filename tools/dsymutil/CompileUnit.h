@@ -81,9 +81,7 @@ public:
               StringRef ClangModuleName)
       : OrigUnit(OrigUnit), ID(ID), Ranges(RangeAlloc),
         ClangModuleName(ClangModuleName) {
-    Info.resize(OrigUnit.getNumDIEs());
-
-    auto CUDie = OrigUnit.getUnitDIE(false);
+    auto CUDie = OrigUnit.getUnitDIE();
     if (!CUDie) {
       HasODR = false;
       return;
@@ -117,6 +115,11 @@ public:
   bool isClangModule() const { return !ClangModuleName.empty(); }
   const std::string &getClangModuleName() const { return ClangModuleName; }
 
+  /// Extract all the DIEs of the original unit and allocate their info. The
+  /// constructor only reads the unit DIE, so this must be called before the
+  /// DIEs are analyzed.
+  void extractDIEs() { Info.resize(OrigUnit.getNumDIEs()); }
+
   DIEInfo &getInfo(unsigned Idx) { return Info[Idx]; }
   const DIEInfo &getInfo(unsigned Idx) const { return Info[Idx]; }
 
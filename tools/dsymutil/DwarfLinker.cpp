@@ -2192,6 +2192,7 @@ Error DwarfLinker::loadClangModule(StringRef Filename, StringRef ModulePath,
       // Add this module.
       Unit = llvm::make_unique<CompileUnit>(*CU, UnitID++, !Options.NoODR,
                                             ModuleName);
+      Unit->extractDIEs();
       Unit->setHasInterestingContent();
       analyzeContextInfo(CUDie, 0, *Unit, &ODRContexts.getRoot(),
                          UniquingStringPool, ODRContexts);
@@ -2458,7 +2459,9 @@ bool DwarfLinker::link(const DebugMap &Map) {
 
     for (const auto &CU : LinkContext.DwarfContext->compile_units()) {
       updateDwarfVersion(CU->getVersion());
-      auto CUDie = CU->getUnitDIE(false);
+      // Only read the unit DIE here, the other DIEs are extracted in the
+      // analysis phase below, possibly ahead of time by the extract threads.
+      auto CUDie = CU->getUnitDIE();
       if (Options.Verbose) {
         outs() << "Input compilation unit:";
         DIDumpOptions DumpOpts;
@@ -2487,11 +2490,39 @@ bool DwarfLinker::link(const DebugMap &Map) {
   std::condition_variable ProcessedFilesConditionVariable;
   BitVector ProcessedFiles(NumObjects, false);
 
+  // Parsing the DIEs of an object file only touches its own DWARFContext, so
+  // the threads not used by the analysis and cloning below parse the DIEs of
+  // the next few object files ahead of the analysis. The look-ahead is bounded
+  // to limit the number of object files whose DIEs are in memory at once.
+  const unsigned NumExtractThreads =
+      Options.Threads > 2 ? Options.Threads - 2 : 0;
+  const unsigned ExtractWindow = 2 * NumExtractThreads;
+  std::vector<std::shared_future<void>> DIEsExtracted(NumObjects);
+  std::unique_ptr<ThreadPool> ExtractPool;
+  if (NumExtractThreads)
+    ExtractPool = llvm::make_unique<ThreadPool>(NumExtractThreads);
+  auto ExtractDIEs = [&](unsigned i) {
+    if (!ExtractPool || i >= NumObjects || !ObjectContexts[i].ObjectFile)
+      return;
+    LinkContext &LC = ObjectContexts[i];
+    DIEsExtracted[i] = ExtractPool->async([&LC]() {
+      for (auto &CurrentUnit : LC.CompileUnits)
+        CurrentUnit->extractDIEs();
+    });
+  };
+
   // Now do analyzeContextInfo in parallel as it is particularly expensive.
   auto AnalyzeLambda = [&]() {
+    for (unsigned i = 0; i < ExtractWindow; ++i)
+      ExtractDIEs(i);
+
     for (unsigned i = 0, e = NumObjects; i != e; ++i) {
       auto &LinkContext = ObjectContexts[i];
 
+      ExtractDIEs(i + ExtractWindow);
+      if (DIEsExtracted[i].valid())
+        DIEsExtracted[i].wait();
+
       if (!LinkContext.ObjectFile) {
         std::unique_lock<std::mutex> LockGuard(ProcessedFilesMutex);
         ProcessedFiles.set(i);
@@ -2501,6 +2532,7 @@ bool DwarfLinker::link(const DebugMap &Map) {
 
       // Now build the DIE parent links that we will use during the next phase.
       for (auto &CurrentUnit : LinkContext.CompileUnits) {
+        CurrentUnit->extractDIEs();
         auto CUDie = CurrentUnit->getOrigUnit().getUnitDIE();
         if (!CUDie)
           continue;
@@ -28,6 +28,7 @@
 #include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
 #include "llvm/ExecutionEngine/Orc/LLJIT.h"
 #include "llvm/ExecutionEngine/Orc/OrcRemoteTargetClient.h"
+#include "llvm/ExecutionEngine/Orc/PersistentObjectCache.h"
 #include "llvm/ExecutionEngine/OrcMCJITReplacement.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
 #include "llvm/IR/IRBuilder.h"
@@ -72,7 +73,7 @@ using namespace llvm;
 
 namespace {
 
-  enum class JITKind { MCJIT, OrcMCJITReplacement, OrcLazy };
+  enum class JITKind { MCJIT, OrcMCJITReplacement, Orc, OrcLazy };
 
   cl::opt<std::string>
   InputFile(cl::desc("<input bitcode>"), cl::Positional, cl::init("-"));
@@ -93,6 +94,9 @@ namespace {
                                 clEnumValN(JITKind::OrcMCJITReplacement,
                                            "orc-mcjit",
                                            "Orc-based MCJIT replacement"),
+                                clEnumValN(JITKind::Orc,
+                                           "orc",
+                                           "Orc-based JIT (LLJIT)."),
                                 clEnumValN(JITKind::OrcLazy,
                                            "orc-lazy",
                                            "Orc-based lazy JIT.")));
@@ -186,6 +190,24 @@ namespace {
     DumpModsToDisk
   };
 
+  cl::opt<unsigned> CompileThreads(
+      "compile-threads",
+      cl::desc("Compile modules on this many threads, each module in its own "
+               "context (orc only)"),
+      cl::value_desc("N"), cl::init(0));
+
+  cl::opt<unsigned> OrcSpeculationBudget(
+      "orc-lazy-speculate",
+      cl::desc("Compile up to this many functions in the background before "
+               "their first call (orc-lazy only)"),
+      cl::value_desc("N"), cl::init(0));
+
+  cl::opt<bool> OrcSpeculationWait(
+      "orc-lazy-speculate-wait",
+      cl::desc("Run main only once the background compiles started by the "
+               "static constructors are done (orc-lazy only)"),
+      cl::init(false));
+
   cl::opt<DumpKind> OrcDumpKind(
       "orc-lazy-debug", cl::desc("Debug dumping for the orc-lazy JIT."),
       cl::init(DumpKind::NoDump),
@@ -337,6 +359,8 @@ static void reportError(SMDiagnostic Err, const char *ProgName) {
   exit(1);
 }
 
+int runOrcJIT(std::vector<std::unique_ptr<Module>> Ms,
+              const std::vector<std::string> &Args);
 int runOrcLazyJIT(LLVMContext &Ctx, std::vector<std::unique_ptr<Module>> Ms,
                   const std::vector<std::string> &Args);
 
@@ -371,11 +395,19 @@ int main(int argc, char **argv, char * const *envp) {
   if (!Mod)
     reportError(Err, argv[0]);
 
-  if (UseJITKind == JITKind::OrcLazy) {
+  if (UseJITKind == JITKind::Orc || UseJITKind == JITKind::OrcLazy) {
+    // The orc JIT may compile modules concurrently, so each extra module gets
+    // a context of its own. The orc-lazy JIT needs them all in one context.
+    std::vector<std::unique_ptr<LLVMContext>> ExtraContexts;
     std::vector<std::unique_ptr<Module>> Ms;
     Ms.push_back(std::move(Owner));
     for (auto &ExtraMod : ExtraModules) {
-      Ms.push_back(parseIRFile(ExtraMod, Err, Context));
+      LLVMContext *ExtraContext = &Context;
+      if (UseJITKind == JITKind::Orc) {
+        ExtraContexts.push_back(llvm::make_unique<LLVMContext>());
+        ExtraContext = ExtraContexts.back().get();
+      }
+      Ms.push_back(parseIRFile(ExtraMod, Err, *ExtraContext));
       if (!Ms.back())
         reportError(Err, argv[0]);
     }
@@ -383,6 +415,8 @@ int main(int argc, char **argv, char * const *envp) {
     Args.push_back(InputFile);
     for (auto &Arg : InputArgv)
       Args.push_back(Arg);
+    if (UseJITKind == JITKind::Orc)
+      return runOrcJIT(std::move(Ms), Args);
     return runOrcLazyJIT(Context, std::move(Ms), Args);
   }
 
@@ -736,6 +770,99 @@ static orc::IRTransformLayer2::TransformFunction createDebugDumper() {
   llvm_unreachable("Unknown DumpKind");
 }
 
+static orc::JITTargetMachineBuilder
+getJITTargetMachineBuilder(const std::string &TT) {
+  orc::JITTargetMachineBuilder TMD =
+      TT.empty() ? ExitOnErr(orc::JITTargetMachineBuilder::detectHost())
+                 : orc::JITTargetMachineBuilder(Triple(TT));
+
+  TMD.setArch(MArch)
+      .setCPU(getCPUStr())
+      .addFeatures(getFeatureList())
+      .setRelocationModel(RelocModel.getNumOccurrences()
+                              ? Optional<Reloc::Model>(RelocModel)
+                              : None)
+      .setCodeModel(CMModel.getNumOccurrences()
+                        ? Optional<CodeModel::Model>(CMModel)
+                        : None);
+  return TMD;
+}
+
+static int runMain(orc::LLJIT &J, const std::vector<std::string> &Args,
+                   std::function<void()> AfterConstructors = nullptr) {
+  orc::MangleAndInterner Mangle(J.getExecutionSession(), J.getDataLayout());
+  orc::LocalCXXRuntimeOverrides2 CXXRuntimeOverrides;
+  ExitOnErr(CXXRuntimeOverrides.enable(J.getMainVSO(), Mangle));
+
+  ExitOnErr(J.runConstructors());
+  if (AfterConstructors)
+    AfterConstructors();
+
+  auto MainSym = ExitOnErr(J.lookup("main"));
+  typedef int (*MainFnPtr)(int, const char *[]);
+  std::vector<const char *> ArgV;
+  for (auto &Arg : Args)
+    ArgV.push_back(Arg.c_str());
+  auto Main =
+      reinterpret_cast<MainFnPtr>(static_cast<uintptr_t>(MainSym.getAddress()));
+  auto Result = Main(ArgV.size(), (const char **)ArgV.data());
+
+  ExitOnErr(J.runDestructors());
+
+  CXXRuntimeOverrides.runDestructors();
+
+  return Result;
+}
+
+int runOrcJIT(std::vector<std::unique_ptr<Module>> Ms,
+              const std::vector<std::string> &Args) {
+  // Bail out early if no modules loaded.
+  if (Ms.empty())
+    return 0;
+
+  // Add lli's symbols into the JIT's search space.
+  std::string ErrMsg;
+  sys::DynamicLibrary LibLLI =
+      sys::DynamicLibrary::getPermanentLibrary(nullptr, &ErrMsg);
+  if (!LibLLI.isValid()) {
+    errs() << "Error loading lli symbols: " << ErrMsg << ".\n";
+    return 1;
+  }
+
+  auto TMD = getJITTargetMachineBuilder(Ms.front()->getTargetTriple());
+  auto TM = ExitOnErr(TMD.createTargetMachine());
+  auto DL = TM->createDataLayout();
+
+  std::unique_ptr<orc::PersistentObjectCache> ObjCache;
+  if (EnableCacheManager) {
+    if (ObjectCacheDir.empty()) {
+      errs() << "-enable-cache-manager requires -object-cache-dir with the "
+                "orc JIT.\n";
+      return 1;
+    }
+    ObjCache =
+        ExitOnErr(orc::PersistentObjectCache::Create(ObjectCacheDir, *TM));
+  }
+
+  auto ES = llvm::make_unique<orc::ExecutionSession>();
+  auto J = ExitOnErr(orc::LLJIT::Create(std::move(ES), std::move(TMD), DL,
+                                        CompileThreads));
+  if (ObjCache)
+    J->setObjectCache(ObjCache.get());
+
+  J->getMainVSO().setFallbackDefinitionGenerator(
+      orc::DynamicLibraryFallbackGenerator(
+          std::move(LibLLI), DL, [](orc::SymbolStringPtr) { return true; }));
+
+  // Static constructors are looked up by name, so they must not be internal.
+  for (auto &M : Ms) {
+    orc::makeAllSymbolsExternallyAccessible(*M);
+    ExitOnErr(J->addIRModule(std::move(M)));
+  }
+
+  return runMain(*J, Args);
+}
+
 int runOrcLazyJIT(LLVMContext &Ctx, std::vector<std::unique_ptr<Module>> Ms,
                   const std::vector<std::string> &Args) {
   // Bail out early if no modules loaded.
@@ -751,25 +878,28 @@ int runOrcLazyJIT(LLVMContext &Ctx, std::vector<std::unique_ptr<Module>> Ms,
     return 1;
   }
 
-  const auto &TT = Ms.front()->getTargetTriple();
-  orc::JITTargetMachineBuilder TMD =
-      TT.empty() ? ExitOnErr(orc::JITTargetMachineBuilder::detectHost())
-                 : orc::JITTargetMachineBuilder(Triple(TT));
-
-  TMD.setArch(MArch)
-      .setCPU(getCPUStr())
-      .addFeatures(getFeatureList())
-      .setRelocationModel(RelocModel.getNumOccurrences()
-                              ? Optional<Reloc::Model>(RelocModel)
-                              : None)
-      .setCodeModel(CMModel.getNumOccurrences()
-                        ? Optional<CodeModel::Model>(CMModel)
-                        : None);
+  auto TMD = getJITTargetMachineBuilder(Ms.front()->getTargetTriple());
   auto TM = ExitOnErr(TMD.createTargetMachine());
   auto DL = TM->createDataLayout();
+
+  std::unique_ptr<orc::PersistentObjectCache> ObjCache;
+  if (EnableCacheManager) {
+    if (ObjectCacheDir.empty()) {
+      errs() << "-enable-cache-manager requires -object-cache-dir with the "
+                "orc-lazy JIT.\n";
+      return 1;
+    }
+    ObjCache =
+        ExitOnErr(orc::PersistentObjectCache::Create(ObjectCacheDir, *TM));
+  }
+
   auto ES = llvm::make_unique<orc::ExecutionSession>();
   auto J =
       ExitOnErr(orc::LLLazyJIT::Create(std::move(ES), std::move(TM), DL, Ctx));
+  if (OrcSpeculationBudget)
+    J->enableSpeculation(OrcSpeculationBudget);
+  if (ObjCache)
+    J->setObjectCache(ObjCache.get());
 
   auto Dump = createDebugDumper();
 
@@ -785,31 +915,15 @@ int runOrcLazyJIT(LLVMContext &Ctx, std::vector<std::unique_ptr<Module>> Ms,
       orc::DynamicLibraryFallbackGenerator(
           std::move(LibLLI), DL, [](orc::SymbolStringPtr) { return true; }));
 
-  orc::MangleAndInterner Mangle(J->getExecutionSession(), DL);
-  orc::LocalCXXRuntimeOverrides2 CXXRuntimeOverrides;
-  ExitOnErr(CXXRuntimeOverrides.enable(J->getMainVSO(), Mangle));
-
   for (auto &M : Ms) {
     orc::makeAllSymbolsExternallyAccessible(*M);
     ExitOnErr(J->addLazyIRModule(std::move(M)));
   }
 
-  ExitOnErr(J->runConstructors());
-
-  auto MainSym = ExitOnErr(J->lookup("main"));
-  typedef int (*MainFnPtr)(int, const char *[]);
-  std::vector<const char *> ArgV;
-  for (auto &Arg : Args)
-    ArgV.push_back(Arg.c_str());
-  auto Main =
-      reinterpret_cast<MainFnPtr>(static_cast<uintptr_t>(MainSym.getAddress()));
-  auto Result = Main(ArgV.size(), (const char **)ArgV.data());
-
-  ExitOnErr(J->runDestructors());
-
-  CXXRuntimeOverrides.runDestructors();
-
-  return Result;
+  return runMain(*J, Args, [&]() {
+    if (OrcSpeculationWait)
+      J->waitForSpeculation();
+  });
 }
 
 std::unique_ptr<FDRawChannel> launchRemote() {
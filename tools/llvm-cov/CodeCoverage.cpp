@@ -96,7 +96,9 @@ private:
   createSourceFileView(StringRef SourceFile, const CoverageMapping &Coverage);
 
   /// Load the coverage mapping data. Return nullptr if an error occurred.
-  std::unique_ptr<CoverageMapping> load();
+  /// If \p OnlySourceFiles is true, only the functions that are needed to
+  /// report on the source files given on the command line are loaded.
+  std::unique_ptr<CoverageMapping> load(bool OnlySourceFiles = false);
 
   /// Create a mapping from files in the Coverage data to local copies
   /// (path-equivalence).
@@ -345,13 +347,58 @@ static bool modifiedTimeGT(StringRef LHS, StringRef RHS) {
   return LHSTime > RHSTime;
 }
 
-std::unique_ptr<CoverageMapping> CodeCoverageTool::load() {
+/// Convert a remapping path to a native path with a trailing separator.
+static std::string nativeWithTrailingSeparator(StringRef Path) {
+  if (Path.empty())
+    return "";
+  SmallString<128> NativePath;
+  sys::path::native(Path, NativePath);
+  if (!sys::path::is_separator(NativePath.back()))
+    NativePath += sys::path::get_separator();
+  return NativePath.c_str();
+}
+
+std::unique_ptr<CoverageMapping> CodeCoverageTool::load(bool OnlySourceFiles) {
   for (StringRef ObjectFilename : ObjectFilenames)
     if (modifiedTimeGT(ObjectFilename, PGOFilename))
       warning("profile data may be out of date - object is newer",
               ObjectFilename);
-  auto CoverageOrErr =
-      CoverageMapping::load(ObjectFilenames, PGOFilename, CoverageArches);
+  CoverageLoadOptions Options;
+  Options.NumThreads = ViewOpts.NumThreads;
+  // With -path-equivalence, the source files are local paths. Map them back
+  // to the paths in the coverage data too, in native and in slash form.
+  std::vector<std::string> CoverageFiles;
+  std::vector<StringRef> Files;
+  if (OnlySourceFiles && !SourceFiles.empty()) {
+    std::string RemapFrom, RemapTo;
+    if (PathRemapping) {
+      RemapFrom = nativeWithTrailingSeparator(PathRemapping->first);
+      RemapTo = nativeWithTrailingSeparator(PathRemapping->second);
+    }
+    for (const std::string &SF : SourceFiles) {
+      CoverageFiles.push_back(SF);
+      SmallString<128> NativeFilename;
+      sys::path::native(SF, NativeFilename);
+      if (!PathRemapping || !NativeFilename.startswith(RemapTo))
+        continue;
+      std::string CovFilename =
+          RemapFrom + NativeFilename.substr(RemapTo.size()).str();
+      CoverageFiles.push_back(sys::path::convert_to_slash(CovFilename));
+      CoverageFiles.push_back(std::move(CovFilename));
+    }
+    Files.assign(CoverageFiles.begin(), CoverageFiles.end());
+    Options.Files = Files;
+  }
+  auto CoverageOrErr = CoverageMapping::load(ObjectFilenames, PGOFilename,
+                                             CoverageArches, Options);
+  // If none of the source files is covered, every file gets reported on, so
+  // everything has to be loaded after all.
+  if (CoverageOrErr && !Files.empty() &&
+      (*CoverageOrErr)->getUniqueSourceFiles().empty()) {
+    Options.Files = None;
+    CoverageOrErr = CoverageMapping::load(ObjectFilenames, PGOFilename,
+                                          CoverageArches, Options);
+  }
   if (Error E = CoverageOrErr.takeError()) {
     error("Failed to load coverage: " + toString(std::move(E)),
           join(ObjectFilenames.begin(), ObjectFilenames.end(), ", "));
@@ -391,18 +438,8 @@ void CodeCoverageTool::remapPathNames(const CoverageMapping &Coverage) {
   if (!PathRemapping)
     return;
 
-  // Convert remapping paths to native paths with trailing seperators.
-  auto nativeWithTrailing = [](StringRef Path) -> std::string {
-    if (Path.empty())
-      return "";
-    SmallString<128> NativePath;
-    sys::path::native(Path, NativePath);
-    if (!sys::path::is_separator(NativePath.back()))
-      NativePath += sys::path::get_separator();
-    return NativePath.c_str();
-  };
-  std::string RemapFrom = nativeWithTrailing(PathRemapping->first);
-  std::string RemapTo = nativeWithTrailing(PathRemapping->second);
+  std::string RemapFrom = nativeWithTrailingSeparator(PathRemapping->first);
+  std::string RemapTo = nativeWithTrailingSeparator(PathRemapping->second);
 
   // Create a mapping from coverage data file paths to local paths.
   for (StringRef Filename : Coverage.getUniqueSourceFiles()) {
@@ -868,7 +905,7 @@ int CodeCoverageTool::doShow(int argc, const char **argv,
                                 ? "Created: " + ModifiedTimeStr.substr(0, found)
                                 : "Created: " + ModifiedTimeStr;
 
-  auto Coverage = load();
+  auto Coverage = load(/*OnlySourceFiles=*/true);
   if (!Coverage)
     return 1;
 
@@ -971,7 +1008,7 @@ int CodeCoverageTool::doReport(int argc, const char **argv,
     return 1;
   }
 
-  auto Coverage = load();
+  auto Coverage = load(/*OnlySourceFiles=*/true);
   if (!Coverage)
     return 1;
 
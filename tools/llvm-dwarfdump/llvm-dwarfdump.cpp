@@ -207,6 +207,11 @@ static cl::opt<bool>
     Statistics("statistics",
                cl::desc("Emit JSON-formatted debug info quality metrics."),
                cat(DwarfDumpCategory));
+static opt<unsigned>
+    NumThreads("num-threads",
+               desc("Number of threads to parse the DIEs with for -verify "
+                    "and -statistics (0 = one per hardware thread)."),
+               init(0), cat(DwarfDumpCategory));
 static opt<bool> Verify("verify", desc("Verify the DWARF debug info."),
                         cat(DwarfDumpCategory));
 static opt<bool> Quiet("quiet", desc("Use with -verify to not emit to STDOUT."),
@@ -240,6 +245,7 @@ static DIDumpOptions getDumpOpts() {
   DumpOpts.ShowForm = ShowForm;
   DumpOpts.SummarizeTypes = SummarizeTypes;
   DumpOpts.Verbose = Verbose;
+  DumpOpts.NumThreads = NumThreads;
   // In -verify mode, print DIEs without children in error messages.
   if (Verify)
     return DumpOpts.noImplicitRecursion();
@@ -425,6 +431,16 @@ static bool dumpObjectFile(ObjectFile &Obj, DWARFContext &DICtx, Twine Filename,
   return true;
 }
 
+static bool collectStats(ObjectFile &Obj, DWARFContext &DICtx, Twine Filename,
+                         raw_ostream &OS) {
+  // The statistics visit every DIE of every compile unit.
+  std::vector<DWARFUnit *> Units;
+  for (const auto &CU : DICtx.compile_units())
+    Units.push_back(CU.get());
+  DWARFContext::parseUnitDIEs(Units, NumThreads);
+  return collectStatsForObjectFile(Obj, DICtx, Filename, OS);
+}
+
 static bool verifyObjectFile(ObjectFile &Obj, DWARFContext &DICtx,
                              Twine Filename, raw_ostream &OS) {
   // Verify the DWARF and exit with non-zero exit status if verification
@@ -617,7 +633,7 @@ int main(int argc, char **argv) {
       exit(1);
   } else if (Statistics)
     for (auto Object : Objects)
-      handleFile(Object, collectStatsForObjectFile, OS);
+      handleFile(Object, collectStats, OS);
   else
     for (auto Object : Objects)
       handleFile(Object, dumpObjectFile, OS);
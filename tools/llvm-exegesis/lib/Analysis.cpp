@@ -12,6 +12,8 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/MC/MCAsmInfo.h"
 #include "llvm/Support/FormatVariadic.h"
+#include <cmath>
+#include <map>
 #include <unordered_set>
 #include <vector>
 
@@ -393,6 +395,35 @@ void Analysis::SchedClassCluster::addPoint(
   assert(ClusterId == Clustering.getClusterIdForPoint(PointId));
 }
 
+// Returns the latency of the sched class, i.e. the latency of its slowest
+// write.
+static double getSchedClassLatency(const llvm::MCSubtargetInfo &STI,
+                                   const llvm::MCSchedClassDesc &SCDesc) {
+  double Latency = 0.0;
+  for (unsigned I = 0; I < SCDesc.NumWriteLatencyEntries; ++I) {
+    const llvm::MCWriteLatencyEntry *const WLE =
+        STI.getWriteLatencyEntry(&SCDesc, I);
+    Latency = std::max<double>(Latency, WLE->Cycles);
+  }
+  return Latency;
+}
+
+// Returns the pressure on ProcResIdx in the given (sparse) pressure
+// distribution.
+static double getProcResPressure(
+    const std::vector<std::pair<uint16_t, float>> &IdealizedProcResPressure,
+    uint16_t ProcResIdx) {
+  const auto ProcResPressureIt =
+      std::find_if(IdealizedProcResPressure.begin(),
+                   IdealizedProcResPressure.end(),
+                   [ProcResIdx](const std::pair<uint16_t, float> &WPR) {
+                     return WPR.first == ProcResIdx;
+                   });
+  return ProcResPressureIt == IdealizedProcResPressure.end()
+             ? 0.0
+             : ProcResPressureIt->second;
+}
+
 bool Analysis::SchedClassCluster::measurementsMatch(
     const llvm::MCSubtargetInfo &STI, const SchedClass &SC,
     const InstructionBenchmarkClustering &Clustering) const {
@@ -409,14 +440,7 @@ bool Analysis::SchedClassCluster::measurementsMatch(
           << NumMeasurements << "\n";
       return false;
     }
-    // Find the latency.
-    SchedClassPoint[0].Value = 0.0;
-    for (unsigned I = 0; I < SC.SCDesc->NumWriteLatencyEntries; ++I) {
-      const llvm::MCWriteLatencyEntry *const WLE =
-          STI.getWriteLatencyEntry(SC.SCDesc, I);
-      SchedClassPoint[0].Value =
-          std::max<double>(SchedClassPoint[0].Value, WLE->Cycles);
-    }
+    SchedClassPoint[0].Value = getSchedClassLatency(STI, *SC.SCDesc);
     ClusterCenterPoint[0].Value = Representative[0].avg();
   } else if (Mode == InstructionBenchmark::Uops) {
     for (int I = 0, E = Representative.size(); I < E; ++I) {
@@ -427,16 +451,8 @@ bool Analysis::SchedClassCluster::measurementsMatch(
                      << Representative[I].key() << "\n";
         return false;
       }
-      const auto ProcResPressureIt =
-          std::find_if(SC.IdealizedProcResPressure.begin(),
-                       SC.IdealizedProcResPressure.end(),
-                       [ProcResIdx](const std::pair<uint16_t, float> &WPR) {
-                         return WPR.first == ProcResIdx;
-                       });
       SchedClassPoint[I].Value =
-          ProcResPressureIt == SC.IdealizedProcResPressure.end()
-              ? 0.0
-              : ProcResPressureIt->second;
+          getProcResPressure(SC.IdealizedProcResPressure, ProcResIdx);
       ClusterCenterPoint[I].Value = Representative[I].avg();
     }
   } else {
@@ -636,6 +652,140 @@ llvm::Error Analysis::run<Analysis::PrintSchedClassInconsistencies>(
   return llvm::Error::success();
 }
 
+unsigned Analysis::resolveSchedClass(const llvm::MCInst &MCI) const {
+  const auto &SchedModel = SubtargetInfo_->getSchedModel();
+  unsigned SchedClassId = InstrInfo_->get(MCI.getOpcode()).getSchedClass();
+  while (SchedClassId &&
+         SchedModel.getSchedClassDesc(SchedClassId)->isVariant())
+    SchedClassId = SubtargetInfo_->resolveVariantSchedClass(
+        SchedClassId, &MCI, SchedModel.getProcessorID());
+  return SchedClassId;
+}
+
+template <>
+llvm::Error
+Analysis::run<Analysis::PrintSchedModelDiff>(llvm::raw_ostream &OS) const {
+  const auto &Points = Clustering_.getPoints();
+  if (Points.empty())
+    return llvm::Error::success();
+
+  const InstructionBenchmark::ModeE Mode = Points[0].Mode;
+  if (Mode != InstructionBenchmark::Latency &&
+      Mode != InstructionBenchmark::Uops)
+    return llvm::make_error<llvm::StringError>(
+        "unimplemented sched model diff for mode " +
+            llvm::Twine(static_cast<int>(Mode)),
+        llvm::inconvertibleErrorCode());
+
+  // The measurements of each opcode. All the points have the same measurement
+  // keys, which are taken from the first point without errors.
+  struct OpcodeMeasurements {
+    const InstructionBenchmark *FirstPoint = nullptr;
+    std::vector<BenchmarkMeasureStats> Stats;
+  };
+  std::map<unsigned, OpcodeMeasurements> PerOpcode;
+  const std::vector<BenchmarkMeasure> *Keys = nullptr;
+  for (const InstructionBenchmark &Point : Points) {
+    if (!Point.Error.empty() || Point.Key.Instructions.empty())
+      continue;
+    if (!Keys)
+      Keys = &Point.Measurements;
+    if (Point.Measurements.size() != Keys->size())
+      continue;
+    OpcodeMeasurements &OM = PerOpcode[Point.Key.Instructions[0].getOpcode()];
+    if (!OM.FirstPoint) {
+      OM.FirstPoint = &Point;
+      OM.Stats.resize(Keys->size());
+    }
+    for (size_t I = 0, E = Point.Measurements.size(); I < E; ++I)
+      OM.Stats[I].push(Point.Measurements[I]);
+  }
+  if (!Keys)
+    return llvm::Error::success();
+
+  // Compare each opcode with its sched class. The discrepancy of an opcode is
+  // the sum of the absolute differences between measured and predicted values.
+  struct DiffRow {
+    unsigned Opcode;
+    unsigned SchedClassId;
+    double Discrepancy;
+    std::vector<double> Measured;
+    std::vector<double> Predicted;
+  };
+  std::vector<DiffRow> Rows;
+  for (const auto &Entry : PerOpcode) {
+    const OpcodeMeasurements &OM = Entry.second;
+    const unsigned SchedClassId =
+        resolveSchedClass(OM.FirstPoint->Key.Instructions[0]);
+    const llvm::MCSchedClassDesc *const SCDesc =
+        SubtargetInfo_->getSchedModel().getSchedClassDesc(SchedClassId);
+    // There is nothing to compare with if the model has no data.
+    if (!SchedClassId || !SCDesc || !SCDesc->isValid())
+      continue;
+    const SchedClass SC(*SCDesc, *SubtargetInfo_);
+
+    DiffRow Row{Entry.first, SchedClassId, 0.0, {}, {}};
+    for (size_t I = 0, E = Keys->size(); I < E; ++I) {
+      double Predicted = 0.0;
+      if (Mode == InstructionBenchmark::Latency) {
+        Predicted = getSchedClassLatency(*SubtargetInfo_, *SCDesc);
+      } else {
+        uint16_t ProcResIdx = 0;
+        if (!llvm::to_integer((*Keys)[I].Key, ProcResIdx, 10))
+          return llvm::make_error<llvm::StringError>(
+              "expected ProcResIdx key, got " + (*Keys)[I].Key,
+              llvm::inconvertibleErrorCode());
+        Predicted = getProcResPressure(SC.IdealizedProcResPressure, ProcResIdx);
+      }
+      const double Measured = OM.Stats[I].avg();
+      Row.Measured.push_back(Measured);
+      Row.Predicted.push_back(Predicted);
+      Row.Discrepancy += std::fabs(Measured - Predicted);
+    }
+    Rows.push_back(std::move(Row));
+  }
+  std::stable_sort(Rows.begin(), Rows.end(),
+                   [](const DiffRow &A, const DiffRow &B) {
+                     return A.Discrepancy > B.Discrepancy;
+                   });
+
+  // Write the header.
+  OS << "discrepancy" << kCsvSep << "opcode_name" << kCsvSep << "sched_class";
+  for (const BenchmarkMeasure &Key : *Keys) {
+    const std::string &Name =
+        Key.DebugString.empty() ? Key.Key : Key.DebugString;
+    OS << kCsvSep;
+    writeEscaped<kEscapeCsv>(OS, Name);
+    OS << kCsvSep;
+    writeEscaped<kEscapeCsv>(OS, Name + "_model");
+  }
+  OS << "\n";
+
+  // Write the rows.
+  for (const DiffRow &Row : Rows) {
+    writeMeasurementValue<kEscapeCsv>(OS, Row.Discrepancy);
+    OS << kCsvSep;
+    writeEscaped<kEscapeCsv>(OS, InstrInfo_->getName(Row.Opcode));
+    OS << kCsvSep;
+#if !defined(NDEBUG) || defined(LLVM_ENABLE_DUMP)
+    writeEscaped<kEscapeCsv>(
+        OS,
+        SubtargetInfo_->getSchedModel().getSchedClassDesc(Row.SchedClassId)
+            ->Name);
+#else
+    OS << Row.SchedClassId;
+#endif
+    for (size_t I = 0, E = Row.Measured.size(); I < E; ++I) {
+      OS << kCsvSep;
+      writeMeasurementValue<kEscapeCsv>(OS, Row.Measured[I]);
+      OS << kCsvSep;
+      writeMeasurementValue<kEscapeCsv>(OS, Row.Predicted[I]);
+    }
+    OS << "\n";
+  }
+  return llvm::Error::success();
+}
+
 // Distributes a pressure budget as evenly as possible on the provided subunits
 // given the already existing port pressure distribution.
 //
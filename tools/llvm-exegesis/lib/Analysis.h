@@ -16,6 +16,7 @@
 #define LLVM_TOOLS_LLVM_EXEGESIS_ANALYSIS_H
 
 #include "Clustering.h"
+#include "llvm/MC/MCAsmInfo.h"
 #include "llvm/MC/MCContext.h"
 #include "llvm/MC/MCDisassembler/MCDisassembler.h"
 #include "llvm/MC/MCInstPrinter.h"
@@ -42,6 +43,9 @@ public:
   struct PrintClusters {};
   // Find potential errors in the scheduling information given measurements.
   struct PrintSchedClassInconsistencies {};
+  // Prints a csv comparing the measurements of each opcode with the values
+  // predicted by the scheduling model, ranked by decreasing discrepancy.
+  struct PrintSchedModelDiff {};
 
   template <typename Pass> llvm::Error run(llvm::raw_ostream &OS) const;
 
@@ -90,6 +94,9 @@ private:
 
   void printInstructionRowCsv(size_t PointId, llvm::raw_ostream &OS) const;
 
+  // Returns the scheduling class of MCI, with variant classes resolved.
+  unsigned resolveSchedClass(const llvm::MCInst &MCI) const;
+
   void
   printSchedClassClustersHtml(const std::vector<SchedClassCluster> &Clusters,
                               const SchedClass &SC,
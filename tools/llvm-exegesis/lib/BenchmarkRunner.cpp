@@ -16,6 +16,7 @@
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Twine.h"
+#include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -35,7 +36,8 @@ BenchmarkRunner::BenchmarkRunner(const LLVMState &State,
 BenchmarkRunner::~BenchmarkRunner() = default;
 
 llvm::Expected<std::vector<InstructionBenchmark>>
-BenchmarkRunner::run(unsigned Opcode, unsigned NumRepetitions) {
+BenchmarkRunner::run(unsigned Opcode, unsigned NumRepetitions,
+                     bool KeepObjectFiles) {
   const llvm::MCInstrDesc &InstrDesc = State.getInstrInfo().get(Opcode);
   // Ignore instructions that we cannot run.
   if (InstrDesc.isPseudo())
@@ -55,13 +57,15 @@ BenchmarkRunner::run(unsigned Opcode, unsigned NumRepetitions) {
 
   std::vector<InstructionBenchmark> InstrBenchmarks;
   for (const BenchmarkConfiguration &Conf : ConfigurationOrError.get())
-    InstrBenchmarks.push_back(runOne(Conf, Opcode, NumRepetitions));
+    InstrBenchmarks.push_back(
+        runOne(Conf, Opcode, NumRepetitions, KeepObjectFiles));
   return InstrBenchmarks;
 }
 
 InstructionBenchmark
 BenchmarkRunner::runOne(const BenchmarkConfiguration &Configuration,
-                        unsigned Opcode, unsigned NumRepetitions) const {
+                        unsigned Opcode, unsigned NumRepetitions,
+                        bool KeepObjectFiles) const {
   InstructionBenchmark InstrBenchmark;
   InstrBenchmark.Mode = Mode;
   InstrBenchmark.CpuName = State.getTargetMachine().getTargetCPU();
@@ -104,6 +108,8 @@ BenchmarkRunner::runOne(const BenchmarkConfiguration &Configuration,
                                 getObjectFromFile(*ObjectFilePath));
     const auto FnBytes = EF.getFunctionBytes();
     InstrBenchmark.AssembledSnippet.assign(FnBytes.begin(), FnBytes.end());
+    if (!KeepObjectFiles)
+      llvm::sys::fs::remove(*ObjectFilePath);
   }
 
   // Assemble NumRepetitions instructions repetitions of the snippet for
@@ -115,11 +121,24 @@ BenchmarkRunner::runOne(const BenchmarkConfiguration &Configuration,
     InstrBenchmark.Error = llvm::toString(std::move(E));
     return InstrBenchmark;
   }
-  llvm::outs() << "Check generated assembly with: /usr/bin/objdump -d "
-               << *ObjectFilePath << "\n";
+  if (KeepObjectFiles)
+    llvm::outs() << "Check generated assembly with: /usr/bin/objdump -d "
+                 << *ObjectFilePath << "\n";
   const ExecutableFunction EF(State.createTargetMachine(),
                               getObjectFromFile(*ObjectFilePath));
-  InstrBenchmark.Measurements = runMeasurements(EF, NumRepetitions);
+  if (!KeepObjectFiles)
+    llvm::sys::fs::remove(*ObjectFilePath);
+
+  // The snippet may fault, e.g. if the host does not support the instruction.
+  // If crash recovery is enabled (see llvm::CrashRecoveryContext::Enable), this
+  // is reported as an error of this benchmark.
+  llvm::CrashRecoveryContext CRC;
+  if (!CRC.RunSafely([&]() {
+        InstrBenchmark.Measurements = runMeasurements(EF, NumRepetitions);
+      })) {
+    InstrBenchmark.Measurements.clear();
+    InstrBenchmark.Error = "snippet crashed while running";
+  }
 
   return InstrBenchmark;
 }
@@ -20,6 +20,7 @@
 #include "BenchmarkResult.h"
 #include "LlvmState.h"
 #include "MCInstrDescView.h"
+#include "PerfHelper.h"
 #include "RegisterAliasing.h"
 #include "llvm/MC/MCInst.h"
 #include "llvm/Support/Error.h"
@@ -59,8 +60,10 @@ public:
 
   virtual ~BenchmarkRunner();
 
+  // Benchmarks Opcode. Unless KeepObjectFiles is false, the object file that
+  // was measured is kept for inspection, and its path is printed.
   llvm::Expected<std::vector<InstructionBenchmark>>
-  run(unsigned Opcode, unsigned NumRepetitions);
+  run(unsigned Opcode, unsigned NumRepetitions, bool KeepObjectFiles = true);
 
   // Given a snippet, computes which registers the setup code needs to define.
   std::vector<unsigned>
@@ -69,6 +72,8 @@ public:
 protected:
   const LLVMState &State;
   const RegisterAliasingTrackerCache RATC;
+  // The counters stay open across measurements, see pfm::CounterSession.
+  mutable pfm::CounterSession PerfCounters;
 
   // Generates a single instruction prototype that has a self-dependency.
   llvm::Expected<SnippetPrototype>
@@ -89,7 +94,8 @@ private:
 
   // Internal helpers.
   InstructionBenchmark runOne(const BenchmarkConfiguration &Configuration,
-                              unsigned Opcode, unsigned NumRepetitions) const;
+                              unsigned Opcode, unsigned NumRepetitions,
+                              bool KeepObjectFiles) const;
 
   // Calls generatePrototype and expands the SnippetPrototype into one or more
   // BenchmarkConfiguration.
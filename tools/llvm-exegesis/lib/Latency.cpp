@@ -116,15 +116,14 @@ LatencyBenchmarkRunner::runMeasurements(const ExecutableFunction &Function,
   const char *CounterName = getCounterName();
   if (!CounterName)
     llvm::report_fatal_error("could not determine cycle counter name");
-  const pfm::PerfEvent CyclesPerfEvent(CounterName);
-  if (!CyclesPerfEvent.valid())
+  pfm::Counter *const Counter = PerfCounters.getCounter(CounterName);
+  if (!Counter)
     llvm::report_fatal_error("invalid perf event");
   for (size_t I = 0; I < NumMeasurements; ++I) {
-    pfm::Counter Counter(CyclesPerfEvent);
-    Counter.start();
+    Counter->start();
     Function();
-    Counter.stop();
-    const int64_t Value = Counter.read();
+    Counter->stop();
+    const int64_t Value = Counter->read();
     if (Value < MinLatency)
       MinLatency = Value;
   }
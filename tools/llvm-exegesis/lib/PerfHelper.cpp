@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "PerfHelper.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Config/config.h"
 #include "llvm/Support/raw_ostream.h"
 #ifdef HAVE_LIBPFM
@@ -106,7 +107,11 @@ Counter::Counter(const PerfEvent &Event) {
 
 Counter::~Counter() { close(FileDescriptor); }
 
-void Counter::start() { ioctl(FileDescriptor, PERF_EVENT_IOC_RESET, 0); }
+void Counter::start() {
+  ioctl(FileDescriptor, PERF_EVENT_IOC_RESET, 0);
+  // The counter may have been stopped by a previous measurement.
+  ioctl(FileDescriptor, PERF_EVENT_IOC_ENABLE, 0);
+}
 
 void Counter::stop() { ioctl(FileDescriptor, PERF_EVENT_IOC_DISABLE, 0); }
 
@@ -134,5 +139,15 @@ int64_t Counter::read() const { return 42; }
 
 #endif
 
+Counter *CounterSession::getCounter(llvm::StringRef EventName) {
+  Entry &E = Entries[EventName];
+  if (!E.Event) {
+    E.Event = llvm::make_unique<PerfEvent>(EventName);
+    if (E.Event->valid())
+      E.EventCounter = llvm::make_unique<Counter>(*E.Event);
+  }
+  return E.EventCounter.get();
+}
+
 } // namespace pfm
 } // namespace exegesis
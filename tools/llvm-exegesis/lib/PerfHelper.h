@@ -16,6 +16,7 @@
 #define LLVM_TOOLS_LLVM_EXEGESIS_PERFHELPER_H
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Config/config.h"
 #include <functional>
@@ -72,7 +73,7 @@ struct Counter {
 
   ~Counter();
 
-  void start();         // Starts the measurement of the event.
+  void start();         // Resets the counter and starts the measurement.
   void stop();          // Stops the measurement of the event.
   int64_t read() const; // Return the current value of the counter.
 
@@ -82,6 +83,23 @@ private:
 #endif
 };
 
+// Keeps counters open, so that the same events can be measured for many
+// snippets: encoding an event and opening a counter for it are expensive
+// compared to running a snippet. Counters are created on first use.
+class CounterSession {
+public:
+  // Returns the counter for the event named EventName, or nullptr if the event
+  // is not valid.
+  Counter *getCounter(llvm::StringRef EventName);
+
+private:
+  struct Entry {
+    std::unique_ptr<PerfEvent> Event;
+    std::unique_ptr<Counter> EventCounter; // nullptr if Event is not valid.
+  };
+  llvm::StringMap<Entry> Entries;
+};
+
 // Helper to measure a list of PerfEvent for a particular function.
 // callback is called for each successful measure (PerfEvent needs to be valid).
 template <typename Function>
@@ -215,15 +215,14 @@ UopsBenchmarkRunner::runMeasurements(const ExecutableFunction &Function,
     llvm::SmallVector<llvm::StringRef, 2> CounterNames;
     llvm::StringRef(PfmCounters).split(CounterNames, ',');
     for (const auto &CounterName : CounterNames) {
-      pfm::PerfEvent UopPerfEvent(CounterName);
-      if (!UopPerfEvent.valid())
+      pfm::Counter *const Counter = PerfCounters.getCounter(CounterName);
+      if (!Counter)
         llvm::report_fatal_error(
             llvm::Twine("invalid perf event ").concat(PfmCounters));
-      pfm::Counter Counter(UopPerfEvent);
-      Counter.start();
+      Counter->start();
       Function();
-      Counter.stop();
-      CounterValue += Counter.read();
+      Counter->stop();
+      CounterValue += Counter->read();
     }
     Result.push_back({llvm::itostr(ProcResIdx),
                       static_cast<double>(CounterValue) / NumRepetitions,
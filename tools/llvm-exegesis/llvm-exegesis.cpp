@@ -25,6 +25,7 @@
 #include "llvm/MC/MCRegisterInfo.h"
 #include "llvm/MC/MCSubtargetInfo.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/TargetRegistry.h"
@@ -34,8 +35,10 @@
 #include <string>
 #include <unordered_map>
 
-static llvm::cl::opt<unsigned>
-    OpcodeIndex("opcode-index", llvm::cl::desc("opcode to measure, by index"),
+static llvm::cl::opt<int>
+    OpcodeIndex("opcode-index",
+                llvm::cl::desc("opcode to measure, by index, or -1 to measure "
+                               "all opcodes"),
                 llvm::cl::init(0));
 
 static llvm::cl::opt<std::string>
@@ -82,6 +85,11 @@ static llvm::cl::opt<std::string>
 static llvm::cl::opt<std::string>
     AnalysisInconsistenciesOutputFile("analysis-inconsistencies-output-file",
                                       llvm::cl::desc(""), llvm::cl::init("-"));
+static llvm::cl::opt<std::string> AnalysisSchedModelDiffOutputFile(
+    "analysis-sched-model-diff-output-file",
+    llvm::cl::desc("file to write the comparison of every opcode with the "
+                   "scheduling model to"),
+    llvm::cl::init(""));
 
 namespace exegesis {
 
@@ -91,16 +99,24 @@ static llvm::ExitOnError ExitOnErr;
 void LLVM_EXEGESIS_INITIALIZE_NATIVE_TARGET();
 #endif
 
-static unsigned GetOpcodeOrDie(const llvm::MCInstrInfo &MCInstrInfo) {
+// Returns the opcodes to measure.
+static std::vector<unsigned>
+getOpcodesOrDie(const llvm::MCInstrInfo &MCInstrInfo) {
   if (OpcodeName.empty() && (OpcodeIndex == 0))
     llvm::report_fatal_error(
         "please provide one and only one of 'opcode-index' or 'opcode-name'");
   if (OpcodeIndex > 0)
-    return OpcodeIndex;
+    return {static_cast<unsigned>(OpcodeIndex)};
+  if (OpcodeIndex < 0) {
+    std::vector<unsigned> Result;
+    for (unsigned I = 1, E = MCInstrInfo.getNumOpcodes(); I < E; ++I)
+      Result.push_back(I);
+    return Result;
+  }
   // Resolve opcode name -> opcode.
   for (unsigned I = 0, E = MCInstrInfo.getNumOpcodes(); I < E; ++I)
     if (MCInstrInfo.getName(I) == OpcodeName)
-      return I;
+      return {I};
   llvm::report_fatal_error(llvm::Twine("unknown opcode ").concat(OpcodeName));
 }
 
@@ -130,15 +146,7 @@ void benchmarkMain() {
 #endif
 
   const LLVMState State;
-  const auto Opcode = GetOpcodeOrDie(State.getInstrInfo());
-
-  // Ignore instructions without a sched class if -ignore-invalid-sched-class is
-  // passed.
-  if (IgnoreInvalidSchedClass &&
-      State.getInstrInfo().get(Opcode).getSchedClass() == 0) {
-    llvm::errs() << "ignoring instruction without sched class\n";
-    return;
-  }
+  const std::vector<unsigned> Opcodes = getOpcodesOrDie(State.getInstrInfo());
 
   const std::unique_ptr<BenchmarkRunner> Runner =
       State.getExegesisTarget().createBenchmarkRunner(BenchmarkMode, State);
@@ -154,10 +162,55 @@ void benchmarkMain() {
     BenchmarkFile = "-";
 
   const BenchmarkResultContext Context = getBenchmarkResultContext(State);
-  std::vector<InstructionBenchmark> Results =
-      ExitOnErr(Runner->run(Opcode, NumRepetitions));
-  for (InstructionBenchmark &Result : Results)
-    ExitOnErr(Result.writeYaml(Context, BenchmarkFile));
+
+  if (Opcodes.size() == 1) {
+    const unsigned Opcode = Opcodes[0];
+    // Ignore instructions without a sched class if
+    // -ignore-invalid-sched-class is passed.
+    if (IgnoreInvalidSchedClass &&
+        State.getInstrInfo().get(Opcode).getSchedClass() == 0) {
+      llvm::errs() << "ignoring instruction without sched class\n";
+      return;
+    }
+
+    std::vector<InstructionBenchmark> Results =
+        ExitOnErr(Runner->run(Opcode, NumRepetitions));
+    for (InstructionBenchmark &Result : Results)
+      ExitOnErr(Result.writeYaml(Context, BenchmarkFile));
+
+    exegesis::pfm::pfmTerminate();
+    return;
+  }
+
+  // Sweep mode: all the results go to the same file. Opcodes that can't be
+  // benchmarked are skipped, and snippets that crash are reported as errors
+  // rather than aborting the sweep.
+  std::error_code ErrorCode;
+  llvm::raw_fd_ostream OS(BenchmarkFile, ErrorCode, llvm::sys::fs::F_Text);
+  if (ErrorCode)
+    llvm::report_fatal_error("cannot open out file: " + BenchmarkFile);
+  llvm::CrashRecoveryContext::Enable();
+  unsigned NumBenchmarked = 0, NumSkipped = 0;
+  for (const unsigned Opcode : Opcodes) {
+    if (IgnoreInvalidSchedClass &&
+        State.getInstrInfo().get(Opcode).getSchedClass() == 0) {
+      ++NumSkipped;
+      continue;
+    }
+    auto Results =
+        Runner->run(Opcode, NumRepetitions, /*KeepObjectFiles=*/false);
+    if (!Results) {
+      llvm::consumeError(Results.takeError());
+      ++NumSkipped;
+      continue;
+    }
+    for (InstructionBenchmark &Result : *Results)
+      Result.writeYamlTo(Context, OS);
+    ++NumBenchmarked;
+  }
+  llvm::CrashRecoveryContext::Disable();
+  llvm::errs() << "benchmarked " << NumBenchmarked << " opcodes, skipped "
+               << NumSkipped << "\n";
 
   exegesis::pfm::pfmTerminate();
 }
@@ -220,6 +273,8 @@ static void analysisMain() {
   maybeRunAnalysis<Analysis::PrintSchedClassInconsistencies>(
       Analyzer, "sched class consistency analysis",
       AnalysisInconsistenciesOutputFile);
+  maybeRunAnalysis<Analysis::PrintSchedModelDiff>(
+      Analyzer, "sched model diff", AnalysisSchedModelDiffOutputFile);
 }
 
 } // namespace exegesis
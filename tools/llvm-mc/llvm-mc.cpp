@@ -302,11 +302,11 @@ static int AssembleInput(const char *ProgName, const Target *TheTarget,
 int main(int argc, char **argv) {
   InitLLVM X(argc, argv);
 
-  // Initialize targets and assembly printers/parsers.
-  llvm::InitializeAllTargetInfos();
-  llvm::InitializeAllTargetMCs();
-  llvm::InitializeAllAsmParsers();
-  llvm::InitializeAllDisassemblers();
+  // Register all targets, but only initialize the MC layer and assembly
+  // parser and disassembler of the one that gets looked up.
+  llvm::InitializeAllTargetMCsLazily();
+  llvm::InitializeAllAsmParsersLazily();
+  llvm::InitializeAllDisassemblersLazily();
 
   // Register the target printer for --version.
   cl::AddExtraVersionPrinter(TargetRegistry::printRegisteredTargetsForVersion);
@@ -132,6 +132,21 @@ static void initializeUsedResources(InstrDesc &ID,
     }
   }
 
+  // Summarize the resource requirements for ResourceManager::canBeIssued().
+  ID.ReadyResourcesMask = 0;
+  ID.UnreservedResourcesMask = 0;
+  ID.UsesMultipleUnits = false;
+  for (const ResourcePlusCycles &RPC : ID.Resources) {
+    uint64_t Bit = PowerOf2Floor(RPC.first);
+    if (RPC.second.isReserved()) {
+      ID.UnreservedResourcesMask |= Bit;
+      continue;
+    }
+    ID.ReadyResourcesMask |= Bit;
+    if (RPC.second.NumUnits > 1)
+      ID.UsesMultipleUnits = true;
+  }
+
   LLVM_DEBUG({
     for (const std::pair<uint64_t, ResourceUsage> &R : ID.Resources)
       dbgs() << "\t\tMask=" << R.first << ", cy=" << R.second.size() << '\n';
@@ -393,6 +408,9 @@ const InstrDesc &InstrBuilder::createInstrDescImpl(const MCInst &MCI) {
 }
 
 const InstrDesc &InstrBuilder::getOrCreateInstrDesc(const MCInst &MCI) {
+  // The returned descriptor outlives the lock; descriptors are only freed by
+  // clear().
+  std::lock_guard<std::mutex> Lock(Mutex);
   if (Descriptors.find_as(MCI.getOpcode()) != Descriptors.end())
     return *Descriptors[MCI.getOpcode()];
 
@@ -428,7 +446,8 @@ InstrBuilder::createInstruction(const MCInst &MCI) {
 
     // Okay, this is a register operand. Create a ReadState for it.
     assert(RegID > 0 && "Invalid register ID found!");
-    NewIS->getUses().emplace_back(llvm::make_unique<ReadState>(RD, RegID));
+    NewIS->getUses().emplace_back(
+        llvm::make_unique<ReadState>(RD, NewIS.get(), RegID));
   }
 
   // Early exit if there are no writes.
@@ -22,6 +22,7 @@
 #include "llvm/MC/MCInstrInfo.h"
 #include "llvm/MC/MCRegisterInfo.h"
 #include "llvm/MC/MCSubtargetInfo.h"
+#include <mutex>
 
 namespace mca {
 
@@ -37,6 +38,9 @@ class DispatchUnit;
 /// descriptors (i.e. InstrDesc objects).
 /// Information from the machine scheduling model is used to identify processor
 /// resources that are consumed by an instruction.
+///
+/// Instructions can be created concurrently, so that several pipelines can
+/// share the descriptors of an InstrBuilder.
 class InstrBuilder {
   const llvm::MCSubtargetInfo &STI;
   const llvm::MCInstrInfo &MCII;
@@ -48,6 +52,8 @@ class InstrBuilder {
   llvm::DenseMap<unsigned short, std::unique_ptr<const InstrDesc>> Descriptors;
   llvm::DenseMap<const llvm::MCInst *, std::unique_ptr<const InstrDesc>>
       VariantDescriptors;
+  // Guards the descriptor maps.
+  std::mutex Mutex;
 
   const InstrDesc &createInstrDescImpl(const llvm::MCInst &MCI);
   InstrBuilder(const InstrBuilder &) = delete;
@@ -76,7 +82,10 @@ public:
     return ProcResourceMasks;
   }
 
-  void clear() { VariantDescriptors.shrink_and_clear(); }
+  void clear() {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    VariantDescriptors.shrink_and_clear();
+  }
 
   std::unique_ptr<Instruction> createInstruction(const llvm::MCInst &MCI);
 };
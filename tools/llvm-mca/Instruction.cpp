@@ -151,6 +151,25 @@ void Instruction::update() {
     Stage = IS_READY;
 }
 
+bool Instruction::isWaitingOnUnissuedWrites() const {
+  if (!isDispatched())
+    return false;
+
+  bool IsWaiting = false;
+  for (const UniqueUse &Use : Uses) {
+    if (Use->isWaitingOnUnissuedWrites())
+      IsWaiting = true;
+    else if (!Use->isReady())
+      return false;
+  }
+
+  // The readiness of a partial register write depends on the progress of the
+  // write it depends on.
+  return IsWaiting && llvm::none_of(Defs, [](const UniqueDef &Def) {
+           return Def->getDependentWrite();
+         });
+}
+
 void Instruction::cycleEvent() {
   if (isReady())
     return;
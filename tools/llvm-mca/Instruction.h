@@ -76,6 +76,7 @@ struct ReadDescriptor {
   bool isImplicitRead() const { return OpIndex < 0; };
 };
 
+class Instruction;
 class ReadState;
 
 /// Tracks uses of a register definition (e.g. register write).
@@ -130,6 +131,9 @@ public:
 
   void addUser(ReadState *Use, int ReadAdvance);
   unsigned getNumUsers() const { return Users.size(); }
+  const std::set<std::pair<ReadState *, int>> &getUsers() const {
+    return Users;
+  }
   bool clearsSuperRegisters() const { return ClearsSuperRegs; }
 
   const WriteState *getDependentWrite() const { return DependentWrite; }
@@ -150,6 +154,8 @@ public:
 /// writes only partially update the register associated to this read.
 class ReadState {
   const ReadDescriptor &RD;
+  // The instruction that performs this read.
+  Instruction *Owner;
   // Physical register identified associated to this read.
   unsigned RegisterID;
   // Number of writes that contribute to the definition of RegisterID.
@@ -170,19 +176,28 @@ class ReadState {
   bool IsReady;
 
 public:
-  ReadState(const ReadDescriptor &Desc, unsigned RegID)
-      : RD(Desc), RegisterID(RegID), DependentWrites(0),
+  ReadState(const ReadDescriptor &Desc, Instruction *IS, unsigned RegID)
+      : RD(Desc), Owner(IS), RegisterID(RegID), DependentWrites(0),
         CyclesLeft(UNKNOWN_CYCLES), TotalCycles(0), IsReady(true) {}
   ReadState(const ReadState &Other) = delete;
   ReadState &operator=(const ReadState &Other) = delete;
 
   const ReadDescriptor &getDescriptor() const { return RD; }
+  Instruction *getOwner() const { return Owner; }
   unsigned getSchedClass() const { return RD.SchedClassID; }
   unsigned getRegisterID() const { return RegisterID; }
 
   bool isReady() const { return IsReady; }
   bool isImplicitRead() const { return RD.isImplicitRead(); }
 
+  // Returns true if this read depends on writes whose latency is not known
+  // yet, because they belong to instructions that have not been issued.
+  // Cycle events don't change the state of such a read; only the issue of one
+  // of those writes does (see writeStartEvent).
+  bool isWaitingOnUnissuedWrites() const {
+    return DependentWrites && !TotalCycles;
+  }
+
   void cycleEvent();
   void writeStartEvent(unsigned Cycles);
   void setDependentWrites(unsigned Writes) {
@@ -262,6 +277,19 @@ struct InstrDesc {
 
   // A list of buffered resources consumed by this instruction.
   std::vector<uint64_t> Buffers;
+
+  // Summary of the resources in 'Resources', used by the scheduler to check
+  // quickly if this instruction can be issued. Each resource is identified by
+  // the most significant bit of its mask.
+  // ReadyResourcesMask: resources that must have at least one available unit.
+  // UnreservedResourcesMask: reserved groups, that must not be reserved
+  // already.
+  // UsesMultipleUnits: true if more than one unit of a group is used. Those
+  // groups must be checked individually.
+  uint64_t ReadyResourcesMask;
+  uint64_t UnreservedResourcesMask;
+  bool UsesMultipleUnits;
+
   unsigned MaxLatency;
   // Number of MicroOps for this instruction.
   unsigned NumMicroOps;
@@ -357,6 +385,12 @@ public:
   // instruction might have changed in state.
   void update();
 
+  // Returns true if this instruction is dispatched, and if it waits for the
+  // result of an instruction that has not been issued yet. The state of such
+  // an instruction can't change until one of its register writers is issued,
+  // so it doesn't need to be updated at every cycle.
+  bool isWaitingOnUnissuedWrites() const;
+
   bool isDispatched() const { return Stage == IS_AVAILABLE; }
   bool isReady() const { return Stage == IS_READY; }
   bool isExecuting() const { return Stage == IS_EXECUTING; }
@@ -0,0 +1,170 @@
+//===--------------------- JSONView.cpp ----------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+///
+/// This file implements the JSONView interface.
+///
+//===----------------------------------------------------------------------===//
+
+#include "JSONView.h"
+#include "Support.h"
+#include "llvm/Support/FormatVariadic.h"
+#include <cmath>
+
+namespace mca {
+
+using namespace llvm;
+
+// A resource, or the dispatch logic, is considered to limit throughput if it
+// is busy for at least this fraction of the cycles.
+static const double SaturationThreshold = 0.9;
+
+// A dispatch stall is reported as a bottleneck if it accounts for at least this
+// fraction of the cycles.
+static const double StallThreshold = 0.1;
+
+static double roundTo(double Value, double Scale) {
+  return std::floor(Value * Scale + 0.5) / Scale;
+}
+
+JSONView::JSONView(const MCSchedModel &Model, const SourceMgr &S,
+                   unsigned Width)
+    : SM(Model), Source(S), DispatchWidth(Width), TotalCycles(0),
+      NumMicroOps(0), ProcResourceUsage(Model.getNumProcResourceKinds(), 0),
+      ProcResourceMasks(Model.getNumProcResourceKinds(), 0),
+      HWStalls(HWStallEvent::LastGenericEvent, 0) {
+  computeProcResourceMasks(SM, ProcResourceMasks);
+
+  unsigned R2VIndex = 0;
+  for (unsigned I = 0, E = SM.getNumProcResourceKinds(); I < E; ++I) {
+    const MCProcResourceDesc &ProcResource = *SM.getProcResource(I);
+    // Skip groups and invalid resources with zero units.
+    if (ProcResource.SubUnitsIdxBegin || !ProcResource.NumUnits)
+      continue;
+    Resource2VecIndex[I] = R2VIndex;
+    R2VIndex += ProcResource.NumUnits;
+  }
+  ResourceUnitUsage.resize(R2VIndex, 0.0);
+}
+
+void JSONView::onEvent(const HWInstructionEvent &Event) {
+  if (Event.Type == HWInstructionEvent::Issued) {
+    const auto &IssueEvent =
+        static_cast<const HWInstructionIssuedEvent &>(Event);
+    for (const std::pair<ResourceRef, double> &Use : IssueEvent.UsedResources) {
+      const ResourceRef &RR = Use.first;
+      assert(Resource2VecIndex.count(RR.first) && "Unexpected resource!");
+      unsigned R2VIndex = Resource2VecIndex.lookup(RR.first);
+      ResourceUnitUsage[R2VIndex + countTrailingZeros(RR.second)] +=
+          Use.second;
+    }
+    return;
+  }
+
+  // Like the summary view, compute the resource cycles of the code block from
+  // the instructions of iteration #0.
+  if (Event.Type != HWInstructionEvent::Dispatched ||
+      Event.IR.getSourceIndex() >= Source.size())
+    return;
+
+  const InstrDesc &Desc = Event.IR.getInstruction()->getDesc();
+  NumMicroOps += Desc.NumMicroOps;
+  for (const std::pair<uint64_t, const ResourceUsage> &RU : Desc.Resources) {
+    if (RU.second.size()) {
+      const auto It = find(ProcResourceMasks, RU.first);
+      assert(It != ProcResourceMasks.end() &&
+             "Invalid processor resource mask!");
+      ProcResourceUsage[std::distance(ProcResourceMasks.begin(), It)] +=
+          RU.second.size();
+    }
+  }
+}
+
+json::Object JSONView::toJSON() const {
+  unsigned Iterations = Source.getNumIterations();
+  unsigned TotalInstructions = Source.size() * Iterations;
+  double IPC = TotalCycles ? (double)TotalInstructions / TotalCycles : 0.0;
+  double BlockRThroughput = computeBlockRThroughput(
+      SM, DispatchWidth, NumMicroOps, ProcResourceUsage);
+  double CyclesPerIteration =
+      Iterations ? (double)TotalCycles / Iterations : 0.0;
+
+  // Resource pressure per iteration, and the most used resource unit.
+  json::Object Pressure;
+  std::string BusiestUnit;
+  double BusiestUsage = 0.0;
+  for (unsigned I = 0, E = SM.getNumProcResourceKinds(); I < E; ++I) {
+    const MCProcResourceDesc &ProcResource = *SM.getProcResource(I);
+    auto It = Resource2VecIndex.find(I);
+    if (It == Resource2VecIndex.end())
+      continue;
+    for (unsigned J = 0; J < ProcResource.NumUnits; ++J) {
+      std::string Name = ProcResource.Name;
+      if (ProcResource.NumUnits > 1)
+        Name += "." + std::to_string(J);
+      double Usage = ResourceUnitUsage[It->second + J];
+      if (Iterations)
+        Usage /= Iterations;
+      if (Usage > BusiestUsage) {
+        BusiestUsage = Usage;
+        BusiestUnit = Name;
+      }
+      Pressure[Name] = roundTo(Usage, 100);
+    }
+  }
+
+  static const char *const StallNames[] = {nullptr, "RAT",  "RCU", "GROUP",
+                                           "SCHEDQ", "LQ",  "SQ"};
+  static_assert(array_lengthof(StallNames) == HWStallEvent::LastGenericEvent,
+                "Unexpected number of stall kinds!");
+  json::Object Stalls;
+  unsigned LargestStall = 0;
+  for (unsigned I = 1; I < HWStallEvent::LastGenericEvent; ++I) {
+    Stalls[StallNames[I]] = HWStalls[I];
+    // The scheduler and the retire control unit fill up when instructions
+    // can't issue or retire, whatever the reason. Those stalls are symptoms,
+    // not causes.
+    if (I == HWStallEvent::SchedulerQueueFull ||
+        I == HWStallEvent::RetireControlUnitStall)
+      continue;
+    if (HWStalls[I] > HWStalls[LargestStall])
+      LargestStall = I;
+  }
+
+  json::Array Bottlenecks;
+  if (CyclesPerIteration > 0.0) {
+    double UOpsPerCycle = (double)NumMicroOps / CyclesPerIteration;
+    if (UOpsPerCycle >= SaturationThreshold * DispatchWidth)
+      Bottlenecks.push_back("dispatch");
+    if (BusiestUsage >= SaturationThreshold * CyclesPerIteration)
+      Bottlenecks.push_back("resource:" + BusiestUnit);
+  }
+  if (LargestStall && HWStalls[LargestStall] >= StallThreshold * TotalCycles)
+    Bottlenecks.push_back(std::string("stall:") + StallNames[LargestStall]);
+  if (Bottlenecks.empty())
+    Bottlenecks.push_back("dependencies");
+
+  return json::Object{
+      {"iterations", Iterations},
+      {"instructions", TotalInstructions},
+      {"cycles", TotalCycles},
+      {"dispatch_width", DispatchWidth},
+      {"uops_per_iteration", NumMicroOps},
+      {"ipc", roundTo(IPC, 100)},
+      {"block_rthroughput", roundTo(BlockRThroughput, 10)},
+      {"resource_pressure", std::move(Pressure)},
+      {"dispatch_stalls", std::move(Stalls)},
+      {"bottlenecks", std::move(Bottlenecks)}};
+}
+
+void JSONView::printView(raw_ostream &OS) const {
+  OS << formatv("{0:2}", json::Value(toJSON())) << '\n';
+}
+
+} // namespace mca
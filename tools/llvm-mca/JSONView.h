@@ -0,0 +1,107 @@
+//===--------------------- JSONView.h ------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+///
+/// This file implements a view that reports the simulation of a code region
+/// as a JSON object, for consumption by scripts and other tools.
+///
+/// The object combines the information from the summary view, the resource
+/// pressure view and the dispatch statistics, and adds a list of likely
+/// bottlenecks. Below is an example, with fewer resources:
+///
+/// {
+///   "block_rthroughput": 1.5,
+///   "bottlenecks": [ "dispatch", "resource:JALU0" ],
+///   "cycles": 153,
+///   "dispatch_stalls": { "GROUP": 0, "LQ": 0, "RAT": 0, "RCU": 0,
+///                        "SCHEDQ": 0, "SQ": 0 },
+///   "dispatch_width": 2,
+///   "instructions": 300,
+///   "ipc": 1.96,
+///   "iterations": 100,
+///   "resource_pressure": { "JALU0": 1.5, "JALU1": 1.5, "JFPA": 0, ... },
+///   "uops_per_iteration": 3
+/// }
+///
+/// Resource pressure is the average number of cycles per iteration that each
+/// processor resource unit was busy. Dispatch stalls are cycles.
+///
+/// Bottlenecks are derived from the numbers above:
+///  - "dispatch": micro opcodes are dispatched at close to the dispatch width.
+///  - "resource:<name>": the most used resource unit is busy for close to
+///    every cycle of an iteration.
+///  - "stall:<kind>": dispatch stalls caused by a full register file (RAT),
+///    load queue (LQ) or store queue (SQ), or by dispatch group restrictions
+///    (GROUP), account for a significant fraction of the cycles. Only the
+///    largest kind is reported. Scheduler (SCHEDQ) and retire control unit
+///    (RCU) stalls are not reported; they are a consequence of instructions
+///    that can't issue or retire.
+///  - "dependencies": none of the above applies, so throughput is most likely
+///    limited by the latency of data dependencies.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TOOLS_LLVM_MCA_JSONVIEW_H
+#define LLVM_TOOLS_LLVM_MCA_JSONVIEW_H
+
+#include "SourceMgr.h"
+#include "View.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/MC/MCSchedule.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace mca {
+
+class JSONView : public View {
+  const llvm::MCSchedModel &SM;
+  const SourceMgr &Source;
+  const unsigned DispatchWidth;
+  unsigned TotalCycles;
+  // The total number of micro opcodes contributed by a block of instructions.
+  unsigned NumMicroOps;
+  // Cumulative number of resource cycles consumed by the code block, for
+  // every processor resource. This is used to compute the block throughput
+  // (see SummaryView).
+  llvm::SmallVector<unsigned, 8> ProcResourceUsage;
+  llvm::SmallVector<uint64_t, 8> ProcResourceMasks;
+
+  // Map from a processor resource ID to the index of its first unit in
+  // ResourceUnitUsage.
+  llvm::DenseMap<unsigned, unsigned> Resource2VecIndex;
+  // Number of resource cycles consumed by every processor resource unit, over
+  // all the iterations.
+  llvm::SmallVector<double, 16> ResourceUnitUsage;
+
+  // Counts dispatch stall events; one counter per generic stall kind (see
+  // class HWStallEvent).
+  llvm::SmallVector<unsigned, 8> HWStalls;
+
+public:
+  JSONView(const llvm::MCSchedModel &Model, const SourceMgr &S,
+           unsigned Width);
+
+  void onCycleEnd() override { ++TotalCycles; }
+
+  void onEvent(const HWInstructionEvent &Event) override;
+
+  void onEvent(const HWStallEvent &Event) override {
+    if (Event.Type < HWStallEvent::LastGenericEvent)
+      HWStalls[Event.Type]++;
+  }
+
+  /// Returns the report for the simulated code region.
+  llvm::json::Object toJSON() const;
+
+  void printView(llvm::raw_ostream &OS) const override;
+};
+} // namespace mca
+
+#endif
@@ -75,9 +75,14 @@ bool LSUnit::reserve(const InstRef &IR) {
 
 bool LSUnit::isReady(const InstRef &IR) const {
   const unsigned Index = IR.getSourceIndex();
-  bool IsALoad = LoadQueue.count(Index) != 0;
-  bool IsAStore = StoreQueue.count(Index) != 0;
+  // Method reserve() assigned a queue entry according to the descriptor, so
+  // there is no need to look the instruction up in the queues.
+  const InstrDesc &Desc = IR.getInstruction()->getDesc();
+  bool IsALoad = Desc.MayLoad;
+  bool IsAStore = Desc.MayStore;
   assert((IsALoad || IsAStore) && "Instruction is not in queue!");
+  assert((!IsALoad || LoadQueue.count(Index)) && "Load is not in queue!");
+  assert((!IsAStore || StoreQueue.count(Index)) && "Store is not in queue!");
 
   if (IsALoad && !LoadBarriers.empty()) {
     unsigned LoadBarrierIndex = *LoadBarriers.begin();
@@ -72,6 +72,8 @@ public:
   Pipeline() : Cycles(0) {}
   void appendStage(std::unique_ptr<Stage> S) { Stages.push_back(std::move(S)); }
   void run();
+  /// Returns the number of cycles simulated so far.
+  unsigned getNumCycles() const { return Cycles; }
   void addEventListener(HWEventListener *Listener);
 };
 } // namespace mca
@@ -44,24 +44,44 @@ void ResourceState::dump() const {
 
 void ResourceManager::initialize(const llvm::MCSchedModel &SM) {
   computeProcResourceMasks(SM, ProcResID2Mask);
-  for (unsigned I = 0, E = SM.getNumProcResourceKinds(); I < E; ++I)
+  unsigned NumResources = SM.getNumProcResourceKinds();
+  Resources.resize(NumResources);
+  Resource2Groups.resize(NumResources, 0);
+  for (unsigned I = 0; I < NumResources; ++I)
     addResource(*SM.getProcResource(I), I, ProcResID2Mask[I]);
+
+  // Record the groups that contain each resource, so that use() and release()
+  // only visit those.
+  for (unsigned I = 0; I < NumResources; ++I) {
+    uint64_t Mask = ProcResID2Mask[I];
+    if (countPopulation(Mask) <= 1)
+      continue;
+    uint64_t GroupBit = PowerOf2Floor(Mask);
+    uint64_t Units = Mask ^ GroupBit;
+    while (Units) {
+      uint64_t Unit = Units & (-Units);
+      Resource2Groups[getResourceStateIndex(Unit)] |= GroupBit;
+      Units ^= Unit;
+    }
+  }
 }
 
 // Adds a new resource state in Resources, as well as a new descriptor in
-// ResourceDescriptor. Map 'Resources' allows to quickly obtain ResourceState
-// objects from resource mask identifiers.
+// ResourceDescriptor. Vector 'Resources' allows to quickly obtain
+// ResourceState objects from resource mask identifiers.
 void ResourceManager::addResource(const MCProcResourceDesc &Desc,
                                   unsigned Index, uint64_t Mask) {
-  assert(Resources.find(Mask) == Resources.end() && "Resource already added!");
-  Resources[Mask] = llvm::make_unique<ResourceState>(Desc, Index, Mask);
+  unsigned RSIndex = getResourceStateIndex(Mask);
+  assert(!Resources[RSIndex] && "Resource already added!");
+  Resources[RSIndex] = llvm::make_unique<ResourceState>(Desc, Index, Mask);
+  updateAvailability(*Resources[RSIndex]);
 }
 
 // Returns the actual resource consumed by this Use.
 // First, is the primary resource ID.
 // Second, is the specific sub-resource ID.
 std::pair<uint64_t, uint64_t> ResourceManager::selectPipe(uint64_t ResourceID) {
-  ResourceState &RS = *Resources[ResourceID];
+  ResourceState &RS = getResource(ResourceID);
   uint64_t SubResourceID = RS.selectNextInSequence();
   if (RS.isAResourceGroup())
     return selectPipe(SubResourceID);
@@ -84,40 +104,44 @@ void ResourceState::removeFromNextInSequence(uint64_t ID) {
 
 void ResourceManager::use(ResourceRef RR) {
   // Mark the sub-resource referenced by RR as used.
-  ResourceState &RS = *Resources[RR.first];
+  ResourceState &RS = getResource(RR.first);
   RS.markSubResourceAsUsed(RR.second);
+  updateAvailability(RS);
   // If there are still available units in RR.first,
   // then we are done.
   if (RS.isReady())
     return;
 
-  // Notify to other resources that RR.first is no longer available.
-  for (const std::pair<uint64_t, UniqueResourceState> &Res : Resources) {
-    ResourceState &Current = *Res.second.get();
-    if (!Current.isAResourceGroup() || Current.getResourceMask() == RR.first)
-      continue;
-
-    if (Current.containsResource(RR.first)) {
-      Current.markSubResourceAsUsed(RR.first);
-      Current.removeFromNextInSequence(RR.first);
-    }
+  // Notify to the groups that contain RR.first that it is no longer
+  // available.
+  uint64_t Groups = Resource2Groups[getResourceStateIndex(RR.first)];
+  while (Groups) {
+    uint64_t GroupBit = Groups & (-Groups);
+    ResourceState &Current = getResource(GroupBit);
+    assert(Current.containsResource(RR.first) && "Unexpected group!");
+    Current.markSubResourceAsUsed(RR.first);
+    Current.removeFromNextInSequence(RR.first);
+    updateAvailability(Current);
+    Groups ^= GroupBit;
   }
 }
 
 void ResourceManager::release(ResourceRef RR) {
-  ResourceState &RS = *Resources[RR.first];
+  ResourceState &RS = getResource(RR.first);
   bool WasFullyUsed = !RS.isReady();
   RS.releaseSubResource(RR.second);
+  updateAvailability(RS);
   if (!WasFullyUsed)
     return;
 
-  for (const std::pair<uint64_t, UniqueResourceState> &Res : Resources) {
-    ResourceState &Current = *Res.second.get();
-    if (!Current.isAResourceGroup() || Current.getResourceMask() == RR.first)
-      continue;
-
-    if (Current.containsResource(RR.first))
-      Current.releaseSubResource(RR.first);
+  uint64_t Groups = Resource2Groups[getResourceStateIndex(RR.first)];
+  while (Groups) {
+    uint64_t GroupBit = Groups & (-Groups);
+    ResourceState &Current = getResource(GroupBit);
+    assert(Current.containsResource(RR.first) && "Unexpected group!");
+    Current.releaseSubResource(RR.first);
+    updateAvailability(Current);
+    Groups ^= GroupBit;
   }
 }
 
@@ -135,10 +159,11 @@ ResourceManager::canBeDispatched(ArrayRef<uint64_t> Buffers) const {
 void ResourceManager::reserveBuffers(ArrayRef<uint64_t> Buffers) {
   for (const uint64_t R : Buffers) {
     reserveBuffer(R);
-    ResourceState &Resource = *Resources[R];
+    ResourceState &Resource = getResource(R);
     if (Resource.isADispatchHazard()) {
       assert(!Resource.isReserved());
       Resource.setReserved();
+      updateAvailability(Resource);
     }
   }
 }
@@ -149,11 +174,19 @@ void ResourceManager::releaseBuffers(ArrayRef<uint64_t> Buffers) {
 }
 
 bool ResourceManager::canBeIssued(const InstrDesc &Desc) const {
+  if ((Desc.ReadyResourcesMask & ~ReadyResources) ||
+      (Desc.UnreservedResourcesMask & ~UnreservedResources))
+    return false;
+  if (!Desc.UsesMultipleUnits)
+    return true;
+
+  // Only resource groups of which more than one unit is used remain to be
+  // checked.
   return std::all_of(Desc.Resources.begin(), Desc.Resources.end(),
                      [&](const std::pair<uint64_t, const ResourceUsage> &E) {
-                       unsigned NumUnits =
-                           E.second.isReserved() ? 0U : E.second.NumUnits;
-                       return isReady(E.first, NumUnits);
+                       if (E.second.isReserved() || E.second.NumUnits <= 1)
+                         return true;
+                       return isReady(E.first, E.second.NumUnits);
                      });
 }
 
@@ -163,14 +196,14 @@ bool ResourceManager::mustIssueImmediately(const InstrDesc &Desc) {
   if (!canBeIssued(Desc))
     return false;
   bool AllInOrderResources = all_of(Desc.Buffers, [&](uint64_t BufferMask) {
-    const ResourceState &Resource = *Resources[BufferMask];
+    const ResourceState &Resource = getResource(BufferMask);
     return Resource.isInOrder() || Resource.isADispatchHazard();
   });
   if (!AllInOrderResources)
     return false;
 
   return any_of(Desc.Buffers, [&](uint64_t BufferMask) {
-    return Resources[BufferMask]->isADispatchHazard();
+    return getResource(BufferMask).isADispatchHazard();
   });
 }
 
@@ -190,7 +223,7 @@ void ResourceManager::issueInstruction(
       use(Pipe);
       BusyResources[Pipe] += CS.size();
       // Replace the resource mask with a valid processor resource index.
-      const ResourceState &RS = *Resources[Pipe.first];
+      const ResourceState &RS = getResource(Pipe.first);
       Pipe.first = RS.getProcResourceID();
       Pipes.emplace_back(
           std::pair<ResourceRef, double>(Pipe, static_cast<double>(CS.size())));
@@ -229,6 +262,8 @@ void Scheduler::dump() const {
   dbgs() << "[SCHEDULER]: WaitQueue size is: " << WaitQueue.size() << '\n';
   dbgs() << "[SCHEDULER]: ReadyQueue size is: " << ReadyQueue.size() << '\n';
   dbgs() << "[SCHEDULER]: IssuedQueue size is: " << IssuedQueue.size() << '\n';
+  dbgs() << "[SCHEDULER]: Number of blocked instructions is: "
+         << BlockedInstructions.size() << '\n';
   Resources->dump();
 }
 #endif
@@ -270,11 +305,29 @@ void Scheduler::issueInstructionImpl(
   // Notify the instruction that it started executing.
   // This updates the internal state of each write.
   IS->execute();
+  wakeUpUsers(*IS);
 
   if (IS->isExecuting())
     IssuedQueue[IR.getSourceIndex()] = IS;
 }
 
+void Scheduler::wakeUpUsers(const Instruction &IS) {
+  if (BlockedInstructions.empty())
+    return;
+
+  for (const std::unique_ptr<WriteState> &Def : IS.getDefs()) {
+    for (const std::pair<ReadState *, int> &User : Def->getUsers()) {
+      auto It = BlockedInstructions.find(User.first->getOwner());
+      if (It == BlockedInstructions.end())
+        continue;
+      LLVM_DEBUG(dbgs() << "[SCHEDULER] Moving #" << It->second
+                        << " back to the Wait Queue\n");
+      WaitQueue[It->second] = It->first;
+      BlockedInstructions.erase(It);
+    }
+  }
+}
+
 // Release the buffered resources and issue the instruction.
 void Scheduler::issueInstruction(
     InstRef &IR,
@@ -299,6 +352,16 @@ void Scheduler::promoteToReadyQueue(SmallVectorImpl<InstRef> &Ready) {
     const InstrDesc &Desc = IS->getDesc();
     bool IsMemOp = Desc.MayLoad || Desc.MayStore;
     if (!IS->isReady() || (IsMemOp && !LSU->isReady({IID, IS}))) {
+      // Stop tracking instructions that can't progress until one of their
+      // dependencies is issued. Memory operations are left in the queue, as
+      // their readiness also depends on the LSU.
+      if (!IsMemOp && IS->isWaitingOnUnissuedWrites()) {
+        BlockedInstructions[IS] = IID;
+        auto ToRemove = I;
+        ++I;
+        WaitQueue.erase(ToRemove);
+        continue;
+      }
       ++I;
       continue;
     }
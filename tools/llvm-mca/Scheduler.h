@@ -25,6 +25,7 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/MC/MCSubtargetInfo.h"
 #include <map>
+#include <vector>
 
 namespace mca {
 
@@ -274,7 +275,25 @@ typedef std::pair<unsigned, unsigned> BufferUsageEntry;
 class ResourceManager {
   // The resource manager owns all the ResourceState.
   using UniqueResourceState = std::unique_ptr<ResourceState>;
-  llvm::SmallDenseMap<uint64_t, UniqueResourceState> Resources;
+  // Indexed by the position of the most significant bit of the resource mask
+  // (see getResourceStateIndex).
+  std::vector<UniqueResourceState> Resources;
+
+  // Bitmasks of resources that can be used right now. A resource is
+  // identified by the most significant bit of its mask, which is unique to
+  // it (see computeProcResourceMasks).
+  //
+  // ReadyResources has a bit set for every resource with at least one
+  // available unit, that is not reserved (i.e. ResourceState::isReady()).
+  // UnreservedResources has a bit set for every resource that is not reserved
+  // (i.e. ResourceState::isReady(0)). These masks allow canBeIssued() to check
+  // most instructions with a couple of bitwise operations.
+  uint64_t ReadyResources;
+  uint64_t UnreservedResources;
+
+  // For every resource, the mask of the groups that contain it (one bit per
+  // group, as above).
+  std::vector<uint64_t> Resource2Groups;
 
   // Keeps track of which resources are busy, and how many cycles are left
   // before those become usable again.
@@ -291,6 +310,36 @@ class ResourceManager {
   // Populate resource descriptors.
   void initialize(const llvm::MCSchedModel &SM);
 
+  static unsigned getResourceStateIndex(uint64_t Mask) {
+    return Mask ? llvm::Log2_64(Mask) + 1 : 0;
+  }
+
+  ResourceState &getResource(uint64_t Mask) {
+    assert(getResourceStateIndex(Mask) < Resources.size() &&
+           "Invalid resource mask!");
+    return *Resources[getResourceStateIndex(Mask)];
+  }
+
+  const ResourceState &getResource(uint64_t Mask) const {
+    assert(getResourceStateIndex(Mask) < Resources.size() &&
+           "Invalid resource mask!");
+    return *Resources[getResourceStateIndex(Mask)];
+  }
+
+  // Updates ReadyResources and UnreservedResources after a change to the
+  // state of RS.
+  void updateAvailability(const ResourceState &RS) {
+    uint64_t Bit = llvm::PowerOf2Floor(RS.getResourceMask());
+    if (RS.isReady())
+      ReadyResources |= Bit;
+    else
+      ReadyResources &= ~Bit;
+    if (RS.isReady(0))
+      UnreservedResources |= Bit;
+    else
+      UnreservedResources &= ~Bit;
+  }
+
   // Returns the actual resource unit that will be used.
   ResourceRef selectPipe(uint64_t ResourceID);
 
@@ -298,35 +347,32 @@ class ResourceManager {
   void release(ResourceRef RR);
 
   unsigned getNumUnits(uint64_t ResourceID) const {
-    assert(Resources.find(ResourceID) != Resources.end());
-    return Resources.find(ResourceID)->getSecond()->getNumUnits();
+    return getResource(ResourceID).getNumUnits();
   }
 
   // Reserve a specific Resource kind.
   void reserveBuffer(uint64_t ResourceID) {
     assert(isBufferAvailable(ResourceID) ==
            ResourceStateEvent::RS_BUFFER_AVAILABLE);
-    ResourceState &Resource = *Resources[ResourceID];
-    Resource.reserveBuffer();
+    getResource(ResourceID).reserveBuffer();
   }
 
   void releaseBuffer(uint64_t ResourceID) {
-    Resources[ResourceID]->releaseBuffer();
+    getResource(ResourceID).releaseBuffer();
   }
 
   ResourceStateEvent isBufferAvailable(uint64_t ResourceID) const {
-    const ResourceState &Resource = *Resources.find(ResourceID)->second;
-    return Resource.isBufferAvailable();
+    return getResource(ResourceID).isBufferAvailable();
   }
 
   bool isReady(uint64_t ResourceID, unsigned NumUnits) const {
-    const ResourceState &Resource = *Resources.find(ResourceID)->second;
-    return Resource.isReady(NumUnits);
+    return getResource(ResourceID).isReady(NumUnits);
   }
 
 public:
   ResourceManager(const llvm::MCSchedModel &SM)
-      : ProcResID2Mask(SM.getNumProcResourceKinds()) {
+      : ReadyResources(0), UnreservedResources(0),
+        ProcResID2Mask(SM.getNumProcResourceKinds()) {
     initialize(SM);
   }
 
@@ -336,7 +382,7 @@ public:
 
   // Return the processor resource identifier associated to this Mask.
   unsigned resolveResourceMask(uint64_t Mask) const {
-    return Resources.find(Mask)->second->getProcResourceID();
+    return getResource(Mask).getProcResourceID();
   }
 
   // Consume a slot in every buffered resource from array 'Buffers'. Resource
@@ -347,14 +393,16 @@ public:
   void releaseBuffers(llvm::ArrayRef<uint64_t> Buffers);
 
   void reserveResource(uint64_t ResourceID) {
-    ResourceState &Resource = *Resources[ResourceID];
+    ResourceState &Resource = getResource(ResourceID);
     assert(!Resource.isReserved());
     Resource.setReserved();
+    updateAvailability(Resource);
   }
 
   void releaseResource(uint64_t ResourceID) {
-    ResourceState &Resource = *Resources[ResourceID];
+    ResourceState &Resource = getResource(ResourceID);
     Resource.clearReserved();
+    updateAvailability(Resource);
   }
 
   // Returns true if all resources are in-order, and there is at least one
@@ -371,8 +419,9 @@ public:
 
 #ifndef NDEBUG
   void dump() const {
-    for (const std::pair<uint64_t, UniqueResourceState> &Resource : Resources)
-      Resource.second->dump();
+    for (const UniqueResourceState &Resource : Resources)
+      if (Resource)
+        Resource->dump();
   }
 #endif
 }; // namespace mca
@@ -402,6 +451,12 @@ public:
 /// issued to a (one or more) pipeline(s). This event also causes an instruction
 /// state transition (i.e. from state IS_READY, to state IS_EXECUTING).
 /// An Instruction leaves the IssuedQueue when it reaches the write-back stage.
+///
+/// Instructions of the WaitQueue that can't make progress until another
+/// instruction is issued (see Instruction::isWaitingOnUnissuedWrites()) are
+/// parked in 'BlockedInstructions', so that they are not visited at every
+/// cycle. They return to the WaitQueue when one of the instructions that they
+/// depend on is issued.
 class Scheduler : public HardwareUnit {
   const llvm::MCSchedModel &SM;
 
@@ -413,6 +468,12 @@ class Scheduler : public HardwareUnit {
   std::map<unsigned, Instruction *> WaitQueue;
   std::map<unsigned, Instruction *> ReadyQueue;
   std::map<unsigned, Instruction *> IssuedQueue;
+  // Maps instructions waiting on unissued writes to their index.
+  llvm::DenseMap<Instruction *, unsigned> BlockedInstructions;
+
+  /// Move the users of the registers written by IS from BlockedInstructions
+  /// back to the WaitQueue.
+  void wakeUpUsers(const Instruction &IS);
 
   /// Issue an instruction without updating the ready queue.
   void issueInstructionImpl(
@@ -507,6 +568,8 @@ public:
     assert(WaitQueue.find(Idx) == WaitQueue.end());
     assert(ReadyQueue.find(Idx) == ReadyQueue.end());
     assert(IssuedQueue.find(Idx) == IssuedQueue.end());
+    assert(BlockedInstructions.find(IR.getInstruction()) ==
+           BlockedInstructions.end());
   }
 #endif // !NDEBUG
 };
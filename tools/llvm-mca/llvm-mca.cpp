@@ -10,7 +10,7 @@
 // This utility is a simple driver that allows static performance analysis on
 // machine code similarly to how IACA (Intel Architecture Code Analyzer) works.
 //
-//   llvm-mca [options] <file-name>
+//   llvm-mca [options] <file-name>...
 //      -march <type>
 //      -mcpu <cpu>
 //      -o <file>
@@ -19,6 +19,9 @@
 // The cpu defaults to the 'native' host cpu.
 // The output defaults to standard output.
 //
+// The code regions of all the input files are simulated concurrently, and
+// reported in order.
+//
 //===----------------------------------------------------------------------===//
 
 #include "CodeRegion.h"
@@ -27,6 +30,7 @@
 #include "FetchStage.h"
 #include "InstructionInfoView.h"
 #include "InstructionTables.h"
+#include "JSONView.h"
 #include "Pipeline.h"
 #include "PipelinePrinter.h"
 #include "RegisterFileStatistics.h"
@@ -44,23 +48,30 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/WithColor.h"
+#include <chrono>
 
 using namespace llvm;
 
 static cl::OptionCategory ToolOptions("Tool Options");
 static cl::OptionCategory ViewOptions("View Options");
 
-static cl::opt<std::string> InputFilename(cl::Positional,
-                                          cl::desc("<input file>"),
-                                          cl::cat(ToolOptions), cl::init("-"));
+static cl::list<std::string> InputFilenames(cl::Positional,
+                                            cl::desc("<input files>"),
+                                            cl::ZeroOrMore,
+                                            cl::cat(ToolOptions));
 
 static cl::opt<std::string> OutputFilename("o", cl::desc("Output filename"),
                                            cl::init("-"), cl::cat(ToolOptions),
@@ -163,6 +174,27 @@ static cl::opt<bool>
                            cl::desc("Print instruction tables"),
                            cl::cat(ToolOptions), cl::init(false));
 
+static cl::opt<unsigned>
+    NumThreads("num-threads",
+               cl::desc("Number of code regions to simulate concurrently "
+                        "(defaults to the number of cores)"),
+               cl::cat(ToolOptions), cl::init(0));
+
+static cl::alias NumThreadsA("j", cl::desc("Alias for -num-threads"),
+                             cl::aliasopt(NumThreads), cl::cat(ToolOptions));
+
+static cl::opt<bool> PrintSimulationSpeed(
+    "print-simulation-speed",
+    cl::desc("Print the number of simulated cycles per second of every code "
+             "region to standard error"),
+    cl::cat(ToolOptions), cl::init(false));
+
+static cl::opt<bool>
+    PrintJSON("json",
+              cl::desc("Print a JSON report of every code region instead of "
+                       "the views"),
+              cl::cat(ViewOptions), cl::init(false));
+
 static cl::opt<bool> PrintInstructionInfoView(
     "instruction-info",
     cl::desc("Print the instruction info view (enabled by default)"),
@@ -295,6 +327,35 @@ public:
     return Regions.getInstructionSequence(Index);
   }
 };
+
+// An assembly file, and the code regions found in it. The regions reference
+// expressions owned by the MCContext, so both are kept alive until all the
+// regions have been simulated.
+struct InputFile {
+  std::string Name;
+  SourceMgr SrcMgr;
+  MCObjectFileInfo MOFI;
+  std::unique_ptr<MCContext> Ctx;
+  std::unique_ptr<mca::CodeRegions> Regions;
+
+  InputFile(StringRef Name) : Name(Name) {}
+};
+
+// A code region to simulate, and the report produced for it.
+struct RegionJob {
+  const InputFile *Input;
+  const mca::CodeRegion *Region;
+  // The index printed in the region header, or -1 if there is no header.
+  int Index;
+  std::string Report;
+  json::Object JSON;
+  // The number of simulated cycles, and the time it took to simulate them.
+  unsigned Cycles;
+  double Seconds;
+
+  RegionJob(const InputFile *I, const mca::CodeRegion *R, int Idx)
+      : Input(I), Region(R), Index(Idx), Cycles(0), Seconds(0.0) {}
+};
 } // end of anonymous namespace
 
 static void processOptionImpl(cl::opt<bool> &O, const cl::opt<bool> &Default) {
@@ -325,6 +386,107 @@ static void processViewOptions() {
   processOptionImpl(PrintRetireStats, Default);
 }
 
+// Runs the simulation of a code region, and records how long it took.
+static void runPipeline(mca::Pipeline &P, RegionJob &Job) {
+  auto Start = std::chrono::steady_clock::now();
+  P.run();
+  std::chrono::duration<double> Elapsed =
+      std::chrono::steady_clock::now() - Start;
+  Job.Cycles = P.getNumCycles();
+  Job.Seconds = Elapsed.count();
+}
+
+// Prints the number of simulated cycles and the simulation throughput.
+static void printSimulationSpeed(raw_ostream &OS, unsigned Cycles,
+                                 double Seconds) {
+  OS << format("simulated %u cycles in %.3fs", Cycles, Seconds);
+  if (Seconds > 0.0)
+    OS << format(" (%.0f cycles/s)", Cycles / Seconds);
+  OS << '\n';
+}
+
+// Simulate the code region of Job, and store the report in it.
+//
+// This can run concurrently with the simulation of other regions. Everything
+// that is shared is either read-only or, like the instruction builder,
+// internally synchronized. Instruction printers keep state while printing, so
+// IP must not be shared with concurrent simulations.
+static void analyzeRegion(RegionJob &Job, const MCSubtargetInfo &STI,
+                          const MCInstrInfo &MCII, const MCRegisterInfo &MRI,
+                          mca::InstrBuilder &IB, MCInstPrinter &IP,
+                          const mca::PipelineOptions &PO) {
+  const MCSchedModel &SM = STI.getSchedModel();
+  raw_string_ostream OS(Job.Report);
+
+  mca::SourceMgr S(Job.Region->getInstructions(),
+                   PrintInstructionTables ? 1 : Iterations);
+
+  if (PrintInstructionTables) {
+    //  Create a pipeline, stages, and a printer.
+    auto P = llvm::make_unique<mca::Pipeline>();
+    P->appendStage(llvm::make_unique<mca::FetchStage>(IB, S));
+    P->appendStage(llvm::make_unique<mca::InstructionTables>(SM, IB));
+    mca::PipelinePrinter Printer(*P);
+
+    // Create the views for this pipeline, execute, and emit a report.
+    if (PrintInstructionInfoView) {
+      Printer.addView(
+          llvm::make_unique<mca::InstructionInfoView>(STI, MCII, S, IP));
+    }
+    Printer.addView(llvm::make_unique<mca::ResourcePressureView>(STI, IP, S));
+    P->run();
+    Printer.printReport(OS);
+    return;
+  }
+
+  // Create a context to control ownership of the pipeline hardware, and a
+  // basic pipeline simulating an out-of-order backend.
+  mca::Context MCA(MRI, STI);
+  auto P = MCA.createDefaultPipeline(PO, IB, S);
+  mca::PipelinePrinter Printer(*P);
+
+  if (PrintJSON) {
+    auto JV = llvm::make_unique<mca::JSONView>(SM, S, PO.DispatchWidth);
+    const mca::JSONView &View = *JV;
+    Printer.addView(std::move(JV));
+    runPipeline(*P, Job);
+    Job.JSON = View.toJSON();
+    return;
+  }
+
+  if (PrintSummaryView)
+    Printer.addView(
+        llvm::make_unique<mca::SummaryView>(SM, S, PO.DispatchWidth));
+
+  if (PrintInstructionInfoView)
+    Printer.addView(
+        llvm::make_unique<mca::InstructionInfoView>(STI, MCII, S, IP));
+
+  if (PrintDispatchStats)
+    Printer.addView(llvm::make_unique<mca::DispatchStatistics>());
+
+  if (PrintSchedulerStats)
+    Printer.addView(llvm::make_unique<mca::SchedulerStatistics>(STI));
+
+  if (PrintRetireStats)
+    Printer.addView(llvm::make_unique<mca::RetireControlUnitStatistics>());
+
+  if (PrintRegisterFileStats)
+    Printer.addView(llvm::make_unique<mca::RegisterFileStatistics>(STI));
+
+  if (PrintResourcePressureView)
+    Printer.addView(llvm::make_unique<mca::ResourcePressureView>(STI, IP, S));
+
+  if (PrintTimelineView) {
+    Printer.addView(llvm::make_unique<mca::TimelineView>(
+        STI, IP, S, TimelineMaxIterations, TimelineMaxCycles));
+  }
+
+  runPipeline(*P, Job);
+  Printer.printReport(OS);
+}
+
+
 int main(int argc, char **argv) {
   InitLLVM X(argc, argv);
 
@@ -357,20 +519,30 @@ int main(int argc, char **argv) {
   // For safety, reconstruct the Triple object.
   Triple TheTriple(TripleName);
 
-  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferPtr =
-      MemoryBuffer::getFileOrSTDIN(InputFilename);
-  if (std::error_code EC = BufferPtr.getError()) {
-    WithColor::error() << InputFilename << ": " << EC.message() << '\n';
+  // Apply overrides to llvm-mca specific options.
+  processViewOptions();
+
+  if (PrintJSON && PrintInstructionTables) {
+    WithColor::error() << "-json is not supported with -instruction-tables.\n";
     return 1;
   }
 
-  // Apply overrides to llvm-mca specific options.
-  processViewOptions();
+  if (InputFilenames.empty())
+    InputFilenames.push_back("-");
 
-  SourceMgr SrcMgr;
+  std::vector<std::unique_ptr<InputFile>> Inputs;
+  for (const std::string &Filename : InputFilenames) {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> BufferPtr =
+        MemoryBuffer::getFileOrSTDIN(Filename);
+    if (std::error_code EC = BufferPtr.getError()) {
+      WithColor::error() << Filename << ": " << EC.message() << '\n';
+      return 1;
+    }
 
-  // Tell SrcMgr about this buffer, which is what the parser will pick up.
-  SrcMgr.AddNewSourceBuffer(std::move(*BufferPtr), SMLoc());
+    Inputs.push_back(llvm::make_unique<InputFile>(Filename));
+    // Tell SrcMgr about this buffer, which is what the parser will pick up.
+    Inputs.back()->SrcMgr.AddNewSourceBuffer(std::move(*BufferPtr), SMLoc());
+  }
 
   std::unique_ptr<MCRegisterInfo> MRI(TheTarget->createMCRegInfo(TripleName));
   assert(MRI && "Unable to create target register info!");
@@ -378,15 +550,6 @@ int main(int argc, char **argv) {
   std::unique_ptr<MCAsmInfo> MAI(TheTarget->createMCAsmInfo(*MRI, TripleName));
   assert(MAI && "Unable to create target asm info!");
 
-  MCObjectFileInfo MOFI;
-  MCContext Ctx(MAI.get(), MRI.get(), &MOFI, &SrcMgr);
-  MOFI.InitMCObjectFileInfo(TheTriple, /* PIC= */ false, Ctx);
-
-  std::unique_ptr<buffer_ostream> BOS;
-
-  mca::CodeRegions Regions(SrcMgr);
-  MCStreamerWrapper Str(Ctx, Regions);
-
   std::unique_ptr<MCInstrInfo> MCII(TheTarget->createMCInstrInfo());
 
   std::unique_ptr<MCInstrAnalysis> MCIA(
@@ -419,17 +582,50 @@ int main(int argc, char **argv) {
     return 1;
   }
 
-  std::unique_ptr<MCAsmParser> P(createMCAsmParser(SrcMgr, Ctx, Str, *MAI));
-  MCAsmLexer &Lexer = P->getLexer();
-  MCACommentConsumer CC(Regions);
-  Lexer.setCommentConsumer(&CC);
-
-  if (AssembleInput(ProgName, *P, TheTarget, *STI, *MCII, MCOptions))
-    return 1;
-
-  if (Regions.empty()) {
-    WithColor::error() << "no assembly instructions found.\n";
-    return 1;
+  // Assemble the inputs, and collect the code regions to simulate. Every input
+  // gets its own context, but the target description is shared.
+  unsigned AssemblerDialect = 0;
+  std::vector<RegionJob> Jobs;
+  for (std::unique_ptr<InputFile> &Input : Inputs) {
+    Input->Ctx = llvm::make_unique<MCContext>(MAI.get(), MRI.get(),
+                                              &Input->MOFI, &Input->SrcMgr);
+    Input->MOFI.InitMCObjectFileInfo(TheTriple, /* PIC= */ false, *Input->Ctx);
+
+    Input->Regions = llvm::make_unique<mca::CodeRegions>(Input->SrcMgr);
+    MCStreamerWrapper Str(*Input->Ctx, *Input->Regions);
+
+    std::unique_ptr<MCAsmParser> P(
+        createMCAsmParser(Input->SrcMgr, *Input->Ctx, Str, *MAI));
+    MCAsmLexer &Lexer = P->getLexer();
+    MCACommentConsumer CC(*Input->Regions);
+    Lexer.setCommentConsumer(&CC);
+
+    if (AssembleInput(ProgName, *P, TheTarget, *STI, *MCII, MCOptions))
+      return 1;
+
+    if (Input->Regions->empty()) {
+      WithColor::error() << "no assembly instructions found";
+      if (Inputs.size() > 1)
+        errs() << " in '" << Input->Name << "'";
+      errs() << ".\n";
+      return 1;
+    }
+    AssemblerDialect = P->getAssemblerDialect();
+
+    // Number each region in the sequence.
+    int RegionIdx = 0;
+    for (const std::unique_ptr<mca::CodeRegion> &Region : *Input->Regions) {
+      // Skip empty code regions.
+      if (Region->empty())
+        continue;
+
+      // Don't print the header of this region if it is the default region, and
+      // it doesn't have an end location.
+      int Index = -1;
+      if (Region->startLoc().isValid() || Region->endLoc().isValid())
+        Index = RegionIdx++;
+      Jobs.emplace_back(Input.get(), Region.get(), Index);
+    }
   }
 
   // Now initialize the output file.
@@ -439,11 +635,13 @@ int main(int argc, char **argv) {
     return 1;
   }
 
-  unsigned AssemblerDialect = P->getAssemblerDialect();
   if (OutputAsmVariant >= 0)
     AssemblerDialect = static_cast<unsigned>(OutputAsmVariant);
-  std::unique_ptr<MCInstPrinter> IP(TheTarget->createMCInstPrinter(
-      Triple(TripleName), AssemblerDialect, *MAI, *MCII, *MRI));
+  auto CreateInstPrinter = [&]() {
+    return std::unique_ptr<MCInstPrinter>(TheTarget->createMCInstPrinter(
+        Triple(TripleName), AssemblerDialect, *MAI, *MCII, *MRI));
+  };
+  std::unique_ptr<MCInstPrinter> IP = CreateInstPrinter();
   if (!IP) {
     WithColor::error()
         << "unable to create instruction printer for target triple '"
@@ -460,91 +658,86 @@ int main(int argc, char **argv) {
   if (DispatchWidth)
     Width = DispatchWidth;
 
-  // Create an instruction builder.
+  // Create an instruction builder. It is shared by all the regions, so that
+  // instruction descriptors are only computed once per opcode.
   mca::InstrBuilder IB(*STI, *MCII, *MRI, *MCIA, *IP);
 
-  // Create a context to control ownership of the pipeline hardware.
-  mca::Context MCA(*MRI, *STI);
-
   mca::PipelineOptions PO(Width, RegisterFileSize, LoadQueueSize,
                           StoreQueueSize, AssumeNoAlias);
 
-  // Number each region in the sequence.
-  unsigned RegionIdx = 0;
-  for (const std::unique_ptr<mca::CodeRegion> &Region : Regions) {
-    // Skip empty code regions.
-    if (Region->empty())
-      continue;
-
-    // Don't print the header of this region if it is the default region, and
-    // it doesn't have an end location.
-    if (Region->startLoc().isValid() || Region->endLoc().isValid()) {
-      TOF->os() << "\n[" << RegionIdx++ << "] Code Region";
-      StringRef Desc = Region->getDescription();
-      if (!Desc.empty())
-        TOF->os() << " - " << Desc;
-      TOF->os() << "\n\n";
+  // Simulate the regions. Reports are buffered, and printed in order below.
+  unsigned Threads =
+      NumThreads ? NumThreads : llvm::heavyweight_hardware_concurrency();
+  if (Threads > Jobs.size())
+    Threads = Jobs.size();
+  if (Threads <= 1) {
+    for (RegionJob &Job : Jobs)
+      analyzeRegion(Job, *STI, *MCII, *MRI, IB, *IP, PO);
+  } else {
+    ThreadPool Pool(Threads);
+    for (RegionJob &Job : Jobs) {
+      RegionJob *J = &Job;
+      Pool.async([&, J]() {
+        std::unique_ptr<MCInstPrinter> JobIP = CreateInstPrinter();
+        analyzeRegion(*J, *STI, *MCII, *MRI, IB, *JobIP, PO);
+      });
     }
+    Pool.wait();
+  }
 
-    mca::SourceMgr S(Region->getInstructions(),
-                     PrintInstructionTables ? 1 : Iterations);
-
-    if (PrintInstructionTables) {
-      //  Create a pipeline, stages, and a printer.
-      auto P = llvm::make_unique<mca::Pipeline>();
-      P->appendStage(llvm::make_unique<mca::FetchStage>(IB, S));
-      P->appendStage(llvm::make_unique<mca::InstructionTables>(SM, IB));
-      mca::PipelinePrinter Printer(*P);
+  // Instruction tables are computed without a simulation.
+  if (PrintSimulationSpeed && !PrintInstructionTables) {
+    unsigned TotalCycles = 0;
+    double TotalSeconds = 0.0;
+    for (const RegionJob &Job : Jobs) {
+      errs() << Job.Input->Name;
+      if (Job.Index >= 0)
+        errs() << " [" << Job.Index << "]";
+      errs() << ": ";
+      printSimulationSpeed(errs(), Job.Cycles, Job.Seconds);
+      TotalCycles += Job.Cycles;
+      TotalSeconds += Job.Seconds;
+    }
+    errs() << "total: ";
+    printSimulationSpeed(errs(), TotalCycles, TotalSeconds);
+  }
 
-      // Create the views for this pipeline, execute, and emit a report.
-      if (PrintInstructionInfoView) {
-        Printer.addView(
-            llvm::make_unique<mca::InstructionInfoView>(*STI, *MCII, S, *IP));
+  if (PrintJSON) {
+    json::Array Regions;
+    for (RegionJob &Job : Jobs) {
+      Job.JSON["file"] = Job.Input->Name;
+      if (Job.Index >= 0) {
+        Job.JSON["region"] = Job.Index;
+        Job.JSON["description"] = Job.Region->getDescription();
       }
-      Printer.addView(
-          llvm::make_unique<mca::ResourcePressureView>(*STI, *IP, S));
-      P->run();
-      Printer.printReport(TOF->os());
-      continue;
+      Regions.push_back(std::move(Job.JSON));
     }
+    json::Value Report = json::Object{{"triple", TheTriple.normalize()},
+                                      {"cpu", MCPU},
+                                      {"regions", std::move(Regions)}};
+    TOF->os() << formatv("{0:2}", Report) << '\n';
+    TOF->keep();
+    return 0;
+  }
 
-    // Create a basic pipeline simulating an out-of-order backend.
-    auto P = MCA.createDefaultPipeline(PO, IB, S);
-    mca::PipelinePrinter Printer(*P);
-
-    if (PrintSummaryView)
-      Printer.addView(llvm::make_unique<mca::SummaryView>(SM, S, Width));
-
-    if (PrintInstructionInfoView)
-      Printer.addView(
-          llvm::make_unique<mca::InstructionInfoView>(*STI, *MCII, S, *IP));
-
-    if (PrintDispatchStats)
-      Printer.addView(llvm::make_unique<mca::DispatchStatistics>());
-
-    if (PrintSchedulerStats)
-      Printer.addView(llvm::make_unique<mca::SchedulerStatistics>(*STI));
-
-    if (PrintRetireStats)
-      Printer.addView(llvm::make_unique<mca::RetireControlUnitStatistics>());
-
-    if (PrintRegisterFileStats)
-      Printer.addView(llvm::make_unique<mca::RegisterFileStatistics>(*STI));
-
-    if (PrintResourcePressureView)
-      Printer.addView(
-          llvm::make_unique<mca::ResourcePressureView>(*STI, *IP, S));
-
-    if (PrintTimelineView) {
-      Printer.addView(llvm::make_unique<mca::TimelineView>(
-          *STI, *IP, S, TimelineMaxIterations, TimelineMaxCycles));
+  const InputFile *LastInput = nullptr;
+  for (const RegionJob &Job : Jobs) {
+    // Name the file before its regions if there are several.
+    bool PrintName = Inputs.size() > 1 && Job.Input != LastInput;
+    if (PrintName)
+      TOF->os() << "\n" << Job.Input->Name << ":\n";
+    LastInput = Job.Input;
+
+    if (Job.Index >= 0) {
+      TOF->os() << "\n[" << Job.Index << "] Code Region";
+      StringRef Desc = Job.Region->getDescription();
+      if (!Desc.empty())
+        TOF->os() << " - " << Desc;
+      TOF->os() << "\n\n";
+    } else if (PrintName) {
+      TOF->os() << "\n";
     }
-
-    P->run();
-    Printer.printReport(TOF->os());
-
-    // Clear the InstrBuilder internal state in preparation for another round.
-    IB.clear();
+    TOF->os() << Job.Report;
   }
 
   TOF->keep();
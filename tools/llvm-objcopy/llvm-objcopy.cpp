@@ -30,6 +30,7 @@
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/FileOutputBuffer.h"
 #include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
@@ -536,16 +537,26 @@ static void ExecuteElfObjcopyOnArchive(const CopyConfig &Config, const Archive &
 }
 
 static void ExecuteElfObjcopy(const CopyConfig &Config) {
-  Expected<OwningBinary<llvm::object::Binary>> BinaryOrErr =
-      createBinary(Config.InputFilename);
+  // The sections of the object reference their contents in the input buffer,
+  // and the writer copies them straight from there to the output file, so the
+  // input should be mapped rather than read into memory. It doesn't need a
+  // null terminator; asking for one would make MemoryBuffer read files whose
+  // size is a multiple of the page size.
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufOrErr =
+      MemoryBuffer::getFileOrSTDIN(Config.InputFilename, /*FileSize=*/-1,
+                                   /*RequiresNullTerminator=*/false);
+  if (!BufOrErr)
+    reportError(Config.InputFilename, BufOrErr.getError());
+  Expected<std::unique_ptr<Binary>> BinaryOrErr =
+      createBinary((*BufOrErr)->getMemBufferRef());
   if (!BinaryOrErr)
     reportError(Config.InputFilename, BinaryOrErr.takeError());
 
-  if (Archive *Ar = dyn_cast<Archive>(BinaryOrErr.get().getBinary()))
+  if (Archive *Ar = dyn_cast<Archive>(BinaryOrErr->get()))
     return ExecuteElfObjcopyOnArchive(Config, *Ar);
 
   FileBuffer FB(Config.OutputFilename);
-  ExecuteElfObjcopyOnBinary(Config, *BinaryOrErr.get().getBinary(), FB);
+  ExecuteElfObjcopyOnBinary(Config, **BinaryOrErr, FB);
 }
 
 // ParseObjcopyOptions returns the config and sets the input arguments. If a
@@ -41,6 +41,7 @@
 #include "llvm/DebugInfo/CodeView/DebugChecksumsSubsection.h"
 #include "llvm/DebugInfo/CodeView/DebugInlineeLinesSubsection.h"
 #include "llvm/DebugInfo/CodeView/DebugLinesSubsection.h"
+#include "llvm/DebugInfo/CodeView/GlobalTypeTableBuilder.h"
 #include "llvm/DebugInfo/CodeView/LazyRandomTypeCollection.h"
 #include "llvm/DebugInfo/CodeView/MergingTypeTableBuilder.h"
 #include "llvm/DebugInfo/CodeView/StringsAndChecksums.h"
@@ -628,6 +629,15 @@ cl::list<std::string> InputFilenames(cl::Positional,
 cl::opt<std::string>
     PdbOutputFile("pdb", cl::desc("the name of the PDB file to write"),
                   cl::sub(MergeSubcommand));
+cl::opt<bool>
+    GlobalHashes("ghash",
+                 cl::desc("merge the input types by their global hashes"),
+                 cl::sub(MergeSubcommand));
+cl::opt<unsigned>
+    NumThreads("num-threads",
+               cl::desc("the number of threads to compute the global hashes "
+                        "with (0 = one per hardware thread)"),
+               cl::init(0), cl::sub(MergeSubcommand));
 }
 
 namespace explain {
@@ -1165,30 +1175,9 @@ static void dumpPretty(StringRef Path) {
   outs().flush();
 }
 
-static void mergePdbs() {
-  BumpPtrAllocator Allocator;
-  MergingTypeTableBuilder MergedTpi(Allocator);
-  MergingTypeTableBuilder MergedIpi(Allocator);
-
-  // Create a Tpi and Ipi type table with all types from all input files.
-  for (const auto &Path : opts::merge::InputFilenames) {
-    std::unique_ptr<IPDBSession> Session;
-    auto &File = loadPDB(Path, Session);
-    SmallVector<TypeIndex, 128> TypeMap;
-    SmallVector<TypeIndex, 128> IdMap;
-    if (File.hasPDBTpiStream()) {
-      auto &Tpi = ExitOnErr(File.getPDBTpiStream());
-      ExitOnErr(
-          codeview::mergeTypeRecords(MergedTpi, TypeMap, Tpi.typeArray()));
-    }
-    if (File.hasPDBIpiStream()) {
-      auto &Ipi = ExitOnErr(File.getPDBIpiStream());
-      ExitOnErr(codeview::mergeIdRecords(MergedIpi, TypeMap, IdMap,
-                                         Ipi.typeArray()));
-    }
-  }
-
-  // Then write the PDB.
+static void writeMergedPdb(BumpPtrAllocator &Allocator,
+                           TypeCollection &MergedTpi,
+                           TypeCollection &MergedIpi) {
   PDBFileBuilder Builder(Allocator);
   ExitOnErr(Builder.initialize(4096));
   // Add each of the reserved streams.  We might not put any data in them,
@@ -1214,6 +1203,65 @@ static void mergePdbs() {
   ExitOnErr(Builder.commit(OutFile));
 }
 
+static void mergePdbsByGlobalHash() {
+  BumpPtrAllocator Allocator;
+  GlobalTypeTableBuilder MergedTpi(Allocator);
+  GlobalTypeTableBuilder MergedIpi(Allocator);
+
+  // Open all the input files first, so that their streams can be hashed
+  // concurrently.
+  std::vector<std::unique_ptr<IPDBSession>> Sessions;
+  std::vector<TypeAndIdStreams> Sources;
+  for (const auto &Path : opts::merge::InputFilenames) {
+    std::unique_ptr<IPDBSession> Session;
+    auto &File = loadPDB(Path, Session);
+    TypeAndIdStreams Source;
+    if (File.hasPDBTpiStream())
+      Source.Types = &ExitOnErr(File.getPDBTpiStream()).typeArray();
+    if (File.hasPDBIpiStream())
+      Source.Ids = &ExitOnErr(File.getPDBIpiStream()).typeArray();
+    Sources.push_back(Source);
+    Sessions.push_back(std::move(Session));
+  }
+
+  // Create a Tpi and Ipi type table with all types from all input files.
+  ExitOnErr(codeview::mergeTypeStreams(MergedIpi, MergedTpi, Sources,
+                                       opts::merge::NumThreads));
+
+  writeMergedPdb(Allocator, MergedTpi, MergedIpi);
+}
+
+static void mergePdbs() {
+  if (opts::merge::GlobalHashes) {
+    mergePdbsByGlobalHash();
+    return;
+  }
+
+  BumpPtrAllocator Allocator;
+  MergingTypeTableBuilder MergedTpi(Allocator);
+  MergingTypeTableBuilder MergedIpi(Allocator);
+
+  // Create a Tpi and Ipi type table with all types from all input files.
+  for (const auto &Path : opts::merge::InputFilenames) {
+    std::unique_ptr<IPDBSession> Session;
+    auto &File = loadPDB(Path, Session);
+    SmallVector<TypeIndex, 128> TypeMap;
+    SmallVector<TypeIndex, 128> IdMap;
+    if (File.hasPDBTpiStream()) {
+      auto &Tpi = ExitOnErr(File.getPDBTpiStream());
+      ExitOnErr(
+          codeview::mergeTypeRecords(MergedTpi, TypeMap, Tpi.typeArray()));
+    }
+    if (File.hasPDBIpiStream()) {
+      auto &Ipi = ExitOnErr(File.getPDBIpiStream());
+      ExitOnErr(codeview::mergeIdRecords(MergedIpi, TypeMap, IdMap,
+                                         Ipi.typeArray()));
+    }
+  }
+
+  writeMergedPdb(Allocator, MergedTpi, MergedIpi);
+}
+
 static void explain() {
   std::unique_ptr<IPDBSession> Session;
   InputFile IF =
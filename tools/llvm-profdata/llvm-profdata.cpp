@@ -23,6 +23,7 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/InitLLVM.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -235,25 +236,12 @@ static void mergeWriterContexts(WriterContext *Dst, WriterContext *Src) {
   });
 }
 
-static void mergeInstrProfile(const WeightedFileVector &Inputs,
-                              StringRef OutputFilename,
-                              ProfileFormat OutputFormat, bool OutputSparse,
-                              unsigned NumThreads) {
-  if (OutputFilename.compare("-") == 0)
-    exitWithError("Cannot write indexed profdata format to stdout.");
-
-  if (OutputFormat != PF_Binary && OutputFormat != PF_Compact_Binary &&
-      OutputFormat != PF_Text)
-    exitWithError("Unknown format is specified.");
-
-  std::error_code EC;
-  raw_fd_ostream Output(OutputFilename.data(), EC, sys::fs::F_None);
-  if (EC)
-    exitWithErrorCode(EC, OutputFilename);
-
-  std::mutex ErrorLock;
-  SmallSet<instrprof_error, 4> WriterErrorCodes;
-
+/// Merge \p Inputs into a single writer context, using up to \p NumThreads
+/// threads. Hard errors encountered while merging are fatal.
+static std::unique_ptr<WriterContext>
+mergeInputBatch(ArrayRef<WeightedFile> Inputs, bool OutputSparse,
+                unsigned NumThreads, std::mutex &ErrorLock,
+                SmallSet<instrprof_error, 4> &WriterErrorCodes) {
   // If NumThreads is not specified, auto-detect a good default.
   if (NumThreads == 0)
     NumThreads =
@@ -313,7 +301,74 @@ static void mergeInstrProfile(const WeightedFileVector &Inputs,
            WC->ErrWhence);
   }
 
-  InstrProfWriter &Writer = Contexts[0]->Writer;
+  return std::move(Contexts[0]);
+}
+
+static void mergeInstrProfile(const WeightedFileVector &Inputs,
+                              StringRef OutputFilename,
+                              ProfileFormat OutputFormat, bool OutputSparse,
+                              unsigned NumThreads, unsigned BatchSize,
+                              bool Incremental) {
+  if (OutputFilename.compare("-") == 0)
+    exitWithError("Cannot write indexed profdata format to stdout.");
+
+  if (OutputFormat != PF_Binary && OutputFormat != PF_Compact_Binary &&
+      OutputFormat != PF_Text)
+    exitWithError("Unknown format is specified.");
+
+  // In incremental mode the existing output profile is merged like any other
+  // input. It is read before the output file is opened (and truncated).
+  WeightedFileVector AllInputs;
+  if (Incremental && sys::fs::exists(OutputFilename))
+    AllInputs.push_back({OutputFilename, 1});
+  AllInputs.append(Inputs.begin(), Inputs.end());
+
+  if (BatchSize == 0)
+    BatchSize = AllInputs.size();
+
+  std::mutex ErrorLock;
+  SmallSet<instrprof_error, 4> WriterErrorCodes;
+
+  // Merge the inputs BatchSize at a time, so that only one batch of inputs
+  // is held in memory. The merged result of each batch but the last is
+  // spilled to a temporary indexed profile, which becomes the first input of
+  // the next batch.
+  FileRemover SpillRemover;
+  SmallString<128> SpillFilename;
+  std::unique_ptr<WriterContext> Merged;
+  for (size_t Begin = 0; Begin < AllInputs.size(); Begin += BatchSize) {
+    size_t End = std::min(Begin + BatchSize, AllInputs.size());
+    WeightedFileVector Batch;
+    if (!SpillFilename.empty())
+      Batch.push_back({SpillFilename.str(), 1});
+    Batch.append(AllInputs.begin() + Begin, AllInputs.begin() + End);
+
+    Merged = mergeInputBatch(Batch, OutputSparse, NumThreads, ErrorLock,
+                             WriterErrorCodes);
+    if (End == AllInputs.size())
+      break;
+
+    int FD;
+    SmallString<128> NextSpillFilename;
+    if (std::error_code EC = sys::fs::createTemporaryFile(
+            "profdata-merge", "profdata", FD, NextSpillFilename))
+      exitWithErrorCode(EC, "temporary file");
+    {
+      raw_fd_ostream Spill(FD, /*shouldClose=*/true);
+      Merged->Writer.write(Spill);
+    }
+    // This also removes the spill file consumed by the current batch.
+    SpillRemover.setFile(NextSpillFilename);
+    SpillFilename = NextSpillFilename;
+    Merged.reset();
+  }
+
+  std::error_code EC;
+  raw_fd_ostream Output(OutputFilename.data(), EC, sys::fs::F_None);
+  if (EC)
+    exitWithErrorCode(EC, OutputFilename);
+
+  InstrProfWriter &Writer = Merged->Writer;
   if (OutputFormat == PF_Text) {
     if (Error E = Writer.writeText(Output))
       exitWithError(std::move(E));
@@ -485,6 +540,15 @@ static int merge_main(int argc, const char *argv[]) {
       cl::desc("Number of merge threads to use (default: autodetect)"));
   cl::alias NumThreadsA("j", cl::desc("Alias for --num-threads"),
                         cl::aliasopt(NumThreads));
+  cl::opt<unsigned> BatchSize(
+      "batch-size", cl::init(0),
+      cl::desc("Number of inputs to merge at a time; partial results are "
+               "spilled to a temporary file between batches (default: all "
+               "inputs at once, only meaningful for -instr)"));
+  cl::opt<bool> Incremental(
+      "incremental", cl::init(false),
+      cl::desc("Merge the inputs into the existing output profile, if any "
+               "(only meaningful for -instr)"));
 
   cl::ParseCommandLineOptions(argc, argv, "LLVM profile data merger\n");
 
@@ -511,7 +575,7 @@ static int merge_main(int argc, const char *argv[]) {
 
   if (ProfileKind == instr)
     mergeInstrProfile(WeightedInputs, OutputFilename, OutputFormat,
-                      OutputSparse, NumThreads);
+                      OutputSparse, NumThreads, BatchSize, Incremental);
   else
     mergeSampleProfile(WeightedInputs, OutputFilename, OutputFormat);
 
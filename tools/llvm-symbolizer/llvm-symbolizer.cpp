@@ -15,6 +15,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/DebugInfo/Symbolize/DIPrinter.h"
 #include "llvm/DebugInfo/Symbolize/Symbolize.h"
@@ -25,9 +26,13 @@
 #include "llvm/Support/InitLLVM.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
+#include <set>
 #include <string>
+#include <tuple>
+#include <vector>
 
 using namespace llvm;
 using namespace symbolize;
@@ -90,11 +95,21 @@ static cl::opt<int> ClPrintSourceContextLines(
 static cl::opt<bool> ClVerbose("verbose", cl::init(false),
                                cl::desc("Print verbose line info"));
 
+static cl::opt<std::string>
+    ClIndexDir("index-dir", cl::init(""),
+               cl::desc("Directory of symbolization indexes, keyed by build "
+                        "ID. Missing indexes are built on first use"));
+
+static cl::opt<bool>
+    ClBatch("batch", cl::init(false),
+            cl::desc("Read all input before symbolizing it, in address order "
+                     "per module. Results are printed in input order"));
+
 template<typename T>
-static bool error(Expected<T> &ResOrErr) {
+static bool error(Expected<T> &ResOrErr, raw_ostream &ErrOS) {
   if (ResOrErr)
     return false;
-  logAllUnhandledErrors(ResOrErr.takeError(), errs(),
+  logAllUnhandledErrors(ResOrErr.takeError(), ErrOS,
                         "LLVMSymbolizer: error reading file: ");
   return true;
 }
@@ -137,6 +152,87 @@ static bool parseCommand(StringRef InputString, bool &IsData,
   return !StringRef(pos, offset_length).getAsInteger(0, ModuleOffset);
 }
 
+static void symbolizeInput(StringRef InputString, LLVMSymbolizer &Symbolizer,
+                           raw_ostream &OS, raw_ostream &ErrOS) {
+  bool IsData = false;
+  std::string ModuleName;
+  uint64_t ModuleOffset = 0;
+  if (!parseCommand(InputString, IsData, ModuleName, ModuleOffset)) {
+    OS << InputString;
+    return;
+  }
+
+  DIPrinter Printer(OS, ClPrintFunctions != FunctionNameKind::None,
+                    ClPrettyPrint, ClPrintSourceContextLines, ClVerbose);
+  if (ClPrintAddress) {
+    OS << "0x";
+    OS.write_hex(ModuleOffset);
+    StringRef Delimiter = ClPrettyPrint ? ": " : "\n";
+    OS << Delimiter;
+  }
+  if (IsData) {
+    auto ResOrErr = Symbolizer.symbolizeData(ModuleName, ModuleOffset);
+    Printer << (error(ResOrErr, ErrOS) ? DIGlobal() : ResOrErr.get());
+  } else if (ClPrintInlining) {
+    auto ResOrErr =
+        Symbolizer.symbolizeInlinedCode(ModuleName, ModuleOffset, ClDwpName);
+    Printer << (error(ResOrErr, ErrOS) ? DIInliningInfo() : ResOrErr.get());
+  } else {
+    auto ResOrErr =
+        Symbolizer.symbolizeCode(ModuleName, ModuleOffset, ClDwpName);
+    Printer << (error(ResOrErr, ErrOS) ? DILineInfo() : ResOrErr.get());
+  }
+  OS << "\n";
+}
+
+// Symbolize all of Inputs, visiting the addresses of each module in
+// increasing order so that lookups walk the debug info (or index) forward.
+// Results and errors are printed in input order.
+static void symbolizeBatch(ArrayRef<std::string> Inputs,
+                           LLVMSymbolizer &Symbolizer, raw_ostream &OS) {
+  struct Query {
+    std::string ModuleName;
+    // Errors loading a module are only reported by the first query of the
+    // module, so that query is answered first, as it would be without -batch.
+    bool SeenBefore;
+    uint64_t ModuleOffset;
+    size_t Index;
+  };
+  std::vector<Query> Queries;
+  Queries.reserve(Inputs.size());
+  std::set<std::string> Seen;
+  for (size_t I = 0, E = Inputs.size(); I != E; ++I) {
+    Query Q{"", false, 0, I};
+    bool IsData;
+    // Lines that do not parse are echoed; their position does not matter.
+    parseCommand(Inputs[I], IsData, Q.ModuleName, Q.ModuleOffset);
+    Q.SeenBefore = !Seen.insert(Q.ModuleName).second;
+    Queries.push_back(std::move(Q));
+  }
+  std::stable_sort(Queries.begin(), Queries.end(),
+                   [](const Query &L, const Query &R) {
+                     return std::tie(L.ModuleName, L.SeenBefore,
+                                     L.ModuleOffset) <
+                            std::tie(R.ModuleName, R.SeenBefore,
+                                     R.ModuleOffset);
+                   });
+
+  std::vector<std::string> Results(Inputs.size());
+  std::vector<std::string> Errors(Inputs.size());
+  for (const Query &Q : Queries) {
+    raw_string_ostream ResultOS(Results[Q.Index]);
+    raw_string_ostream ErrOS(Errors[Q.Index]);
+    symbolizeInput(Inputs[Q.Index], Symbolizer, ResultOS, ErrOS);
+  }
+  for (size_t I = 0, E = Inputs.size(); I != E; ++I) {
+    if (!Errors[I].empty()) {
+      OS.flush();
+      errs() << Errors[I];
+    }
+    OS << Results[I];
+  }
+}
+
 int main(int argc, char **argv) {
   InitLLVM X(argc, argv);
 
@@ -145,6 +241,7 @@ int main(int argc, char **argv) {
   cl::ParseCommandLineOptions(argc, argv, "llvm-symbolizer\n");
   LLVMSymbolizer::Options Opts(ClPrintFunctions, ClUseSymbolTable, ClDemangle,
                                ClUseRelativeAddress, ClDefaultArch);
+  Opts.IndexDir = ClIndexDir;
 
   for (const auto &hint : ClDsymHint) {
     if (sys::path::extension(hint) == ".dSYM") {
@@ -156,47 +253,24 @@ int main(int argc, char **argv) {
   }
   LLVMSymbolizer Symbolizer(Opts);
 
-  DIPrinter Printer(outs(), ClPrintFunctions != FunctionNameKind::None,
-                    ClPrettyPrint, ClPrintSourceContextLines, ClVerbose);
-
   const int kMaxInputStringLength = 1024;
   char InputString[kMaxInputStringLength];
 
+  std::vector<std::string> Inputs;
   while (true) {
     if (!fgets(InputString, sizeof(InputString), stdin))
       break;
 
-    bool IsData = false;
-    std::string ModuleName;
-    uint64_t ModuleOffset = 0;
-    if (!parseCommand(StringRef(InputString), IsData, ModuleName,
-                      ModuleOffset)) {
-      outs() << InputString;
+    if (ClBatch) {
+      Inputs.push_back(InputString);
       continue;
     }
-
-    if (ClPrintAddress) {
-      outs() << "0x";
-      outs().write_hex(ModuleOffset);
-      StringRef Delimiter = ClPrettyPrint ? ": " : "\n";
-      outs() << Delimiter;
-    }
-    if (IsData) {
-      auto ResOrErr = Symbolizer.symbolizeData(ModuleName, ModuleOffset);
-      Printer << (error(ResOrErr) ? DIGlobal() : ResOrErr.get());
-    } else if (ClPrintInlining) {
-      auto ResOrErr =
-          Symbolizer.symbolizeInlinedCode(ModuleName, ModuleOffset, ClDwpName);
-      Printer << (error(ResOrErr) ? DIInliningInfo()
-                                             : ResOrErr.get());
-    } else {
-      auto ResOrErr =
-          Symbolizer.symbolizeCode(ModuleName, ModuleOffset, ClDwpName);
-      Printer << (error(ResOrErr) ? DILineInfo() : ResOrErr.get());
-    }
-    outs() << "\n";
+    symbolizeInput(InputString, Symbolizer, outs(), errs());
     outs().flush();
   }
 
+  if (ClBatch)
+    symbolizeBatch(Inputs, Symbolizer, outs());
+
   return 0;
 }
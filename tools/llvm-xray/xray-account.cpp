@@ -13,6 +13,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <mutex>
 #include <numeric>
 #include <system_error>
 #include <utility>
@@ -21,6 +22,8 @@
 #include "xray-registry.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/XRay/InstrumentationMap.h"
 #include "llvm/XRay/Trace.h"
 
@@ -28,9 +31,9 @@ using namespace llvm;
 using namespace llvm::xray;
 
 static cl::SubCommand Account("account", "Function call accounting");
-static cl::opt<std::string> AccountInput(cl::Positional,
-                                         cl::desc("<xray log file>"),
-                                         cl::Required, cl::sub(Account));
+static cl::list<std::string> AccountInputs(cl::Positional,
+                                           cl::desc("<xray log files...>"),
+                                           cl::OneOrMore, cl::sub(Account));
 static cl::opt<bool>
     AccountKeepGoing("keep-going", cl::desc("Keep going on errors encountered"),
                      cl::sub(Account), cl::init(false));
@@ -120,6 +123,14 @@ static cl::opt<std::string>
 static cl::alias AccountInstrMap2("m", cl::aliasopt(AccountInstrMap),
                                   cl::desc("Alias for -instr_map"),
                                   cl::sub(Account));
+static cl::opt<unsigned> AccountNumThreads(
+    "num-threads", cl::init(0),
+    cl::desc("Number of threads used to account multiple log files; "
+             "defaults to the number of cores"),
+    cl::sub(Account));
+static cl::alias AccountNumThreads2("j", cl::aliasopt(AccountNumThreads),
+                                    cl::desc("Alias for -num-threads"),
+                                    cl::sub(Account));
 
 namespace {
 
@@ -215,6 +226,21 @@ bool LatencyAccountant::accountRecord(const XRayRecord &Record) {
   return true;
 }
 
+void LatencyAccountant::merge(const LatencyAccountant &Other) {
+  for (const auto &FT : Other.FunctionLatencies) {
+    auto &Timings = FunctionLatencies[FT.first];
+    Timings.insert(Timings.end(), FT.second.begin(), FT.second.end());
+  }
+  for (const auto &MM : Other.PerThreadMinMaxTSC) {
+    setMinMax(PerThreadMinMaxTSC[MM.first], MM.second.first);
+    setMinMax(PerThreadMinMaxTSC[MM.first], MM.second.second);
+  }
+  for (const auto &MM : Other.PerCPUMinMaxTSC) {
+    setMinMax(PerCPUMinMaxTSC[MM.first], MM.second.first);
+    setMinMax(PerCPUMinMaxTSC[MM.first], MM.second.second);
+  }
+}
+
 namespace {
 
 // We consolidate the data into a struct which we can output in various forms.
@@ -438,6 +464,55 @@ template <> struct format_provider<llvm::xray::RecordTypes> {
 };
 } // namespace llvm
 
+// Serializes the diagnostics of accountFile, which may run on several threads.
+static std::mutex DiagnosticsMutex;
+
+// Streams the records of the log file |Filename| into |FCA|, without loading
+// the whole trace into memory.
+static Error accountFile(StringRef Filename, LatencyAccountant &FCA,
+                         XRayFileHeader &Header,
+                         FuncIdConversionHelper &FuncIdHelper) {
+  bool AccountingFailed = false;
+  auto E = streamTraceFile(
+      Filename, Header, [&](const XRayRecord &Record) -> Error {
+        if (FCA.accountRecord(Record))
+          return Error::success();
+        std::lock_guard<std::mutex> Lock(DiagnosticsMutex);
+        errs()
+            << "Error processing record: "
+            << llvm::formatv(
+                   R"({{type: {0}; cpu: {1}; record-type: {2}; function-id: {3}; tsc: {4}; thread-id: {5}; process-id: {6}}})",
+                   Record.RecordType, Record.CPU, Record.Type, Record.FuncId,
+                   Record.TSC, Record.TId, Record.PId)
+            << '\n';
+        for (const auto &ThreadStack : FCA.getPerThreadFunctionStack()) {
+          errs() << "Thread ID: " << ThreadStack.first << "\n";
+          if (ThreadStack.second.empty()) {
+            errs() << "  (empty stack)\n";
+            continue;
+          }
+          auto Level = ThreadStack.second.size();
+          for (const auto &Entry : llvm::reverse(ThreadStack.second))
+            errs() << "  #" << Level-- << "\t"
+                   << FuncIdHelper.SymbolOrNumber(Entry.first) << '\n';
+        }
+        if (AccountKeepGoing)
+          return Error::success();
+        AccountingFailed = true;
+        return make_error<StringError>(
+            Twine("Failed accounting function calls in file '") + Filename +
+                "'.",
+            std::make_error_code(std::errc::executable_format_error));
+      });
+  if (E && !AccountingFailed)
+    return joinErrors(
+        make_error<StringError>(
+            Twine("Failed loading input file '") + Filename + "'",
+            std::make_error_code(std::errc::executable_format_error)),
+        std::move(E));
+  return E;
+}
+
 static CommandRegistration Unused(&Account, []() -> Error {
   InstrumentationMap Map;
   if (!AccountInstrMap.empty()) {
@@ -463,49 +538,57 @@ static CommandRegistration Unused(&Account, []() -> Error {
   symbolize::LLVMSymbolizer Symbolizer(Opts);
   llvm::xray::FuncIdConversionHelper FuncIdHelper(AccountInstrMap, Symbolizer,
                                                   FunctionAddresses);
-  xray::LatencyAccountant FCA(FuncIdHelper, AccountDeduceSiblingCalls);
-  auto TraceOrErr = loadTraceFile(AccountInput);
-  if (!TraceOrErr)
-    return joinErrors(
-        make_error<StringError>(
-            Twine("Failed loading input file '") + AccountInput + "'",
-            std::make_error_code(std::errc::executable_format_error)),
-        TraceOrErr.takeError());
-
-  auto &T = *TraceOrErr;
-  for (const auto &Record : T) {
-    if (FCA.accountRecord(Record))
-      continue;
-    errs()
-        << "Error processing record: "
-        << llvm::formatv(
-               R"({{type: {0}; cpu: {1}; record-type: {2}; function-id: {3}; tsc: {4}; thread-id: {5}; process-id: {6}}})",
-               Record.RecordType, Record.CPU, Record.Type, Record.FuncId,
-               Record.TSC, Record.TId, Record.PId)
-        << '\n';
-    for (const auto &ThreadStack : FCA.getPerThreadFunctionStack()) {
-      errs() << "Thread ID: " << ThreadStack.first << "\n";
-      if (ThreadStack.second.empty()) {
-        errs() << "  (empty stack)\n";
-        continue;
-      }
-      auto Level = ThreadStack.second.size();
-      for (const auto &Entry : llvm::reverse(ThreadStack.second))
-        errs() << "  #" << Level-- << "\t"
-               << FuncIdHelper.SymbolOrNumber(Entry.first) << '\n';
-    }
-    if (!AccountKeepGoing)
+
+  // Each log file is accounted separately, so that several of them can be
+  // streamed concurrently, and the results are merged in input order.
+  size_t NumInputs = AccountInputs.size();
+  std::vector<LatencyAccountant> Accountants;
+  Accountants.reserve(NumInputs);
+  for (size_t I = 0; I < NumInputs; ++I)
+    Accountants.emplace_back(FuncIdHelper, AccountDeduceSiblingCalls);
+  std::vector<XRayFileHeader> Headers(NumInputs);
+
+  if (NumInputs == 1) {
+    if (auto E = accountFile(AccountInputs[0], Accountants[0], Headers[0],
+                             FuncIdHelper))
+      return E;
+  } else {
+    unsigned NumThreads = AccountNumThreads;
+    if (NumThreads == 0)
+      NumThreads = std::max(1U, std::min(heavyweight_hardware_concurrency(),
+                                         unsigned(NumInputs)));
+    Error Err = Error::success();
+    std::mutex ErrMutex;
+    ThreadPool Pool(NumThreads);
+    for (size_t I = 0; I < NumInputs; ++I)
+      Pool.async([&, I] {
+        auto E = accountFile(AccountInputs[I], Accountants[I], Headers[I],
+                             FuncIdHelper);
+        std::lock_guard<std::mutex> Lock(ErrMutex);
+        Err = joinErrors(std::move(Err), std::move(E));
+      });
+    Pool.wait();
+    if (Err)
+      return Err;
+  }
+
+  for (size_t I = 1; I < NumInputs; ++I) {
+    if (Headers[I].CycleFrequency != Headers[0].CycleFrequency)
       return make_error<StringError>(
-          Twine("Failed accounting function calls in file '") + AccountInput +
-              "'.",
-          std::make_error_code(std::errc::executable_format_error));
+          Twine("Cycle frequency of '") + AccountInputs[I] +
+              "' does not match the one of '" + AccountInputs[0] + "'",
+          std::make_error_code(std::errc::invalid_argument));
+    Accountants[0].merge(Accountants[I]);
   }
+
+  const auto &FCA = Accountants[0];
+  const auto &Header = Headers[0];
   switch (AccountOutputFormat) {
   case AccountOutputFormats::TEXT:
-    FCA.exportStatsAsText(OS, T.getFileHeader());
+    FCA.exportStatsAsText(OS, Header);
     break;
   case AccountOutputFormats::CSV:
-    FCA.exportStatsAsCSV(OS, T.getFileHeader());
+    FCA.exportStatsAsCSV(OS, Header);
     break;
   }
 
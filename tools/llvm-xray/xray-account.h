@@ -78,6 +78,12 @@ public:
   ///
   bool accountRecord(const XRayRecord &Record);
 
+  /// Adds the latencies and the min-max TSC ranges accounted by |Other| to the
+  /// ones accounted here. This is used to combine the results of log files
+  /// that were accounted separately; the function stacks of calls that did not
+  /// finish in |Other| are not merged.
+  void merge(const LatencyAccountant &Other);
+
   const FunctionStack *getThreadFunctionStack(llvm::sys::procid_t TId) const {
     auto I = PerThreadFunctionStack.find(TId);
     if (I == PerThreadFunctionStack.end())
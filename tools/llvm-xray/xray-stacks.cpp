@@ -726,30 +726,37 @@ static CommandRegistration Unused(&Stack, []() -> Error {
   // TODO: Someday, support output to files instead of just directly to
   // standard output.
   for (const auto &Filename : StackInputs) {
-    auto TraceOrErr = loadTraceFile(Filename);
-    if (!TraceOrErr) {
-      if (!StackKeepGoing)
-        return joinErrors(
-            make_error<StringError>(
-                Twine("Failed loading input file '") + Filename + "'",
-                std::make_error_code(std::errc::invalid_argument)),
-            TraceOrErr.takeError());
-      logAllUnhandledErrors(TraceOrErr.takeError(), errs(), "");
-      continue;
-    }
-    auto &T = *TraceOrErr;
+    // The records are streamed from the file as they are accounted, so that
+    // the whole trace never needs to be held in memory.
     StackTrie::AccountRecordState AccountRecordState =
         StackTrie::AccountRecordState::CreateInitialState();
-    for (const auto &Record : T) {
-      auto error = ST.accountRecord(Record, &AccountRecordState);
-      if (error != StackTrie::AccountRecordStatus::OK) {
-        if (!StackKeepGoing)
-          return make_error<StringError>(
-              CreateErrorMessage(error, Record, FuncIdHelper),
-              make_error_code(errc::illegal_byte_sequence));
-        errs() << CreateErrorMessage(error, Record, FuncIdHelper);
-      }
-    }
+    XRayFileHeader Header;
+    bool AccountingFailed = false;
+    auto E = streamTraceFile(
+        Filename, Header, [&](const XRayRecord &Record) -> Error {
+          auto error = ST.accountRecord(Record, &AccountRecordState);
+          if (error == StackTrie::AccountRecordStatus::OK)
+            return Error::success();
+          if (!StackKeepGoing) {
+            AccountingFailed = true;
+            return make_error<StringError>(
+                CreateErrorMessage(error, Record, FuncIdHelper),
+                make_error_code(errc::illegal_byte_sequence));
+          }
+          errs() << CreateErrorMessage(error, Record, FuncIdHelper);
+          return Error::success();
+        });
+    if (!E)
+      continue;
+    if (AccountingFailed)
+      return E;
+    if (!StackKeepGoing)
+      return joinErrors(
+          make_error<StringError>(
+              Twine("Failed loading input file '") + Filename + "'",
+              std::make_error_code(std::errc::invalid_argument)),
+          std::move(E));
+    logAllUnhandledErrors(std::move(E), errs(), "");
   }
   if (ST.isEmpty()) {
     return make_error<StringError>(
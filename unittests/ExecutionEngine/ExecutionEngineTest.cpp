@@ -8,10 +8,12 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ExecutionEngine/GenericValue.h"
 #include "llvm/ExecutionEngine/Interpreter.h"
 #include "llvm/ExecutionEngine/RTDyldMemoryManager.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Support/DynamicLibrary.h"
@@ -130,6 +132,29 @@ TEST_F(ExecutionEngineTest, DestructionRemovesGlobalMapping) {
   EXPECT_EQ(nullptr, Engine->getGlobalValueAtAddress(&Mem1));
 }
 
+TEST_F(ExecutionEngineTest, RemoveModuleForgetsGlobalAddresses) {
+  GlobalVariable *G1 = NewExtGlobal(Type::getInt32Ty(Context), "Global1");
+  Function *F = Function::Create(
+      FunctionType::get(G1->getType(), /*isVarArg=*/false),
+      GlobalValue::ExternalLinkage, "getGlobal1", M);
+  IRBuilder<> Builder(BasicBlock::Create(Context, "entry", F));
+  Builder.CreateRet(G1);
+
+  int32_t Mem1 = 3;
+  Engine->addGlobalMapping(G1, &Mem1);
+  EXPECT_EQ(&Mem1, GVTOP(Engine->runFunction(F, None)));
+
+  // Removing the module drops its mappings, so a function run after it is
+  // added back must see the new address of the global.
+  ASSERT_TRUE(Engine->removeModule(M));
+  Engine->addModule(std::unique_ptr<Module>(M));
+  int32_t Mem2 = 4;
+  Engine->addGlobalMapping(G1, &Mem2);
+  EXPECT_EQ(&Mem2, GVTOP(Engine->runFunction(F, None)))
+    << "The interpreter used the address of the global from before the "
+    << "module was removed";
+}
+
 TEST_F(ExecutionEngineTest, LookupWithMangledAndDemangledSymbol) {
   int x;
   int _x;
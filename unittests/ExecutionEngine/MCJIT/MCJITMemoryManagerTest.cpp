@@ -8,6 +8,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/ExecutionEngine/SlabMemoryManager.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -166,5 +167,76 @@ TEST(MCJITMemoryManagerTest, ManyVariedAllocations) {
   }
 }
 
+TEST(MCJITMemoryManagerTest, SlabAllocations) {
+  auto Allocator = SlabAllocator::Create(1 << 20);
+  if (!Allocator) {
+    // Not supported on this host.
+    consumeError(Allocator.takeError());
+    return;
+  }
+
+  std::vector<SlabAllocator::Allocation> Allocs;
+  for (unsigned i = 0; i < 300; ++i) {
+    auto Kind = static_cast<SlabAllocator::SectionKind>(i % 3);
+    unsigned Align = 1u << (i % 10);
+    auto A = (*Allocator)->allocate(Kind, 1 + i * 97, Align);
+    ASSERT_TRUE(!!A);
+    EXPECT_EQ((uintptr_t)0, (uintptr_t)A->TargetAddr % Align);
+    EXPECT_EQ(Kind == SlabAllocator::SectionKind::RWData,
+              A->WorkingAddr == A->TargetAddr);
+    memset(A->WorkingAddr, i % 256, A->Size);
+    Allocs.push_back(*A);
+  }
+
+  // Writes through the working view show up at the target address, and
+  // blocks do not overlap.
+  for (unsigned i = 0; i < Allocs.size(); ++i)
+    for (size_t j = 0; j < Allocs[i].Size; ++j)
+      ASSERT_EQ(i % 256, Allocs[i].TargetAddr[j]);
+
+  // Freed memory is reused.
+  uint8_t *Freed = Allocs[3].TargetAddr;
+  size_t FreedSize = Allocs[3].Size;
+  (*Allocator)->deallocate(Allocs[3]);
+  auto A = (*Allocator)->allocate(Allocs[3].Kind, FreedSize, 1);
+  ASSERT_TRUE(!!A);
+  EXPECT_EQ(Freed, A->TargetAddr);
+  Allocs[3] = *A;
+
+  // Sections larger than a slab get their own.
+  auto Large = (*Allocator)->allocate(SlabAllocator::SectionKind::Code,
+                                      4 << 20, 4096);
+  ASSERT_TRUE(!!Large);
+  Allocs.push_back(*Large);
+
+  for (auto &A : Allocs)
+    (*Allocator)->deallocate(A);
+}
+
+TEST(MCJITMemoryManagerTest, SlabMemoryManagerFreesSections) {
+  auto Allocator = SlabAllocator::Create(1 << 20);
+  if (!Allocator) {
+    consumeError(Allocator.takeError());
+    return;
+  }
+
+  uint8_t *Code;
+  {
+    SlabMemoryManager MemMgr(*Allocator);
+    Code = MemMgr.allocateCodeSection(256, 0, 1, "");
+    EXPECT_NE((uint8_t *)nullptr, Code);
+    EXPECT_NE((uint8_t *)nullptr,
+              MemMgr.allocateDataSection(256, 0, 2, "", true));
+    EXPECT_NE((uint8_t *)nullptr,
+              MemMgr.allocateDataSection(256, 0, 3, "", false));
+    std::string Error;
+    EXPECT_FALSE(MemMgr.finalizeMemory(&Error));
+  }
+
+  // The first object's memory is handed to the next one.
+  SlabMemoryManager MemMgr(*Allocator);
+  EXPECT_EQ(Code, MemMgr.allocateCodeSection(256, 0, 1, ""));
+}
+
 } // Namespace
 
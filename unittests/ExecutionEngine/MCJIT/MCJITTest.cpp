@@ -13,6 +13,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "MCJITTestBase.h"
+#include "llvm/ExecutionEngine/SlabMemoryManager.h"
 #include "llvm/Support/DynamicLibrary.h"
 #include "gtest/gtest.h"
 
@@ -113,6 +114,36 @@ TEST_F(MCJITTest, return_global) {
     << "Invalid value for global returned from JITted function";
 }
 
+TEST_F(MCJITTest, slab_memory_manager) {
+  SKIP_UNSUPPORTED_PLATFORM;
+
+  auto Allocator = SlabAllocator::Create(1 << 20);
+  if (!Allocator) {
+    consumeError(Allocator.takeError());
+    return;
+  }
+  MM.reset(new SlabMemoryManager(*Allocator));
+
+  int32_t initialNum = 7;
+  GlobalVariable *GV = insertGlobalInt32(M.get(), "myglob", initialNum);
+  Function *ReturnGlobal = startFunction<int32_t(void)>(M.get(),
+                                                        "ReturnGlobal");
+  Value *ReadGlobal = Builder.CreateLoad(GV);
+  endFunctionWithRet(ReturnGlobal, ReadGlobal);
+  Function *Add = insertAddFunction(M.get());
+
+  createJIT(std::move(M));
+  uint64_t rgvPtr = TheJIT->getFunctionAddress(ReturnGlobal->getName().str());
+  uint64_t addPtr = TheJIT->getFunctionAddress(Add->getName().str());
+  ASSERT_TRUE(0 != rgvPtr);
+  ASSERT_TRUE(0 != addPtr);
+
+  int32_t(*FuncPtr)() = (int32_t(*)())rgvPtr;
+  EXPECT_EQ(initialNum, FuncPtr());
+  int (*AddPtr)(int, int) = (int(*)(int, int))addPtr;
+  EXPECT_EQ(3, AddPtr(1, 2));
+}
+
 // FIXME: This case fails due to a bug with getPointerToGlobal().
 // The bug is due to MCJIT not having an implementation of getPointerToGlobal()
 // which results in falling back on the ExecutionEngine implementation that
@@ -0,0 +1,72 @@
+//===- PersistentObjectCacheTest.cpp - Tests for PersistentObjectCache ----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ExecutionEngine/Orc/PersistentObjectCache.h"
+#include "OrcTestCommon.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::orc;
+
+namespace {
+
+class PersistentObjectCacheTest : public testing::Test,
+                                  public OrcExecutionTest {
+protected:
+  void SetUp() override {
+    ASSERT_FALSE(
+        sys::fs::createUniqueDirectory("orc-object-cache-test", CacheDir));
+  }
+
+  void TearDown() override { sys::fs::remove_directories(CacheDir); }
+
+  unsigned countLockFiles() {
+    unsigned N = 0;
+    std::error_code EC;
+    for (sys::fs::directory_iterator I(CacheDir, EC), E; I != E && !EC;
+         I.increment(EC))
+      if (sys::path::extension(I->path()) == ".lock")
+        ++N;
+    return N;
+  }
+
+  SmallString<128> CacheDir;
+};
+
+TEST_F(PersistentObjectCacheTest, LockReleasedOnFailedCompile) {
+  if (!TM)
+    return;
+
+  auto Cache = cantFail(PersistentObjectCache::Create(CacheDir, *TM));
+
+  ModuleBuilder MB(Context, TM->getTargetTriple().str(), "dummy");
+  MB.createFunctionDecl<void()>("foo");
+  Module *M = MB.getModule();
+
+  EXPECT_FALSE(Cache->getObject(M)) << "Empty cache should miss";
+  EXPECT_EQ(countLockFiles(), 1U) << "Miss should lock the entry";
+
+  Cache->notifyObjectCompileFailed(M);
+  EXPECT_EQ(countLockFiles(), 0U) << "Failed compile should release the lock";
+
+  EXPECT_FALSE(Cache->getObject(M)) << "Failed compile should not be stored";
+  EXPECT_EQ(countLockFiles(), 1U) << "Miss should lock the entry again";
+
+  StringRef Obj = "not really an object";
+  Cache->notifyObjectCompiled(M, MemoryBufferRef(Obj, "obj"));
+  EXPECT_EQ(countLockFiles(), 0U) << "Storing should release the lock";
+
+  auto Cached = Cache->getObject(M);
+  ASSERT_TRUE(!!Cached) << "Stored object should hit";
+  EXPECT_EQ(Cached->getBuffer(), Obj) << "Wrong object loaded from the cache";
+}
+
+} // end anonymous namespace
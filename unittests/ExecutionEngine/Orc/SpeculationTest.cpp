@@ -0,0 +1,78 @@
+//===------ SpeculationTest.cpp - Unit tests for LLLazyJIT speculation ----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "OrcTestCommon.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/Threading.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::orc;
+
+namespace {
+
+class SpeculationTest : public testing::Test, public OrcExecutionTest {};
+
+// foo only calls baz when its argument is non-zero, so calling foo(0) makes
+// baz a candidate without calling it.
+const char *SpeculationTestIR = R"(
+define i32 @baz(i32 %x) {
+entry:
+  %add = add nsw i32 %x, 1
+  ret i32 %add
+}
+
+define i32 @foo(i32 %x) {
+entry:
+  %cmp = icmp eq i32 %x, 0
+  br i1 %cmp, label %done, label %call
+
+call:
+  %r = call i32 @baz(i32 %x)
+  ret i32 %r
+
+done:
+  ret i32 0
+}
+)";
+
+TEST_F(SpeculationTest, CalleeCompiledBeforeFirstCall) {
+  if (!SupportsJIT || !SupportsIndirection || !llvm_is_multithreaded())
+    return;
+
+  auto Ctx = llvm::make_unique<LLVMContext>();
+  SMDiagnostic Diag;
+  auto M = parseAssemblyString(SpeculationTestIR, Diag, *Ctx);
+  ASSERT_TRUE(!!M) << "Could not parse test IR";
+
+  auto DL = TM->createDataLayout();
+  auto J = cantFail(LLLazyJIT::Create(llvm::make_unique<ExecutionSession>(),
+                                      std::move(TM), std::move(DL), *Ctx));
+  J->enableSpeculation(8);
+  cantFail(J->addLazyIRModule(std::move(M)));
+
+  auto FooSym = cantFail(J->lookup("foo"));
+  auto *Foo = (int32_t(*)(int32_t))FooSym.getAddress();
+
+  EXPECT_EQ(Foo(0), 0) << "foo(0) returned the wrong value";
+
+  // The first call of foo queued baz. Once it has been compiled, its stub
+  // points straight at its body, so calling it is a hit.
+  J->waitForSpeculation();
+  EXPECT_EQ(J->getNumSpeculated(), 1U) << "baz was not compiled speculatively";
+  EXPECT_EQ(J->getNumSpeculationHits(), 1U) << "baz's stub was not patched";
+
+  EXPECT_EQ(Foo(1), 2) << "foo(1) returned the wrong value";
+  EXPECT_EQ(J->getNumSpeculationMisses(), 1U)
+      << "Only foo should have been compiled on its first call";
+}
+
+} // end anonymous namespace
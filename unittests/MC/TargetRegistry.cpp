@@ -19,6 +19,9 @@ using namespace llvm;
 
 namespace {
 
+// The names of the targets registered by the LazyInitializer test.
+const char LazyTargetPrefix[] = "lazy-test-";
+
 TEST(TargetRegistry, TargetHasArchType) {
   // Presence of at least one target will be asserted when done with the loop,
   // else this would pass by accident if InitializeAllTargetInfos were omitted.
@@ -33,8 +36,9 @@ TEST(TargetRegistry, TargetHasArchType) {
     // predicate.
     // We can't ask the predicate "Are you a function that always returns
     // false?"
-    // So given that the cpp backend truly has no target arch, it is skipped.
-    if (Name != "cpp") {
+    // So given that the cpp backend truly has no target arch, it is skipped,
+    // and so are the fake targets of the LazyInitializer test below.
+    if (Name != "cpp" && !Name.startswith(LazyTargetPrefix)) {
       Triple::ArchType Arch = Triple::getArchTypeForLLVMName(Name);
       EXPECT_NE(Arch, Triple::UnknownArch);
       ++Count;
@@ -43,4 +47,50 @@ TEST(TargetRegistry, TargetHasArchType) {
   ASSERT_NE(Count, 0);
 }
 
+// A backend with two targets that never match a triple, so that it does not
+// get in the way of lookups of the real targets.
+Target LazyTarget1, LazyTarget2;
+int NumLazyInits = 0;
+
+void initializeLazyTargetInfo() {
+  auto NoArch = [](Triple::ArchType) { return false; };
+  TargetRegistry::RegisterTarget(LazyTarget1, "lazy-test-1", "Lazy test",
+                                 "LazyTest", NoArch);
+  TargetRegistry::RegisterTarget(LazyTarget2, "lazy-test-2", "Lazy test",
+                                 "LazyTest", NoArch);
+}
+
+void initializeLazyTarget() { ++NumLazyInits; }
+
+TEST(TargetRegistry, LazyInitializer) {
+  // Targets cannot be unregistered, so only the first run of this test in a
+  // process sees the backend before it is looked up. Later runs, as with
+  // --gtest_repeat, check that its initializers then run right away.
+  static bool LookedUp = false;
+  int Start = NumLazyInits;
+
+  TargetRegistry::RegisterLazyInitializer(initializeLazyTargetInfo,
+                                          initializeLazyTarget);
+  TargetRegistry::RegisterLazyInitializer(initializeLazyTargetInfo,
+                                          initializeLazyTarget);
+  EXPECT_EQ(LookedUp ? Start + 2 : Start, NumLazyInits);
+  EXPECT_STREQ("lazy-test-1", LazyTarget1.getName());
+
+  // Looking up any target of the backend runs all its initializers, once.
+  Triple TT;
+  std::string Error;
+  EXPECT_EQ(&LazyTarget2,
+            TargetRegistry::lookupTarget("lazy-test-2", TT, Error));
+  LookedUp = true;
+  EXPECT_EQ(Start + 2, NumLazyInits);
+  EXPECT_EQ(&LazyTarget1,
+            TargetRegistry::lookupTarget("lazy-test-1", TT, Error));
+  EXPECT_EQ(Start + 2, NumLazyInits);
+
+  // Once the backend has been looked up, new initializers run right away.
+  TargetRegistry::RegisterLazyInitializer(initializeLazyTargetInfo,
+                                          initializeLazyTarget);
+  EXPECT_EQ(Start + 3, NumLazyInits);
+}
+
 } // end namespace
@@ -404,6 +404,39 @@ TEST(CommandLineTest, SetValueInSubcategories) {
   EXPECT_TRUE(SC2Opt);
 }
 
+// Stands in for PluginLoader: loading a plugin runs its static constructors,
+// which register the plugin's options while the command line is being parsed.
+std::string PluginOptionName;
+std::unique_ptr<StackOption<int>> PluginOption;
+
+struct PluginLoaderStub {
+  void operator=(const std::string &OptionName) {
+    PluginOptionName = OptionName;
+    PluginOption =
+        llvm::make_unique<StackOption<int>>(StringRef(PluginOptionName));
+  }
+};
+
+TEST(CommandLineTest, OptionRegisteredWhileParsing) {
+  cl::ResetCommandLineParser();
+
+  StackOption<PluginLoaderStub,
+              cl::opt<PluginLoaderStub, false, cl::parser<std::string>>>
+      Load("load");
+
+  std::string Errs;
+  raw_string_ostream OS(Errs);
+
+  const char *args[] = {"prog", "-load=plugin-option", "-plugin-option=3"};
+  EXPECT_TRUE(cl::ParseCommandLineOptions(3, args, StringRef(), &OS));
+  OS.flush();
+  EXPECT_TRUE(Errs.empty()) << Errs;
+  ASSERT_TRUE(PluginOption);
+  EXPECT_EQ(3, *PluginOption);
+
+  PluginOption.reset();
+}
+
 TEST(CommandLineTest, LookupFailsInWrongSubCommand) {
   cl::ResetCommandLineParser();
 
@@ -3,6 +3,8 @@
 #include <cassert>
 #include <memory>
 
+#include "MCTargetDesc/X86MCTargetDesc.h"
+#include "llvm/MC/MCInstBuilder.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
 #include "gmock/gmock.h"
@@ -57,6 +59,7 @@ protected:
     LLVMInitializeX86TargetInfo();
     LLVMInitializeX86Target();
     LLVMInitializeX86TargetMC();
+    LLVMInitializeX86Disassembler();
   }
 
 protected:
@@ -98,5 +101,50 @@ TEST_F(AnalysisTest, ComputeIdealizedProcResPressure_1P1_1P05_2P0156) {
                                    Pair(P5Idx, 1.0), Pair(P6Idx, 1.0)));
 }
 
+TEST_F(AnalysisTest, SchedModelDiffRanksByDiscrepancy) {
+  std::vector<InstructionBenchmark> Points(3);
+  for (InstructionBenchmark &Point : Points) {
+    Point.Mode = InstructionBenchmark::Latency;
+    Point.CpuName = "haswell";
+    Point.LLVMTriple = "x86_64-unknown-linux";
+  }
+  // ADD32rr has a latency of 1 on Haswell, and IMUL32rr a latency of 3.
+  Points[0].Key.Instructions = {llvm::MCInstBuilder(llvm::X86::ADD32rr)
+                                    .addReg(llvm::X86::EAX)
+                                    .addReg(llvm::X86::EAX)
+                                    .addReg(llvm::X86::ECX)};
+  Points[0].Measurements = {{"latency", 1.0, ""}};
+  Points[1].Key.Instructions = {llvm::MCInstBuilder(llvm::X86::IMUL32rr)
+                                    .addReg(llvm::X86::EAX)
+                                    .addReg(llvm::X86::EAX)
+                                    .addReg(llvm::X86::ECX)};
+  Points[1].Measurements = {{"latency", 5.0, ""}};
+  // Points with errors are ignored.
+  Points[2].Key.Instructions = Points[0].Key.Instructions;
+  Points[2].Error = "oops";
+
+  auto Clustering = InstructionBenchmarkClustering::create(Points, 1, 0.1);
+  ASSERT_TRUE(static_cast<bool>(Clustering));
+  std::string Error;
+  const llvm::Target *const TheTarget =
+      llvm::TargetRegistry::lookupTarget("x86_64-unknown-linux", Error);
+  ASSERT_NE(TheTarget, nullptr) << Error;
+  const Analysis Analyzer(*TheTarget, *Clustering);
+
+  std::string Output;
+  llvm::raw_string_ostream OS(Output);
+  ASSERT_FALSE(
+      static_cast<bool>(Analyzer.run<Analysis::PrintSchedModelDiff>(OS)));
+  llvm::SmallVector<llvm::StringRef, 4> Lines;
+  llvm::StringRef(OS.str()).trim().split(Lines, '\n');
+  ASSERT_EQ(Lines.size(), 3u);
+  EXPECT_EQ(Lines[0],
+            "discrepancy,opcode_name,sched_class,latency,latency_model");
+  EXPECT_TRUE(Lines[1].startswith("2.00,IMUL32rr,"));
+  EXPECT_TRUE(Lines[1].endswith(",5.00,3.00"));
+  EXPECT_TRUE(Lines[2].startswith("0.00,ADD32rr,"));
+  EXPECT_TRUE(Lines[2].endswith(",1.00,1.00"));
+}
+
 } // namespace
 } // namespace exegesis
@@ -124,7 +124,14 @@ namespace {
   Class("class", cl::desc("Print Enum list for this class"),
         cl::value_desc("class name"), cl::cat(PrintEnumsCat));
 
-bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
+  cl::list<std::string>
+  Emit("emit",
+       cl::desc("Also run the backend for <action> (for example "
+                "gen-dag-isel) on the records and write its output to <file>. "
+                "May be repeated."),
+       cl::value_desc("action=file"), cl::ZeroOrMore);
+
+bool runBackend(ActionType Action, raw_ostream &OS, RecordKeeper &Records) {
   switch (Action) {
   case PrintRecords:
     OS << Records;           // No argument, dump all contents
@@ -235,6 +242,36 @@ bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
 
   return false;
 }
+
+bool LLVMTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
+  return runBackend(Action, OS, Records);
+}
+
+// Fill ExtraOutputs from the -emit options. Returns true on error.
+bool parseExtraOutputs(const char *ProgName,
+                       std::vector<TableGenOutput> &ExtraOutputs) {
+  for (StringRef Spec : Emit) {
+    StringRef Name, Filename;
+    std::tie(Name, Filename) = Spec.split('=');
+    Name.consume_front("-");
+    // The actions are the values of the Action option, so look them up in
+    // its parser.
+    auto &Parser = Action.getParser();
+    ActionType ExtraAction;
+    if (Name.empty() || Filename.empty() ||
+        Parser.findOption(Name) == Parser.getNumOptions() ||
+        Parser.parse(Action, Name, "", ExtraAction)) {
+      errs() << ProgName << ": invalid -emit value '" << Spec
+             << "', expected <action>=<file>\n";
+      return true;
+    }
+    ExtraOutputs.push_back(
+        {Filename, [ExtraAction](raw_ostream &OS, RecordKeeper &Records) {
+           return runBackend(ExtraAction, OS, Records);
+         }});
+  }
+  return false;
+}
 }
 
 int main(int argc, char **argv) {
@@ -244,7 +281,13 @@ int main(int argc, char **argv) {
 
   llvm_shutdown_obj Y;
 
-  return TableGenMain(argv[0], &LLVMTableGenMain);
+  // The backends requested with -emit run on the records parsed for the main
+  // action, which saves parsing the target description again for each.
+  std::vector<TableGenOutput> ExtraOutputs;
+  if (parseExtraOutputs(argv[0], ExtraOutputs))
+    return 1;
+
+  return TableGenMain(argv[0], &LLVMTableGenMain, ExtraOutputs);
 }
 
 #ifdef __has_feature